@@ -60,11 +60,11 @@ def build_linux(use_zig=True):
         if not check_zig():
             return False
 
-        cmd = ["zig", "cc", "-o", "test_opm", "src/phase1/test_opm.c", "opm.c", "-lm", "-fwrapv"]
+        cmd = ["zig", "cc", "-o", "test_opm", "src/phase1/test_opm.c", "opm.c", "opm_multi.c", "opm_convert.c", "opm_resample.c", "-lm", "-fwrapv"]
         if not run_command(cmd, "Building with zig cc"):
             return False
     else:
-        cmd = ["gcc", "-o", "test_opm", "src/phase1/test_opm.c", "opm.c", "-lm", "-fwrapv"]
+        cmd = ["gcc", "-o", "test_opm", "src/phase1/test_opm.c", "opm.c", "opm_multi.c", "opm_convert.c", "opm_resample.c", "-lm", "-fwrapv"]
         if not run_command(cmd, "Building with gcc"):
             return False
 
@@ -94,11 +94,14 @@ def build_windows(cross_compile=False):
             "test_opm.exe",
             "src/phase1/test_opm.c",
             "opm.c",
+            "opm_multi.c",
+            "opm_convert.c",
+            "opm_resample.c",
             "-lm",
             "-fwrapv",
         ]
     else:
-        cmd = ["zig", "cc", "-o", "test_opm.exe", "src/phase1/test_opm.c", "opm.c", "-lm", "-fwrapv"]
+        cmd = ["zig", "cc", "-o", "test_opm.exe", "src/phase1/test_opm.c", "opm.c", "opm_multi.c", "opm_convert.c", "opm_resample.c", "-lm", "-fwrapv"]
 
     if not run_command(cmd, "Building with zig cc"):
         return False
@@ -129,11 +132,12 @@ def build_phase2_windows(cross_compile=False):
             "wav_output.exe",
             "src/phase2/wav_output.c",
             "opm.c",
+            "opm_convert.c",
             "-lm",
             "-fwrapv",
         ]
     else:
-        cmd = ["zig", "cc", "-o", "wav_output.exe", "src/phase2/wav_output.c", "opm.c", "-lm", "-fwrapv"]
+        cmd = ["zig", "cc", "-o", "wav_output.exe", "src/phase2/wav_output.c", "opm.c", "opm_convert.c", "-lm", "-fwrapv"]
 
     if not run_command(cmd, "Building phase2 WAV output with zig cc"):
         return False
@@ -152,11 +156,11 @@ def build_phase2_linux(use_zig=True):
         if not check_zig():
             return False
 
-        cmd = ["zig", "cc", "-o", "wav_output", "src/phase2/wav_output.c", "opm.c", "-lm", "-fwrapv"]
+        cmd = ["zig", "cc", "-o", "wav_output", "src/phase2/wav_output.c", "opm.c", "opm_convert.c", "-lm", "-fwrapv"]
         if not run_command(cmd, "Building phase2 WAV output with zig cc"):
             return False
     else:
-        cmd = ["gcc", "-o", "wav_output", "src/phase2/wav_output.c", "opm.c", "-lm", "-fwrapv"]
+        cmd = ["gcc", "-o", "wav_output", "src/phase2/wav_output.c", "opm.c", "opm_convert.c", "-lm", "-fwrapv"]
         if not run_command(cmd, "Building phase2 WAV output with gcc"):
             return False
 
@@ -186,6 +190,8 @@ def build_phase3_windows(cross_compile=False):
             "real_time_audio.exe",
             "src/phase3/real_time_audio.c",
             "opm.c",
+            "opm_convert.c",
+            "opm_resample.c",
             "-lm",
             "-fwrapv",
             "-O3",
@@ -198,6 +204,8 @@ def build_phase3_windows(cross_compile=False):
             "real_time_audio.exe",
             "src/phase3/real_time_audio.c",
             "opm.c",
+            "opm_convert.c",
+            "opm_resample.c",
             "-lm",
             "-fwrapv",
             "-O3",
@@ -227,6 +235,8 @@ def build_phase3_linux(use_zig=True):
             "real_time_audio",
             "src/phase3/real_time_audio.c",
             "opm.c",
+            "opm_convert.c",
+            "opm_resample.c",
             "-lm",
             "-lpthread",
             "-ldl",
@@ -241,6 +251,8 @@ def build_phase3_linux(use_zig=True):
             "real_time_audio",
             "src/phase3/real_time_audio.c",
             "opm.c",
+            "opm_convert.c",
+            "opm_resample.c",
             "-lm",
             "-lpthread",
             "-ldl",
@@ -275,12 +287,14 @@ def build_phase4_windows(cross_compile=False):
             "player.exe",
             "src/phase4/player.c",
             "opm.c",
+            "opm_convert.c",
+            "opm_resample.c",
             "-lm",
             "-fwrapv",
             "-O3",
         ]
     else:
-        cmd = ["zig", "cc", "-o", "player.exe", "src/phase4/player.c", "opm.c", "-lm", "-fwrapv", "-O3"]
+        cmd = ["zig", "cc", "-o", "player.exe", "src/phase4/player.c", "opm.c", "opm_convert.c", "opm_resample.c", "-lm", "-fwrapv", "-O3"]
 
     if not run_command(cmd, "Building phase4 music player with zig cc"):
         return False
@@ -304,12 +318,15 @@ def build_phase4_linux(use_zig=True):
             "cc",
             "-o",
             "phase4_player",
-            "src/phase4/phase4_player.c",
+            "src/phase4/player.c",
             "opm.c",
+            "opm_convert.c",
+            "opm_resample.c",
             "-lm",
             "-lpthread",
             "-ldl",
             "-fwrapv",
+            "-O3",
         ]
         if not run_command(cmd, "Building phase4 music player with zig cc"):
             return False
@@ -318,12 +335,15 @@ def build_phase4_linux(use_zig=True):
             "gcc",
             "-o",
             "phase4_player",
-            "src/phase4/phase4_player.c",
+            "src/phase4/player.c",
             "opm.c",
+            "opm_convert.c",
+            "opm_resample.c",
             "-lm",
             "-lpthread",
             "-ldl",
             "-fwrapv",
+            "-O3",
         ]
         if not run_command(cmd, "Building phase4 music player with gcc"):
             return False
@@ -332,6 +352,67 @@ def build_phase4_linux(use_zig=True):
     return True
 
 
+def bench_resampler():
+    """Build and run the phase4 resampler benchmark (polyphase vs linear)."""
+    print("\n" + "=" * 60)
+    print("Benchmarking phase4 resampler")
+    print("=" * 60)
+
+    cmd = [
+        "gcc",
+        "-o",
+        "resampler_bench",
+        "src/phase4/resampler_bench.c",
+        "opm_convert.c",
+        "opm_resample.c",
+        "-lm",
+        "-lpthread",
+        "-ldl",
+        "-fwrapv",
+        "-O3",
+    ]
+    if not run_command(cmd, "Building resampler benchmark with gcc"):
+        return False
+
+    try:
+        subprocess.run(["./resampler_bench"], check=True)
+    except subprocess.CalledProcessError as e:
+        print(f"❌ Benchmark failed with exit code {e.returncode}")
+        return False
+    return True
+
+
+def test_phase4():
+    """Build and run the phase4 player test program."""
+    print("\n" + "=" * 60)
+    print("Testing phase4 player")
+    print("=" * 60)
+
+    cmd = [
+        "gcc",
+        "-o",
+        "test_player",
+        "src/phase4/test_player.c",
+        "opm.c",
+        "opm_convert.c",
+        "opm_resample.c",
+        "-lm",
+        "-lpthread",
+        "-ldl",
+        "-fwrapv",
+        "-O2",
+    ]
+    if not run_command(cmd, "Building phase4 player test with gcc"):
+        return False
+
+    try:
+        subprocess.run(["./test_player"], check=True)
+    except subprocess.CalledProcessError as e:
+        print(f"❌ Test failed with exit code {e.returncode}")
+        return False
+    return True
+
+
 def run_test():
     """Run the test program."""
     print("\n" + "=" * 60)
@@ -437,6 +518,18 @@ def main():
     elif command == "build-phase4-windows":
         success = build_phase4_windows(cross_compile=(system != "Windows"))
 
+    elif command == "bench-resampler":
+        if system != "Linux":
+            print("❌ Error: resampler benchmark only supported on Linux")
+            return 1
+        success = bench_resampler()
+
+    elif command == "test-phase4":
+        if system != "Linux":
+            print("❌ Error: phase4 player test only supported on Linux")
+            return 1
+        success = test_phase4()
+
     elif command == "test":
         success = run_test()
 
@@ -456,6 +549,8 @@ def main():
         print("  build-phase4         Build phase4 music sequence player for current platform")
         print("  build-phase4-gcc     Build phase4 music player with gcc (Linux only)")
         print("  build-phase4-windows Build phase4 music player Windows executable (cross-compile if on Linux)")
+        print("  bench-resampler      Build and run the phase4 resampler benchmark (Linux only)")
+        print("  test-phase4          Build and run the phase4 player test (Linux only)")
         print("  test                 Run the test program")
         print("  help                 Show this help message")
         return 0
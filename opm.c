@@ -25,214 +25,32 @@
  */
 #include <string.h>
 #include <stdint.h>
+/* OPM_Reset copies a cached reset image when C11 atomics are available */
+#ifndef OPM_RESET_IMAGE
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_ATOMICS__)
+#define OPM_RESET_IMAGE 1
+#else
+#define OPM_RESET_IMAGE 0
+#endif
+#endif
+#if OPM_RESET_IMAGE
+#include <stdatomic.h>
+#endif
 #include "opm.h"
-
-enum {
-    eg_num_attack = 0,
-    eg_num_decay = 1,
-    eg_num_sustain = 2,
-    eg_num_release = 3
-};
-
-/* logsin table */
-static const uint16_t logsinrom[256] = {
-    0x859, 0x6c3, 0x607, 0x58b, 0x52e, 0x4e4, 0x4a6, 0x471,
-    0x443, 0x41a, 0x3f5, 0x3d3, 0x3b5, 0x398, 0x37e, 0x365,
-    0x34e, 0x339, 0x324, 0x311, 0x2ff, 0x2ed, 0x2dc, 0x2cd,
-    0x2bd, 0x2af, 0x2a0, 0x293, 0x286, 0x279, 0x26d, 0x261,
-    0x256, 0x24b, 0x240, 0x236, 0x22c, 0x222, 0x218, 0x20f,
-    0x206, 0x1fd, 0x1f5, 0x1ec, 0x1e4, 0x1dc, 0x1d4, 0x1cd,
-    0x1c5, 0x1be, 0x1b7, 0x1b0, 0x1a9, 0x1a2, 0x19b, 0x195,
-    0x18f, 0x188, 0x182, 0x17c, 0x177, 0x171, 0x16b, 0x166,
-    0x160, 0x15b, 0x155, 0x150, 0x14b, 0x146, 0x141, 0x13c,
-    0x137, 0x133, 0x12e, 0x129, 0x125, 0x121, 0x11c, 0x118,
-    0x114, 0x10f, 0x10b, 0x107, 0x103, 0x0ff, 0x0fb, 0x0f8,
-    0x0f4, 0x0f0, 0x0ec, 0x0e9, 0x0e5, 0x0e2, 0x0de, 0x0db,
-    0x0d7, 0x0d4, 0x0d1, 0x0cd, 0x0ca, 0x0c7, 0x0c4, 0x0c1,
-    0x0be, 0x0bb, 0x0b8, 0x0b5, 0x0b2, 0x0af, 0x0ac, 0x0a9,
-    0x0a7, 0x0a4, 0x0a1, 0x09f, 0x09c, 0x099, 0x097, 0x094,
-    0x092, 0x08f, 0x08d, 0x08a, 0x088, 0x086, 0x083, 0x081,
-    0x07f, 0x07d, 0x07a, 0x078, 0x076, 0x074, 0x072, 0x070,
-    0x06e, 0x06c, 0x06a, 0x068, 0x066, 0x064, 0x062, 0x060,
-    0x05e, 0x05c, 0x05b, 0x059, 0x057, 0x055, 0x053, 0x052,
-    0x050, 0x04e, 0x04d, 0x04b, 0x04a, 0x048, 0x046, 0x045,
-    0x043, 0x042, 0x040, 0x03f, 0x03e, 0x03c, 0x03b, 0x039,
-    0x038, 0x037, 0x035, 0x034, 0x033, 0x031, 0x030, 0x02f,
-    0x02e, 0x02d, 0x02b, 0x02a, 0x029, 0x028, 0x027, 0x026,
-    0x025, 0x024, 0x023, 0x022, 0x021, 0x020, 0x01f, 0x01e,
-    0x01d, 0x01c, 0x01b, 0x01a, 0x019, 0x018, 0x017, 0x017,
-    0x016, 0x015, 0x014, 0x014, 0x013, 0x012, 0x011, 0x011,
-    0x010, 0x00f, 0x00f, 0x00e, 0x00d, 0x00d, 0x00c, 0x00c,
-    0x00b, 0x00a, 0x00a, 0x009, 0x009, 0x008, 0x008, 0x007,
-    0x007, 0x007, 0x006, 0x006, 0x005, 0x005, 0x005, 0x004,
-    0x004, 0x004, 0x003, 0x003, 0x003, 0x002, 0x002, 0x002,
-    0x002, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001,
-    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000
-};
-
-/* exp table */
-static const uint16_t exprom[256] = {
-    0x7fa, 0x7f5, 0x7ef, 0x7ea, 0x7e4, 0x7df, 0x7da, 0x7d4,
-    0x7cf, 0x7c9, 0x7c4, 0x7bf, 0x7b9, 0x7b4, 0x7ae, 0x7a9,
-    0x7a4, 0x79f, 0x799, 0x794, 0x78f, 0x78a, 0x784, 0x77f,
-    0x77a, 0x775, 0x770, 0x76a, 0x765, 0x760, 0x75b, 0x756,
-    0x751, 0x74c, 0x747, 0x742, 0x73d, 0x738, 0x733, 0x72e,
-    0x729, 0x724, 0x71f, 0x71a, 0x715, 0x710, 0x70b, 0x706,
-    0x702, 0x6fd, 0x6f8, 0x6f3, 0x6ee, 0x6e9, 0x6e5, 0x6e0,
-    0x6db, 0x6d6, 0x6d2, 0x6cd, 0x6c8, 0x6c4, 0x6bf, 0x6ba,
-    0x6b5, 0x6b1, 0x6ac, 0x6a8, 0x6a3, 0x69e, 0x69a, 0x695,
-    0x691, 0x68c, 0x688, 0x683, 0x67f, 0x67a, 0x676, 0x671,
-    0x66d, 0x668, 0x664, 0x65f, 0x65b, 0x657, 0x652, 0x64e,
-    0x649, 0x645, 0x641, 0x63c, 0x638, 0x634, 0x630, 0x62b,
-    0x627, 0x623, 0x61e, 0x61a, 0x616, 0x612, 0x60e, 0x609,
-    0x605, 0x601, 0x5fd, 0x5f9, 0x5f5, 0x5f0, 0x5ec, 0x5e8,
-    0x5e4, 0x5e0, 0x5dc, 0x5d8, 0x5d4, 0x5d0, 0x5cc, 0x5c8,
-    0x5c4, 0x5c0, 0x5bc, 0x5b8, 0x5b4, 0x5b0, 0x5ac, 0x5a8,
-    0x5a4, 0x5a0, 0x59c, 0x599, 0x595, 0x591, 0x58d, 0x589,
-    0x585, 0x581, 0x57e, 0x57a, 0x576, 0x572, 0x56f, 0x56b,
-    0x567, 0x563, 0x560, 0x55c, 0x558, 0x554, 0x551, 0x54d,
-    0x549, 0x546, 0x542, 0x53e, 0x53b, 0x537, 0x534, 0x530,
-    0x52c, 0x529, 0x525, 0x522, 0x51e, 0x51b, 0x517, 0x514,
-    0x510, 0x50c, 0x509, 0x506, 0x502, 0x4ff, 0x4fb, 0x4f8,
-    0x4f4, 0x4f1, 0x4ed, 0x4ea, 0x4e7, 0x4e3, 0x4e0, 0x4dc,
-    0x4d9, 0x4d6, 0x4d2, 0x4cf, 0x4cc, 0x4c8, 0x4c5, 0x4c2,
-    0x4be, 0x4bb, 0x4b8, 0x4b5, 0x4b1, 0x4ae, 0x4ab, 0x4a8,
-    0x4a4, 0x4a1, 0x49e, 0x49b, 0x498, 0x494, 0x491, 0x48e,
-    0x48b, 0x488, 0x485, 0x482, 0x47e, 0x47b, 0x478, 0x475,
-    0x472, 0x46f, 0x46c, 0x469, 0x466, 0x463, 0x460, 0x45d,
-    0x45a, 0x457, 0x454, 0x451, 0x44e, 0x44b, 0x448, 0x445,
-    0x442, 0x43f, 0x43c, 0x439, 0x436, 0x433, 0x430, 0x42d,
-    0x42a, 0x428, 0x425, 0x422, 0x41f, 0x41c, 0x419, 0x416,
-    0x414, 0x411, 0x40e, 0x40b, 0x408, 0x406, 0x403, 0x400
-};
-
-/* Envelope generator */
-static const uint32_t eg_stephi[4][4] = {
-    { 0, 0, 0, 0 },
-    { 1, 0, 0, 0 },
-    { 1, 0, 1, 0 },
-    { 1, 1, 1, 0 }
-};
-
-/* Phase generator */
-static const uint32_t pg_detune[8] = { 16, 17, 19, 20, 22, 24, 27, 29 };
-
-typedef struct {
-    int32_t basefreq;
-    int32_t approxtype;
-    int32_t slope;
-} freqtable_t;
-
-static const freqtable_t pg_freqtable[64] = {
-    { 1299, 1, 19 },
-    { 1318, 1, 19 },
-    { 1337, 1, 19 },
-    { 1356, 1, 20 },
-    { 1376, 1, 20 },
-    { 1396, 1, 20 },
-    { 1416, 1, 21 },
-    { 1437, 1, 20 },
-    { 1458, 1, 21 },
-    { 1479, 1, 21 },
-    { 1501, 1, 22 },
-    { 1523, 1, 22 },
-    { 0,    0, 16 },
-    { 0,    0, 16 },
-    { 0,    0, 16 },
-    { 0,    0, 16 },
-    { 1545, 1, 22 },
-    { 1567, 1, 22 },
-    { 1590, 1, 23 },
-    { 1613, 1, 23 },
-    { 1637, 1, 23 },
-    { 1660, 1, 24 },
-    { 1685, 1, 24 },
-    { 1709, 1, 24 },
-    { 1734, 1, 25 },
-    { 1759, 1, 25 },
-    { 1785, 1, 26 },
-    { 1811, 1, 26 },
-    { 0,    0, 16 },
-    { 0,    0, 16 },
-    { 0,    0, 16 },
-    { 0,    0, 16 },
-    { 1837, 1, 26 },
-    { 1864, 1, 27 },
-    { 1891, 1, 27 },
-    { 1918, 1, 28 },
-    { 1946, 1, 28 },
-    { 1975, 1, 28 },
-    { 2003, 1, 29 },
-    { 2032, 1, 30 },
-    { 2062, 1, 30 },
-    { 2092, 1, 30 },
-    { 2122, 1, 31 },
-    { 2153, 1, 31 },
-    { 0,    0, 16 },
-    { 0,    0, 16 },
-    { 0,    0, 16 },
-    { 0,    0, 16 },
-    { 2185, 1, 31 },
-    { 2216, 0, 31 },
-    { 2249, 0, 31 },
-    { 2281, 0, 31 },
-    { 2315, 0, 31 },
-    { 2348, 0, 31 },
-    { 2382, 0, 30 },
-    { 2417, 0, 30 },
-    { 2452, 0, 30 },
-    { 2488, 0, 30 },
-    { 2524, 0, 30 },
-    { 2561, 0, 30 },
-    { 0,    0, 16 },
-    { 0,    0, 16 },
-    { 0,    0, 16 },
-    { 0,    0, 16 }
-};
-
-
-/* FM algorithm */
-static const uint32_t fm_algorithm[4][6][8] = {
-    {
-        { 1, 1, 1, 1, 1, 1, 1, 1 }, /* M1_0          */
-        { 1, 1, 1, 1, 1, 1, 1, 1 }, /* M1_1          */
-        { 0, 0, 0, 0, 0, 0, 0, 0 }, /* C1            */
-        { 0, 0, 0, 0, 0, 0, 0, 0 }, /* Last operator */
-        { 0, 0, 0, 0, 0, 0, 0, 0 }, /* Last operator */
-        { 0, 0, 0, 0, 0, 0, 0, 1 }  /* Out           */
-    },
-    {
-        { 0, 1, 0, 0, 0, 1, 0, 0 }, /* M1_0          */
-        { 0, 0, 0, 0, 0, 0, 0, 0 }, /* M1_1          */
-        { 1, 1, 1, 0, 0, 0, 0, 0 }, /* C1            */
-        { 0, 0, 0, 0, 0, 0, 0, 0 }, /* Last operator */
-        { 0, 0, 0, 0, 0, 0, 0, 0 }, /* Last operator */
-        { 0, 0, 0, 0, 0, 1, 1, 1 }  /* Out           */
-    },
-    {
-        { 0, 0, 0, 0, 0, 0, 0, 0 }, /* M1_0          */
-        { 0, 0, 0, 0, 0, 0, 0, 0 }, /* M1_1          */
-        { 0, 0, 0, 0, 0, 0, 0, 0 }, /* C1            */
-        { 1, 0, 0, 1, 1, 1, 1, 0 }, /* Last operator */
-        { 0, 0, 0, 0, 0, 0, 0, 0 }, /* Last operator */
-        { 0, 0, 0, 0, 1, 1, 1, 1 }  /* Out           */
-    },
-    {
-        { 0, 0, 1, 0, 0, 1, 0, 0 }, /* M1_0          */
-        { 0, 0, 0, 0, 0, 0, 0, 0 }, /* M1_1          */
-        { 0, 0, 0, 1, 0, 0, 0, 0 }, /* C1            */
-        { 1, 1, 0, 1, 1, 0, 0, 0 }, /* Last operator */
-        { 0, 0, 1, 0, 0, 0, 0, 0 }, /* Last operator */
-        { 1, 1, 1, 1, 1, 1, 1, 1 }  /* Out           */
-    }
-};
-
-static uint16_t lfo_counter2_table[] = {
-    0x0000, 0x4000, 0x6000, 0x7000,
-    0x7800, 0x7c00, 0x7e00, 0x7f00,
-    0x7f80, 0x7fc0, 0x7fe0, 0x7ff0,
-    0x7ff8, 0x7ffc, 0x7ffe, 0x7fff
-};
+#include "opm_convert.h"
+#include "opm_tables.h"
+
+/* Stage functions take the cycle number as an argument instead of reading
+ * chip->cycles and are always inlined into OPM_ClockStages. The cycle is not a
+ * compile-time constant: OPM_ClockRound loops over it, and only saves the
+ * per-cycle write queue, idle and cycle counter updates of OPM_ClockCycle. */
+#if defined(_MSC_VER)
+#define OPM_INLINE __forceinline
+#elif defined(__GNUC__)
+#define OPM_INLINE inline __attribute__((always_inline))
+#else
+#define OPM_INLINE inline
+#endif
 
 static int32_t OPM_KCToFNum(int32_t kcode)
 {
@@ -396,35 +214,57 @@ static int32_t OPM_CalcKCode(int32_t kcf, int32_t lfo, int32_t lfo_sign, int32_t
     return sum;
 }
 
-static void OPM_PhaseCalcFNumBlock(opm_t *chip)
+/* The slot's key code and frequency number only change with KC, KF, PMS, DT2,
+ * the PM depth and the PM lock, so they are recomputed when one of those marks
+ * the slot in pg_fnum_dirty. New values mark its increment in pg_inc_dirty. */
+static OPM_INLINE void OPM_PhaseCalcFNumBlock(opm_t *chip, uint32_t cycles)
 {
-    uint32_t slot = (chip->cycles + 7) % 32;
+    uint32_t slot = (cycles + 7) % 32;
     uint32_t channel = slot % 8;
-    uint32_t kcf = (chip->ch_kc[channel] << 6) + chip->ch_kf[channel];
-    uint32_t lfo = chip->lfo_pmd ? chip->lfo_pm_lock : 0;
-    uint32_t pms = chip->ch_pms[channel];
-    uint32_t dt = chip->sl_dt2[slot];
-    int32_t lfo_pm = OPM_LFOApplyPMS(lfo & 127, pms);
-    uint32_t kcode = OPM_CalcKCode(kcf, lfo_pm, (lfo & 0x80) != 0 && pms != 0 ? 0 : 1, dt);
-    uint32_t fnum = OPM_KCToFNum(kcode);
-    uint32_t kcode_h = kcode >> 8;
-    chip->pg_fnum[slot] = fnum;
-    chip->pg_kcode[slot] = kcode_h;
+    uint32_t kcf, lfo, pms, dt, kcode, fnum, kcode_h;
+    int32_t lfo_pm;
+    if (!(chip->pg_fnum_dirty & (1u << slot)))
+    {
+        return;
+    }
+    chip->pg_fnum_dirty &= ~(1u << slot);
+    kcf = (chip->ch_kc[channel] << 6) + chip->ch_kf[channel];
+    lfo = chip->lfo_pmd ? chip->lfo_pm_lock : 0;
+    pms = chip->ch_pms[channel];
+    dt = chip->sl_dt2[slot];
+    lfo_pm = OPM_LFOApplyPMS(lfo & 127, pms);
+    kcode = OPM_CalcKCode(kcf, lfo_pm, (lfo & 0x80) != 0 && pms != 0 ? 0 : 1, dt);
+    fnum = OPM_KCToFNum(kcode);
+    kcode_h = kcode >> 8;
+    if (chip->pg_fnum[slot] != fnum || chip->pg_kcode[slot] != kcode_h)
+    {
+        chip->pg_fnum[slot] = fnum;
+        chip->pg_kcode[slot] = kcode_h;
+        chip->pg_inc_dirty |= 1u << slot;
+        chip->eg_rate_dirty |= 1u << slot;
+    }
 }
 
-static void OPM_PhaseCalcIncrement(opm_t *chip)
+/* pg_inc keeps its value until the slot is marked in pg_inc_dirty: by DT1 or
+ * MUL, a new key code or frequency number, or the phase reset clearing it */
+static OPM_INLINE void OPM_PhaseCalcIncrement(opm_t *chip, uint32_t cycles)
 {
-    uint32_t slot = chip->cycles;
-    uint32_t channel = slot % 8;
-    uint32_t dt = chip->sl_dt1[slot];
-    uint32_t dt_l = dt & 3;
-    uint32_t detune = 0;
-    uint32_t multi = chip->sl_mul[slot];
-    uint32_t kcode = chip->pg_kcode[slot];
-    uint32_t fnum = chip->pg_fnum[slot];
-    uint32_t block = kcode >> 2;
-    uint32_t basefreq = (fnum << block) >> 2;
+    uint32_t slot = cycles;
+    uint32_t dt, dt_l, detune, multi, kcode, fnum, block, basefreq;
     uint32_t note, sum, sum_h, sum_l, inc;
+    if (!(chip->pg_inc_dirty & (1u << slot)))
+    {
+        return;
+    }
+    chip->pg_inc_dirty &= ~(1u << slot);
+    dt = chip->sl_dt1[slot];
+    dt_l = dt & 3;
+    detune = 0;
+    multi = chip->sl_mul[slot];
+    kcode = chip->pg_kcode[slot];
+    fnum = chip->pg_fnum[slot];
+    block = kcode >> 2;
+    basefreq = (fnum << block) >> 2;
     /* Apply detune */
     if (dt_l)
     {
@@ -460,18 +300,19 @@ static void OPM_PhaseCalcIncrement(opm_t *chip)
     chip->pg_inc[slot] = inc;
 }
 
-static void OPM_PhaseGenerate(opm_t *chip)
+static OPM_INLINE void OPM_PhaseGenerate(opm_t *chip, uint32_t cycles)
 {
-    uint32_t slot = (chip->cycles + 27) % 32;
+    uint32_t slot = (cycles + 27) % 32;
     chip->pg_reset_latch[slot] = chip->pg_reset[slot];
-    slot = (chip->cycles + 25) % 32;
+    slot = (cycles + 25) % 32;
     /* Mask increment */
     if (chip->pg_reset_latch[slot])
     {
         chip->pg_inc[slot] = 0;
+        chip->pg_inc_dirty |= 1u << slot;
     }
     /* Phase step */
-    slot = (chip->cycles + 24) % 32;
+    slot = (cycles + 24) % 32;
     if (chip->pg_reset_latch[slot] || chip->mode_test[3])
     {
         chip->pg_phase[slot] = 0;
@@ -480,28 +321,28 @@ static void OPM_PhaseGenerate(opm_t *chip)
     chip->pg_phase[slot] &= 0xfffff;
 }
 
-static void OPM_PhaseDebug(opm_t *chip)
+static OPM_INLINE void OPM_PhaseDebug(opm_t *chip, uint32_t cycles)
 {
     chip->pg_serial >>= 1;
-    if (chip->cycles == 5)
+    if (cycles == 5)
     {
         chip->pg_serial |= (chip->pg_phase[29] & 0x3ff);
     }
 }
 
-static void OPM_KeyOn1(opm_t *chip)
+static OPM_INLINE void OPM_KeyOn1(opm_t *chip, uint32_t cycles)
 {
-    uint32_t cycles = (chip->cycles + 1) % 32;
+    uint32_t cycles1 = (cycles + 1) % 32;
     chip->kon_chanmatch = 0;
-    if (chip->mode_kon_channel + 24 == cycles)
+    if (chip->mode_kon_channel + 24 == cycles1)
     {
         chip->kon_chanmatch = 1;
     }
 }
 
-static void OPM_KeyOn2(opm_t *chip)
+static OPM_INLINE void OPM_KeyOn2(opm_t *chip, uint32_t cycles)
 {
-    uint32_t slot = (chip->cycles + 8) % 32;
+    uint32_t slot = (cycles + 8) % 32;
     if (chip->kon_chanmatch)
     {
         chip->mode_kon[(slot + 0) % 32] = chip->mode_kon_operator[0];
@@ -511,9 +352,9 @@ static void OPM_KeyOn2(opm_t *chip)
     }
 }
 
-static void OPM_EnvelopePhase1(opm_t *chip)
+static OPM_INLINE void OPM_EnvelopePhase1(opm_t *chip, uint32_t cycles)
 {
-    uint32_t slot = (chip->cycles + 2) % 32;
+    uint32_t slot = (cycles + 2) % 32;
     uint32_t kon = chip->mode_kon[slot] | chip->kon_csm;
     uint32_t konevent = !chip->kon[slot] && kon;
     if (konevent)
@@ -525,45 +366,50 @@ static void OPM_EnvelopePhase1(opm_t *chip)
     chip->kon[slot] = kon;
 }
 
-static void OPM_EnvelopePhase2(opm_t *chip)
+/* The key scaled rate of each envelope state and the AM multiplier of a slot,
+ * refreshed when a write, a new key code or IC marks it in eg_rate_dirty */
+static void OPM_EnvelopeRates(opm_t *chip, uint32_t slot)
 {
-    uint32_t slot = chip->cycles;
-    uint32_t chan = slot % 8;
-    uint8_t rate = 0, ksv, zr, ams;
-    switch (chip->eg_state[slot])
-    {
-    case eg_num_attack:
-        rate = chip->sl_ar[slot];
-        break;
-    case eg_num_decay:
-        rate = chip->sl_d1r[slot];
-        break;
-    case eg_num_sustain:
-        rate = chip->sl_d2r[slot];
-        break;
-    case eg_num_release:
-        rate = chip->sl_rr[slot] * 2 + 1;
-        break;
-    default:
-        break;
-    }
-    if (chip->ic)
-    {
-        rate = 31;
+    static const uint8_t ams_mul[4] = {0, 1, 2, 4};
+    uint8_t base[5];
+    uint8_t rate, ksv, zr;
+    uint32_t i;
+    base[eg_num_attack] = chip->sl_ar[slot];
+    base[eg_num_decay] = chip->sl_d1r[slot];
+    base[eg_num_sustain] = chip->sl_d2r[slot];
+    base[eg_num_release] = chip->sl_rr[slot] * 2 + 1;
+    base[4] = 31;
+    for (i = 0; i < 5; i++)
+    {
+        rate = base[i];
+        zr = rate == 0;
+        ksv = chip->pg_kcode[slot] >> (chip->sl_ks[slot] ^ 3);
+        if (chip->sl_ks[slot] == 0 && zr)
+        {
+            ksv &= ~3;
+        }
+        rate = rate * 2 + ksv;
+        if (rate & 64)
+        {
+            rate = 63;
+        }
+        chip->eg_slot_rate[slot][i] = rate | (zr << 7);
     }
-    
-    zr = rate == 0;
+    chip->eg_slot_am[slot] = chip->sl_am_e[slot] ? ams_mul[chip->ch_ams[slot % 8]] : 0;
+    chip->eg_rate_dirty &= ~(1u << slot);
+}
 
-    ksv = chip->pg_kcode[slot] >> (chip->sl_ks[slot] ^ 3);
-    if (chip->sl_ks[slot] == 0 && zr)
-    {
-        ksv &= ~3;
-    }
-    rate = rate * 2 + ksv;
-    if (rate & 64)
+static OPM_INLINE void OPM_EnvelopePhase2(opm_t *chip, uint32_t cycles)
+{
+    uint32_t slot = cycles;
+    uint8_t rate, zr;
+    if (chip->eg_rate_dirty & (1u << slot))
     {
-        rate = 63;
+        OPM_EnvelopeRates(chip, slot);
     }
+    rate = chip->eg_slot_rate[slot][chip->ic ? 4 : chip->eg_state[slot] & 3];
+    zr = rate >> 7;
+    rate &= 63;
 
     chip->eg_tl[2] = chip->eg_tl[1];
     chip->eg_tl[1] = chip->eg_tl[0];
@@ -580,28 +426,12 @@ static void OPM_EnvelopePhase2(opm_t *chip)
     chip->eg_rate[0] = rate;
     chip->eg_ratemax[1] = chip->eg_ratemax[0];
     chip->eg_ratemax[0] = (rate >> 1) == 31;
-    ams = chip->sl_am_e[slot] ? chip->ch_ams[chan] : 0;
-    switch (ams)
-    {
-    default:
-    case 0:
-        chip->eg_am = 0;
-        break;
-    case 1:
-        chip->eg_am = chip->lfo_am_lock << 0;
-        break;
-    case 2:
-        chip->eg_am = chip->lfo_am_lock << 1;
-        break;
-    case 3:
-        chip->eg_am = chip->lfo_am_lock << 2;
-        break;
-    }
+    chip->eg_am = chip->lfo_am_lock * chip->eg_slot_am[slot];
 }
 
-static void OPM_EnvelopePhase3(opm_t *chip)
+static OPM_INLINE void OPM_EnvelopePhase3(opm_t *chip, uint32_t cycles)
 {
-    uint32_t slot = (chip->cycles + 31) % 32;
+    uint32_t slot = (cycles + 31) % 32;
     chip->eg_shift = (chip->eg_timershift_lock + (chip->eg_rate[0] >> 2)) & 15;
     chip->eg_inchi = eg_stephi[chip->eg_rate[0] & 3][chip->eg_timer_lock & 3];
 
@@ -613,9 +443,9 @@ static void OPM_EnvelopePhase3(opm_t *chip)
     }
 }
 
-static void OPM_EnvelopePhase4(opm_t *chip)
+static OPM_INLINE void OPM_EnvelopePhase4(opm_t *chip, uint32_t cycles)
 {
-    uint32_t slot = (chip->cycles + 30) % 32;
+    uint32_t slot = (cycles + 30) % 32;
     uint8_t inc = 0;
     uint8_t kon, eg_off, eg_zero, slreach;
     if (chip->eg_clock & 2)
@@ -719,9 +549,9 @@ static void OPM_EnvelopePhase4(opm_t *chip)
     }
 }
 
-static void OPM_EnvelopePhase5(opm_t *chip)
+static OPM_INLINE void OPM_EnvelopePhase5(opm_t *chip, uint32_t cycles)
 {
-    uint32_t slot = (chip->cycles + 29) % 32;
+    uint32_t slot = (cycles + 29) % 32;
     uint32_t level = chip->eg_level[slot];
     uint32_t step = 0;
     if (chip->eg_instantattack)
@@ -760,11 +590,11 @@ static void OPM_EnvelopePhase5(opm_t *chip)
     chip->eg_test = chip->mode_test[5];
 }
 
-static void OPM_EnvelopePhase6(opm_t *chip)
+static OPM_INLINE void OPM_EnvelopePhase6(opm_t *chip, uint32_t cycles)
 {
-    uint32_t slot = (chip->cycles + 28) % 32;
+    uint32_t slot = (cycles + 28) % 32;
     chip->eg_serial_bit = (chip->eg_serial >> 9) & 1;
-    if (chip->cycles == 3)
+    if (cycles == 3)
     {
         chip->eg_serial = chip->eg_out[0] ^ 1023;
     }
@@ -776,35 +606,38 @@ static void OPM_EnvelopePhase6(opm_t *chip)
     chip->eg_out[1] = chip->eg_out[0];
 }
 
-static void OPM_EnvelopeClock(opm_t *chip)
+static OPM_INLINE void OPM_EnvelopeClock(opm_t *chip, uint32_t cycles)
 {
     chip->eg_clock <<= 1;
     if ((chip->eg_clockcnt & 2) != 0 || chip->mode_test[0])
     {
         chip->eg_clock |= 1;
     }
-    if (chip->ic || (chip->cycles == 31 && (chip->eg_clockcnt & 2) != 0))
+    if (chip->ic || (cycles == 31 && (chip->eg_clockcnt & 2) != 0))
     {
         chip->eg_clockcnt = 0;
     }
-    else if (chip->cycles == 31)
+    else if (cycles == 31)
     {
         chip->eg_clockcnt++;
     }
 }
 
-static void OPM_EnvelopeTimer(opm_t *chip)
+/* One cycle of the bit-serial envelope timer with the given EG clock and IC
+ * inputs: bit (cycles + 31) % 16 of the EG clock count is added at cycles 1-16,
+ * and the lowest set bit is picked out into eg_timer2 as it is scanned. */
+static OPM_INLINE void OPM_EnvelopeTimerStep(opm_t *chip, uint32_t cycles, uint8_t clock, uint8_t ic, uint8_t ic2)
 {
-    uint32_t cycle = (chip->cycles + 31) % 16;
+    uint32_t cycle = (cycles + 31) % 16;
     uint32_t cycle2;
-    uint8_t inc = ((chip->cycles + 31) % 32) < 16 && (chip->eg_clock & 1) != 0 && (cycle == 0 || chip->eg_timercarry);
+    uint8_t inc = ((cycles + 31) % 32) < 16 && clock && (cycle == 0 || chip->eg_timercarry);
     uint8_t timerbit = (chip->eg_timer >> cycle) & 1;
     uint8_t sum = timerbit + inc;
-    uint8_t sum0 = (sum & 1) && !chip->ic;
+    uint8_t sum0 = (sum & 1) && !ic;
     chip->eg_timercarry = sum >> 1;
     chip->eg_timer = (chip->eg_timer & (~(1 << cycle))) | (sum0 << cycle);
 
-    cycle2 = (chip->cycles + 30) % 16;
+    cycle2 = (cycles + 30) % 16;
 
     chip->eg_timer2 <<= 1;
     if ((chip->eg_timer & (1 << cycle2)) != 0 && !chip->eg_timerbstop)
@@ -817,37 +650,150 @@ static void OPM_EnvelopeTimer(opm_t *chip)
         chip->eg_timerbstop = 1;
     }
 
-    if (cycle == 0 || chip->ic2)
+    if (cycle == 0 || ic2)
     {
         chip->eg_timerbstop = 0;
     }
+}
+
+/* eg_timershift_lock from eg_timer2 as it is at cycle 1 */
+static OPM_INLINE uint8_t OPM_EnvelopeTimerShift(uint32_t timer2)
+{
+    uint8_t shift = 0;
+    if (timer2 & (8 + 32 + 128 + 512 + 2048 + 8192 + 32768))
+    {
+        shift |= 1;
+    }
+    if (timer2 & (4 + 32 + 64 + 512 + 1024 + 8192 + 16384))
+    {
+        shift |= 2;
+    }
+    if (timer2 & (4 + 8 + 16 + 512 + 1024 + 2048 + 4096))
+    {
+        shift |= 4;
+    }
+    if (timer2 & (4 + 8 + 16 + 32 + 64 + 128 + 256))
+    {
+        shift |= 8;
+    }
+    return shift;
+}
+
+#ifdef OPM_SERIAL_EG_TIMER
+static OPM_INLINE void OPM_EnvelopeTimer(opm_t *chip, uint32_t cycles)
+{
+    OPM_EnvelopeTimerStep(chip, cycles, chip->eg_clock & 1, chip->ic, chip->ic2);
+
+    if (cycles == 1 && (chip->eg_clock & 1) != 0)
+    {
+        chip->eg_timershift_lock = OPM_EnvelopeTimerShift(chip->eg_timer2);
+        chip->eg_timer_lock = chip->eg_timer;
+    }
+}
+
+static void OPM_EnvelopeTimerToSerial(opm_t *chip, uint32_t cycles)
+{
+    (void)chip;
+    (void)cycles;
+}
+#else
+/* eg_timershift_lock of a timer value left alone through cycles 18-31: the
+ * scan there marks its lowest set bit b below 14, which the masks turn into b + 1 */
+static OPM_INLINE uint8_t OPM_EnvelopeTimerShiftOf(uint32_t timer)
+{
+    uint8_t shift = 1;
+    timer &= 0x3fff;
+    if (!timer)
+    {
+        return 0;
+    }
+    while (!(timer & 1))
+    {
+        timer >>= 1;
+        shift++;
+    }
+    return shift;
+}
 
-    if (chip->cycles == 1 && (chip->eg_clock & 1) != 0)
+/* Rebuild the serial timer state of a word-parallel round about to run cycle
+ * cycles, by replaying the cycles since its cycle 1 with the inputs it had
+ * (all 32 of them at cycle 1, where an IC jump repeats cycle 0). After a word
+ * round eg_timer2 is rebuilt too, from the previous round's scan (cycles 17-0,
+ * over the value this round started from). */
+static void OPM_EnvelopeTimerToSerial(opm_t *chip, uint32_t cycles)
+{
+    uint32_t c = 1;
+    if (!chip->eg_timer_word)
     {
-        chip->eg_timershift_lock = 0;
-        if (chip->eg_timer2 & (8 + 32 + 128 + 512 + 2048 + 8192 + 32768))
+        return;
+    }
+    chip->eg_timer = chip->eg_timer_start;
+    chip->eg_timercarry = 0;
+    if (chip->eg_timer_word == 2)
+    {
+        for (c = 17; c != 1; c = (c + 1) % 32)
         {
-            chip->eg_timershift_lock |= 1;
+            OPM_EnvelopeTimerStep(chip, c, 0, 0, 0);
         }
-        if (chip->eg_timer2 & (4 + 32 + 64 + 512 + 1024 + 8192 + 16384))
+    }
+    do
+    {
+        OPM_EnvelopeTimerStep(chip, c, chip->eg_timer_clock, 0, 0);
+        c = (c + 1) % 32;
+    } while (c != cycles);
+    chip->eg_timer_word = 0;
+}
+
+/* Word-parallel envelope timer (build with OPM_SERIAL_EG_TIMER for the
+ * bit-serial one). A round's add and the lock values are done at cycle 1 in
+ * one go; the other cycles only check the round stays plain, with the same
+ * EG clock through cycles 1-16 and no IC (the delayed IC can only follow
+ * IC). If it does not, the serial state is rebuilt by replaying the round
+ * so far and the round finishes serially. */
+static OPM_INLINE void OPM_EnvelopeTimer(opm_t *chip, uint32_t cycles)
+{
+    uint8_t clock = chip->eg_clock & 1;
+    uint32_t timer = chip->eg_timer;
+
+    if (cycles == 1)
+    {
+        // The previous round's scan saw this value, unless it ran serially
+        uint8_t shift = chip->eg_timer_word ? OPM_EnvelopeTimerShiftOf(timer) : OPM_EnvelopeTimerShift(chip->eg_timer2 << 1);
+        if (chip->ic || chip->ic2)
         {
-            chip->eg_timershift_lock |= 2;
+            OPM_EnvelopeTimerStep(chip, cycles, clock, chip->ic, chip->ic2);
+            chip->eg_timer_word = 0;
         }
-        if (chip->eg_timer2 & (4 + 8 + 16 + 512 + 1024 + 2048 + 4096))
+        else
         {
-            chip->eg_timershift_lock |= 4;
+            chip->eg_timer = (timer + clock) & 0xffff;
+            chip->eg_timer_start = timer;
+            chip->eg_timer_clock = clock;
+            chip->eg_timer_word = chip->eg_timer_word ? 2 : 1; // eg_timer2 is kept up to date by serial rounds only
         }
-        if (chip->eg_timer2 & (4 + 8 + 16 + 32 + 64 + 128 + 256))
+        if (clock)
         {
-            chip->eg_timershift_lock |= 8;
+            chip->eg_timershift_lock = shift;
+            chip->eg_timer_lock = chip->ic ? timer & 0xfe : timer ^ 1;
         }
-        chip->eg_timer_lock = chip->eg_timer;
+        return;
+    }
+
+    if (chip->eg_timer_word)
+    {
+        if (!chip->ic && (cycles - 2 >= 15 || clock == chip->eg_timer_clock))
+        {
+            return;
+        }
+        OPM_EnvelopeTimerToSerial(chip, cycles);
     }
+    OPM_EnvelopeTimerStep(chip, cycles, clock, chip->ic, chip->ic2);
 }
+#endif
 
-static void OPM_OperatorPhase1(opm_t *chip)
+static OPM_INLINE void OPM_OperatorPhase1(opm_t *chip, uint32_t cycles)
 {
-    uint32_t slot = chip->cycles;
+    uint32_t slot = cycles;
     int16_t mod = chip->op_mod[2];
     chip->op_phase_in = chip->pg_phase[slot] >> 10;
     if (chip->op_fbshift & 8)
@@ -864,101 +810,57 @@ static void OPM_OperatorPhase1(opm_t *chip)
     chip->op_mod_in = mod;
 }
 
-static void OPM_OperatorPhase2(opm_t *chip)
+static OPM_INLINE void OPM_OperatorPhase2(opm_t *chip, uint32_t cycles)
 {
-    uint32_t slot = (chip->cycles + 31) % 32;
+    uint32_t slot = (cycles + 31) % 32;
     chip->op_phase = (chip->op_phase_in + chip->op_mod_in) & 1023;
 }
 
-static void OPM_OperatorPhase3(opm_t *chip)
+static OPM_INLINE void OPM_OperatorPhase3(opm_t *chip, uint32_t cycles)
 {
-    uint32_t slot = (chip->cycles + 30) % 32;
+    uint32_t slot = (cycles + 30) % 32;
     uint16_t phase = chip->op_phase & 255;
     if (chip->op_phase & 256)
     {
         phase ^= 255;
     }
-    chip->op_logsin[0] = logsinrom[phase];
+    chip->op_logsin[chip->op_ring & 3] = logsinrom[phase];
     chip->op_sign <<= 1;
     chip->op_sign |= (chip->op_phase >> 9) & 1;
+    chip->op_ring++;
 }
 
-static void OPM_OperatorPhase4(opm_t *chip)
-{
-    uint32_t slot = (chip->cycles + 29) % 32;
-    chip->op_logsin[1] = chip->op_logsin[0];
-}
-
-static void OPM_OperatorPhase5(opm_t *chip)
-{
-    uint32_t slot = (chip->cycles + 28) % 32;
-    chip->op_logsin[2] = chip->op_logsin[1];
-}
-
-static void OPM_OperatorPhase6(opm_t *chip)
+/* The hardware carries logsin through phases 4 and 5 and exp/pow through
+ * phases 7 to 13. Here phase 6 reads logsin from the ring, converts the
+ * attenuation to a signed linear value in one lookup, and phase 14 reads it
+ * back 8 cycles later; phases 4, 5 and 7 to 12 have nothing left to do. */
+static OPM_INLINE void OPM_OperatorPhase6(opm_t *chip, uint32_t cycles)
 {
-    uint32_t slot = (chip->cycles + 27) % 32;
-    chip->op_atten = chip->op_logsin[2] + (chip->eg_out[1] << 2);
-    if (chip->op_atten & 4096)
+    uint32_t slot = (cycles + 27) % 32;
+    uint16_t atten = chip->op_logsin[(chip->op_ring + 1) & 3] + (chip->eg_out[1] << 2);
+    int16_t out;
+    if (atten & 4096)
     {
-        chip->op_atten = 4095;
+        atten = 4095;
     }
-}
-
-static void OPM_OperatorPhase7(opm_t *chip)
-{
-    uint32_t slot = (chip->cycles + 26) % 32;
-    chip->op_exp[0] = exprom[chip->op_atten & 255];
-    chip->op_pow[0] = chip->op_atten >> 8;
-}
-
-static void OPM_OperatorPhase8(opm_t *chip)
-{
-    uint32_t slot = (chip->cycles + 25) % 32;
-    chip->op_exp[1] = chip->op_exp[0];
-    chip->op_pow[1] = chip->op_pow[0];
-}
-
-static void OPM_OperatorPhase9(opm_t *chip)
-{
-    uint32_t slot = (chip->cycles + 24) % 32;
-    int16_t out = (chip->op_exp[1] << 2) >> (chip->op_pow[1]);
-    if (chip->op_sign & 32)
+    out = explinrom[atten];
+    if (chip->op_sign & 4)
     {
         out = -out;
     }
-    chip->op_out[0] = out;
-}
-
-static void OPM_OperatorPhase10(opm_t *chip)
-{
-    uint32_t slot = (chip->cycles + 23) % 32;
-    chip->op_out[1] = chip->op_out[0];
+    chip->op_lin[chip->op_ring & 7] = out;
 }
 
-static void OPM_OperatorPhase11(opm_t *chip)
+static OPM_INLINE void OPM_OperatorPhase13(opm_t *chip, uint32_t cycles)
 {
-    uint32_t slot = (chip->cycles + 22) % 32;
-    chip->op_out[2] = chip->op_out[1];
-}
-
-static void OPM_OperatorPhase12(opm_t *chip)
-{
-    uint32_t slot = (chip->cycles + 21) % 32;
-    chip->op_out[3] = chip->op_out[2];
-}
-
-static void OPM_OperatorPhase13(opm_t *chip)
-{
-    uint32_t slot = (chip->cycles + 20) % 32;
-    chip->op_out[4] = chip->op_out[3];
+    uint32_t slot = (cycles + 20) % 32;
     chip->op_connect = chip->ch_connect[slot % 8];
 }
 
-static void OPM_OperatorPhase14(opm_t *chip)
+static OPM_INLINE void OPM_OperatorPhase14(opm_t *chip, uint32_t cycles)
 {
-    uint32_t slot = (chip->cycles + 19) % 32;
-    chip->op_mix = chip->op_out[5] = chip->op_out[4];
+    uint32_t slot = (cycles + 19) % 32;
+    chip->op_mix = chip->op_out = chip->op_lin[chip->op_ring & 7];
     chip->op_fbupdate = (chip->op_counter == 0);
     chip->op_c1update = (chip->op_counter == 2);
     chip->op_fbshift <<= 1;
@@ -973,9 +875,9 @@ static void OPM_OperatorPhase14(opm_t *chip)
     chip->op_mixr = fm_algorithm[chip->op_counter][5][chip->op_connect] && (chip->ch_rl[slot % 8] & 2) != 0;
 }
 
-static void OPM_OperatorPhase15(opm_t *chip)
+static OPM_INLINE void OPM_OperatorPhase15(opm_t *chip, uint32_t cycles)
 {
-    uint32_t slot = (chip->cycles + 18) % 32;
+    uint32_t slot = (cycles + 18) % 32;
     int16_t mod, mod1 = 0, mod2 = 0;
     if (chip->op_modtable[0])
     {
@@ -991,28 +893,28 @@ static void OPM_OperatorPhase15(opm_t *chip)
     }
     if (chip->op_modtable[3])
     {
-        mod2 |= chip->op_out[5];
+        mod2 |= chip->op_out;
     }
     if (chip->op_modtable[4])
     {
-        mod1 |= chip->op_out[5];
+        mod1 |= chip->op_out;
     }
     mod = (mod1 + mod2) >> 1;
     chip->op_mod[0] = mod;
     if (chip->op_fbupdate)
     {
         chip->op_m1[slot % 8][1] = chip->op_m1[slot % 8][0];
-        chip->op_m1[slot % 8][0] = chip->op_out[5];
+        chip->op_m1[slot % 8][0] = chip->op_out;
     }
     if (chip->op_c1update)
     {
-        chip->op_c1[slot % 8] = chip->op_out[5];
+        chip->op_c1[slot % 8] = chip->op_out;
     }
 }
 
-static void OPM_OperatorPhase16(opm_t *chip)
+static OPM_INLINE void OPM_OperatorPhase16(opm_t *chip, uint32_t cycles)
 {
-    uint32_t slot = (chip->cycles + 17) % 32;
+    uint32_t slot = (cycles + 17) % 32;
     // hack
     chip->op_mod[2] = chip->op_mod[1];
     chip->op_fb[1] = chip->op_fb[0];
@@ -1021,24 +923,55 @@ static void OPM_OperatorPhase16(opm_t *chip)
     chip->op_fb[0] = chip->ch_fb[slot % 8];
 }
 
-static void OPM_OperatorCounter(opm_t *chip)
+static OPM_INLINE void OPM_OperatorCounter(opm_t *chip, uint32_t cycles)
 {
-    if ((chip->cycles % 8) == 4)
+    if ((cycles % 8) == 4)
     {
         chip->op_counter++;
     }
-    if (chip->cycles == 12)
+    if (cycles == 12)
     {
         chip->op_counter = 0;
     }
 }
 
-static void OPM_Mixer2(opm_t *chip)
+/* Exponent the serializer sends for a word whose bits 9-14 (sign-corrected)
+ * are top: one more than the position of the highest set bit, 1 if none. */
+static OPM_INLINE uint8_t OPM_MixExponent(uint8_t top)
+{
+    if (top & 32)
+    {
+        return 7;
+    }
+    else if (top & 16)
+    {
+        return 6;
+    }
+    else if (top & 8)
+    {
+        return 5;
+    }
+    else if (top & 4)
+    {
+        return 4;
+    }
+    else if (top & 2)
+    {
+        return 3;
+    }
+    else if (top & 1)
+    {
+        return 2;
+    }
+    return 1;
+}
+
+static OPM_INLINE void OPM_Mixer2(opm_t *chip, uint32_t cycles)
 {
-    uint32_t cycles = (chip->cycles + 30) % 32;
+    uint32_t cycles30 = (cycles + 30) % 32;
     uint8_t bit;
-    uint8_t top, ex;
-    if (cycles < 16)
+    uint8_t top;
+    if (cycles30 < 16)
     {
         bit = chip->mix_serial[0] & 1;
     }
@@ -1046,53 +979,25 @@ static void OPM_Mixer2(opm_t *chip)
     {
         bit = chip->mix_serial[1] & 1;
     }
-    if (chip->cycles % 16 == 1)
+    if (cycles % 16 == 1)
     {
         chip->mix_sign_lock = bit ^ 1;
         chip->mix_top_bits_lock = (chip->mix_bits >> 15) & 63;
     }
     chip->mix_bits >>= 1;
     chip->mix_bits |= bit << 20;
-    if (chip->cycles % 16 == 10)
+    if (cycles % 16 == 10)
     {
         top = chip->mix_top_bits_lock;
         if (chip->mix_sign_lock)
         {
             top ^= 63;
         }
-        if (top & 32)
-        {
-            ex = 7;
-        }
-        else if (top & 16)
-        {
-            ex = 6;
-        }
-        else if (top & 8)
-        {
-            ex = 5;
-        }
-        else if (top & 4)
-        {
-            ex = 4;
-        }
-        else if (top & 2)
-        {
-            ex = 3;
-        }
-        else if (top & 1)
-        {
-            ex = 2;
-        }
-        else
-        {
-            ex = 1;
-        }
         chip->mix_sign_lock2 = chip->mix_sign_lock;
-        chip->mix_exp_lock = ex;
+        chip->mix_exp_lock = OPM_MixExponent(top);
     }
     chip->mix_out_bit <<= 1;
-    switch ((chip->cycles + 1) % 16)
+    switch ((cycles + 1) % 16)
     {
     case 0:
         chip->mix_out_bit |= chip->mix_sign_lock2 ^ 1;
@@ -1115,15 +1020,15 @@ static void OPM_Mixer2(opm_t *chip)
     }
 }
 
-static void OPM_Output(opm_t *chip)
+static OPM_INLINE void OPM_Output(opm_t *chip, uint32_t cycles)
 {
-    uint32_t slot = (chip->cycles + 27) % 32;
+    uint32_t slot = (cycles + 27) % 32;
     chip->smp_so = (chip->mix_out_bit & 4) != 0;
     chip->smp_sh1 = (slot & 24) == 8 && !chip->ic;
     chip->smp_sh2 = (slot & 24) == 24 && !chip->ic;
 }
 
-static void OPM_DAC(opm_t *chip)
+static OPM_INLINE void OPM_DAC(opm_t *chip)
 {
     int32_t exp, mant;
     if (chip->dac_osh1 && !chip->smp_sh1)
@@ -1146,17 +1051,33 @@ static void OPM_DAC(opm_t *chip)
     chip->dac_osh2 = chip->smp_sh2;
 }
 
-static void OPM_Mixer(opm_t *chip)
+/* The 16-bit frame the serial mixer sends for a channel sum: bits 0-17 of
+ * the sum saturated to 16 bits, sign bit inverted. */
+static OPM_INLINE uint16_t OPM_MixFrame(int32_t mix)
+{
+    int32_t v = (int32_t)((uint32_t)mix << 14) >> 14;
+    if (v > 32767)
+    {
+        v = 32767;
+    }
+    else if (v < -32768)
+    {
+        v = -32768;
+    }
+    return (v & 0xffff) ^ 0x8000;
+}
+
+static OPM_INLINE void OPM_Mixer(opm_t *chip, uint32_t cycles)
 {
-    uint32_t slot = (chip->cycles + 18) % 32;
+    uint32_t slot = (cycles + 18) % 32;
     uint32_t channel = (slot % 8);
     // Right channel
     chip->mix_serial[1] >>= 1;
-    if (chip->cycles == 13)
+    if (cycles == 13)
     {
         chip->mix_serial[1] |= (chip->mix[1] & 1023) << 4;
     }
-    if (chip->cycles == 14)
+    if (cycles == 14)
     {
         chip->mix_serial[1] |= ((chip->mix2[1] >> 10) & 31) << 13;
         chip->mix_serial[1] |= (((chip->mix2[1] >> 17) & 1) ^ 1) << 18;
@@ -1199,11 +1120,11 @@ static void OPM_Mixer(opm_t *chip)
     }
     // Left channel
     chip->mix_serial[0] >>= 1;
-    if (chip->cycles == 29)
+    if (cycles == 29)
     {
         chip->mix_serial[0] |= (chip->mix[0] & 1023) << 4;
     }
-    if (chip->cycles == 30)
+    if (cycles == 30)
     {
         chip->mix_serial[0] |= ((chip->mix2[0] >> 10) & 31) << 13;
         chip->mix_serial[0] |= (((chip->mix2[0] >> 17) & 1) ^ 1) << 18;
@@ -1246,19 +1167,164 @@ static void OPM_Mixer(opm_t *chip)
     }
     chip->mix2[0] = chip->mix[0];
     chip->mix2[1] = chip->mix[1];
-    if (chip->cycles == 13)
+    if (cycles == 13)
+    {
+        chip->mix_frame_prev[1] = chip->mix_frame[1];
+        chip->mix_frame[1] = OPM_MixFrame(chip->mix[1]);
+        chip->mix[1] = 0;
+    }
+    if (cycles == 29)
+    {
+        chip->mix_frame_prev[0] = chip->mix_frame[0];
+        chip->mix_frame[0] = OPM_MixFrame(chip->mix[0]);
+        chip->mix[0] = 0;
+    }
+    chip->mix[0] += chip->op_mix * chip->op_mixl;
+    chip->mix[1] += chip->op_mix * chip->op_mixr;
+}
+
+/* Word-level replacement for OPM_Mixer2 + OPM_Mixer. The serial mixer sends
+ * each channel sum as 16 bits, LSB first: the right channel during cycles
+ * 18-1, the left one during 2-17. Mixer2 turns that stream into the DAC's
+ * floating point format, and its output bits for cycles base..base+15
+ * (base = 10 or 26, where the exponent is latched) only depend on the two
+ * latest frames, so they are computed here in one go:
+ *   base+0..4, +9..15: bit (exp + 3 + i) of the frame pair, i.e. mantissa
+ *                      bits of this frame, then of the other channel's
+ *   base+5:            inverted sign
+ *   base+6..8:         exponent
+ * OPM_Output and OPM_DAC are shared with the serial path, so sh1/sh2/so and
+ * dac_output are unchanged. The model assumes consecutive cycles; OPM_SetIC
+ * hands over to the serial path when releasing IC resets the counter
+ * mid-round. */
+static OPM_INLINE uint16_t OPM_MixOutWord(uint32_t frame, uint32_t other)
+{
+    uint32_t pair = frame | (other << 16);
+    uint8_t top = (frame >> 9) & 63;
+    uint8_t ex;
+    if (!(frame & 0x8000))
+    {
+        top ^= 63;
+    }
+    ex = OPM_MixExponent(top);
+    return ((pair >> (ex + 3)) & 0xfe1f) | ((frame >> 15) << 5) | (ex << 6);
+}
+
+static OPM_INLINE void OPM_MixerWord(opm_t *chip, uint32_t cycles)
+{
+    if (cycles % 16 == 10)
+    {
+        chip->mix_out_word = OPM_MixOutWord(chip->mix_frame[cycles == 10], chip->mix_frame[cycles != 10]);
+    }
+    chip->mix_out_bit <<= 1;
+    chip->mix_out_bit |= (chip->mix_out_word >> ((cycles + 6) % 16)) & 1;
+    if (cycles == 13)
     {
+        chip->mix_frame_prev[1] = chip->mix_frame[1];
+        chip->mix_frame[1] = OPM_MixFrame(chip->mix[1]);
         chip->mix[1] = 0;
     }
-    if (chip->cycles == 29)
+    if (cycles == 29)
     {
+        chip->mix_frame_prev[0] = chip->mix_frame[0];
+        chip->mix_frame[0] = OPM_MixFrame(chip->mix[0]);
         chip->mix[0] = 0;
     }
     chip->mix[0] += chip->op_mix * chip->op_mixl;
     chip->mix[1] += chip->op_mix * chip->op_mixr;
 }
 
-static void OPM_Noise(opm_t *chip)
+/* Stream bit Mixer2 reads at cycle x of the current round (negative: an
+ * earlier round) when the next cycle to run is n. Every bit in reach belongs
+ * to the latest frame of its channel or the one before. */
+static uint32_t OPM_MixerStreamBit(opm_t *chip, uint32_t n, int32_t x)
+{
+    uint32_t ch = ((x + 30) & 31) >= 16;
+    int32_t bit = (x - 2) & 15;
+    int32_t latest = ch ? (n >= 14 ? 13 : -19) : (n >= 30 ? 29 : -3);
+    uint32_t frame = x - bit - 5 == latest ? chip->mix_frame[ch] : chip->mix_frame_prev[ch];
+    return (frame >> bit) & 1;
+}
+
+/* Rebuild the serial mixer state the word path does not keep, as it would be
+ * before cycle n: the stream bits received, the locks and the shift
+ * registers. A clamped frame is all ones or all zeros, so it stands for the
+ * raw sum and the clamp flags follow from it. */
+static void OPM_MixerToSerial(opm_t *chip, uint32_t n)
+{
+    int32_t latch = (int32_t)n - 1 - (int32_t)((n + 14) % 16);
+    int32_t base = (int32_t)n - 1 - (int32_t)((n + 5) % 16);
+    uint32_t i, ch, m, frame, top;
+    chip->mix_bits = 0;
+    for (i = 0; i < 21; i++)
+    {
+        chip->mix_bits |= OPM_MixerStreamBit(chip, n, (int32_t)(n + i) - 21) << i;
+    }
+    chip->mix_top_bits_lock = 0;
+    top = 0;
+    for (i = 0; i < 6; i++)
+    {
+        chip->mix_top_bits_lock |= OPM_MixerStreamBit(chip, n, latch - 6 + i) << i;
+        top |= OPM_MixerStreamBit(chip, n, base - 15 + i) << i;
+    }
+    chip->mix_sign_lock = OPM_MixerStreamBit(chip, n, latch) ^ 1;
+    chip->mix_sign_lock2 = OPM_MixerStreamBit(chip, n, base - 9) ^ 1;
+    if (chip->mix_sign_lock2)
+    {
+        top ^= 63;
+    }
+    chip->mix_exp_lock = OPM_MixExponent(top);
+    for (ch = 0; ch < 2; ch++)
+    {
+        m = ch ? n : (n + 16) % 32;
+        frame = chip->mix_frame[ch];
+        if (m == 14)
+        {
+            // Low half loaded, high half still to come from mix2
+            frame = chip->mix_frame_prev[ch];
+            chip->mix_serial[ch] = (chip->mix_frame[ch] & 1023) << 4;
+            chip->mix2[ch] = (int16_t)(chip->mix_frame[ch] ^ 0x8000);
+        }
+        else if (m >= 15)
+        {
+            chip->mix_serial[ch] = m <= 18 ? frame << (18 - m) : frame >> (m - 18);
+        }
+        else
+        {
+            chip->mix_serial[ch] = frame >> (m + 14);
+        }
+        chip->mix_clamp_high[ch] = frame == 0xffff;
+        chip->mix_clamp_low[ch] = frame == 0;
+        if (chip->mix_clamp_high[ch])
+        {
+            chip->mix_serial[ch] |= 3;
+        }
+    }
+}
+
+/* Apply a pending OPM_SetWordMixer at an exponent latch cycle (10 or 26).
+ * The word path needs nothing but the frames, which both paths keep, but
+ * its model only holds once the stream is aligned again after a mid-round
+ * IC release (mix_word_wait). */
+static void OPM_MixerSetMode(opm_t *chip, uint32_t cycles)
+{
+    if (chip->mix_word_wait)
+    {
+        chip->mix_word_wait--;
+        return;
+    }
+    if (chip->mix_word == chip->mix_word_req)
+    {
+        return;
+    }
+    if (chip->mix_word)
+    {
+        OPM_MixerToSerial(chip, cycles);
+    }
+    chip->mix_word = chip->mix_word_req;
+}
+
+static OPM_INLINE void OPM_Noise(opm_t *chip)
 {
     uint8_t w1 = !chip->ic && !chip->noise_update;
     uint8_t xr = ((chip->noise_lfsr >> 2) & 1) ^ chip->noise_temp;
@@ -1274,18 +1340,18 @@ static void OPM_Noise(opm_t *chip)
     chip->noise_lfsr |= w4 << 15;
 }
 
-static void OPM_NoiseTimer(opm_t *chip)
+static OPM_INLINE void OPM_NoiseTimer(opm_t *chip, uint32_t cycles)
 {
     uint32_t timer = chip->noise_timer;
 
     chip->noise_update = chip->noise_timer_of;
 
-    if (chip->cycles % 16 == 15)
+    if (cycles % 16 == 15)
     {
         timer++;
         timer &= 31;
     }
-    if (chip->ic || (chip->noise_timer_of && (chip->cycles % 16 == 15)))
+    if (chip->ic || (chip->noise_timer_of && (cycles % 16 == 15)))
     {
         timer = 0;
     }
@@ -1294,7 +1360,7 @@ static void OPM_NoiseTimer(opm_t *chip)
     chip->noise_timer = timer;
 }
 
-static void OPM_DoTimerA(opm_t *chip)
+static OPM_INLINE void OPM_DoTimerA(opm_t *chip)
 {
     uint16_t value = chip->timer_a_val;
     value += chip->timer_a_inc;
@@ -1311,13 +1377,13 @@ static void OPM_DoTimerA(opm_t *chip)
     chip->timer_a_val = value & 1023;
 }
 
-static void OPM_DoTimerA2(opm_t *chip)
+static OPM_INLINE void OPM_DoTimerA2(opm_t *chip, uint32_t cycles)
 {
-    if (chip->cycles == 1)
+    if (cycles == 1)
     {
         chip->timer_a_load = chip->timer_loada;
     }
-    chip->timer_a_inc = chip->mode_test[2] || (chip->timer_a_load && chip->cycles == 0);
+    chip->timer_a_inc = chip->mode_test[2] || (chip->timer_a_load && cycles == 0);
     chip->timer_a_do_load = chip->timer_a_of || (chip->timer_a_load && chip->timer_a_temp);
     chip->timer_a_do_reset = chip->timer_a_temp;
     chip->timer_a_temp = !chip->timer_a_load;
@@ -1332,7 +1398,7 @@ static void OPM_DoTimerA2(opm_t *chip)
     chip->timer_reseta = 0;
 }
 
-static void OPM_DoTimerB(opm_t *chip)
+static OPM_INLINE void OPM_DoTimerB(opm_t *chip, uint32_t cycles)
 {
     uint16_t value = chip->timer_b_val;
     value += chip->timer_b_inc;
@@ -1348,7 +1414,7 @@ static void OPM_DoTimerB(opm_t *chip)
 
     chip->timer_b_val = value & 255;
 
-    if (chip->cycles == 0)
+    if (cycles == 0)
     {
         chip->timer_b_sub++;
     }
@@ -1361,7 +1427,7 @@ static void OPM_DoTimerB(opm_t *chip)
     }
 }
 
-static void OPM_DoTimerB2(opm_t *chip)
+static OPM_INLINE void OPM_DoTimerB2(opm_t *chip)
 {
     chip->timer_b_inc = chip->mode_test[2] || (chip->timer_loadb && chip->timer_b_sub_of);
     chip->timer_b_do_load = chip->timer_b_of || (chip->timer_loadb && chip->timer_b_temp);
@@ -1378,12 +1444,12 @@ static void OPM_DoTimerB2(opm_t *chip)
     chip->timer_resetb = 0;
 }
 
-static void OPM_DoTimerIRQ(opm_t *chip)
+static OPM_INLINE void OPM_DoTimerIRQ(opm_t *chip)
 {
     chip->timer_irq = chip->timer_a_status || chip->timer_b_status;
 }
 
-static void OPM_DoLFOMult(opm_t *chip)
+static OPM_INLINE void OPM_LFOMultSerial(opm_t *chip, uint32_t cycles)
 {
     uint8_t ampm_sel = (chip->lfo_bit_counter & 8) != 0;
     uint8_t dp = ampm_sel ? chip->lfo_pmd : chip->lfo_amd;
@@ -1423,7 +1489,7 @@ static void OPM_DoLFOMult(opm_t *chip)
         b1 = 0;
     }
     b2 = chip->lfo_mult_carry;
-    if (chip->cycles % 16 == 15)
+    if (cycles % 16 == 15)
     {
         b2 = 0;
     }
@@ -1433,80 +1499,195 @@ static void OPM_DoLFOMult(opm_t *chip)
     chip->lfo_mult_carry = sum >> 1;
 }
 
-static void OPM_DoLFO1(opm_t *chip)
+#ifdef OPM_SERIAL_LFO
+static OPM_INLINE void OPM_DoLFOMult(opm_t *chip, uint32_t cycles)
 {
-    uint16_t counter2 = chip->lfo_counter2;
-    uint8_t of_old = chip->lfo_counter2_of;
-    uint8_t lfo_bit, noise, sum, carry, w[10];
-    uint8_t lfo_pm_sign;
-    uint8_t ampm_sel = (chip->lfo_bit_counter & 8) != 0;
-    counter2 += (chip->lfo_counter1_of1 & 2) != 0 || chip->mode_test[3];
-    chip->lfo_counter2_of = (counter2 >> 15) & 1;
-    if (chip->ic)
+    OPM_LFOMultSerial(chip, cycles);
+}
+
+static void OPM_LFOMultSync(opm_t *chip, uint32_t cycles)
+{
+    (void)chip;
+    (void)cycles;
+}
+
+static void OPM_LFOMultToSerial(opm_t *chip, uint32_t cycles)
+{
+    (void)chip;
+    (void)cycles;
+}
+#else
+/* Word-level LFO multiplier (build with OPM_SERIAL_LFO for the bit-serial
+ * one). A word runs from cycle 15 to cycle 14 with one bit counter value k:
+ * when depth bit 6 - k is set it adds the waveform byte shifted left by
+ * 7 - k to the word before (to nothing for k = 0). That sum is done in one go
+ * at the word's last cycle, so a depth write mid-word first does the bits so
+ * far with the old depth. An IC jump misaligns the words; the multiplier then
+ * runs serially until the next word starts. */
+
+/* The waveform bits of this half (w8 of cycles 15-6, in order) from lfo_out1,
+ * whose last bit is the one of index last (cycle last - 1) */
+static OPM_INLINE uint32_t OPM_LFOMultWave(opm_t *chip, uint32_t last)
+{
+    uint32_t wave = 0;
+    uint32_t j;
+    for (j = 0; j < 8 && j <= last; j++)
     {
-        counter2 = 0;
+        wave |= (~(chip->lfo_out1 >> (last - j)) & 1) << j;
     }
-    if (chip->lfo_counter2_load)
+    return wave;
+}
+
+/* Partial product bits lfo_mult_pos to n - 1, with the depth and bit counter
+ * they have now. A bit only needs the waveform up to 7 cycles before it. */
+static OPM_INLINE void OPM_LFOMultBits(opm_t *chip, uint32_t n, uint32_t last)
+{
+    uint32_t k = chip->lfo_bit_counter & 7;
+    uint8_t dp = (chip->lfo_bit_counter & 8) ? chip->lfo_pmd : chip->lfo_amd;
+    if (k < 7 && ((dp >> (6 - k)) & 1))
     {
-        counter2 = lfo_counter2_table[chip->lfo_freq_hi];
+        uint32_t mask = (1u << n) - (1u << chip->lfo_mult_pos);
+        chip->lfo_mult_p |= (OPM_LFOMultWave(chip, last) << (7 - k)) & mask;
     }
-    chip->lfo_counter2 = counter2 & 32767;
-    chip->lfo_counter2_load = chip->lfo_frq_update || of_old;
-    chip->lfo_frq_update = 0;
-    if ((chip->cycles % 16) == 12)
+    chip->lfo_mult_pos = n;
+}
+
+static OPM_INLINE void OPM_DoLFOMult(opm_t *chip, uint32_t cycles)
+{
+    uint32_t sum;
+    if (chip->lfo_mult_serial)
     {
-        chip->lfo_counter1++;
+        if ((cycles & 15) != 15)
+        {
+            OPM_LFOMultSerial(chip, cycles);
+            return;
+        }
+        chip->lfo_mult_serial = 0;
     }
-    chip->lfo_counter1_of1 <<= 1;
-    chip->lfo_counter1_of1 |= (chip->lfo_counter1 >> 4) & 1;
-    chip->lfo_counter1 &= 15;
-    if (chip->ic)
+    if ((cycles & 15) == 15)
     {
-        chip->lfo_counter1 = 0;
+        chip->lfo_out2_b = chip->lfo_out2;
     }
-
-    if ((chip->cycles & 15) == 5)
+    else if ((cycles & 15) == 14)
     {
-        chip->lfo_counter2_of_lock2 = chip->lfo_counter2_of_lock;
+        OPM_LFOMultBits(chip, 16, 14);
+        sum = ((chip->lfo_bit_counter & 7) ? chip->lfo_out2 : 0) + chip->lfo_mult_p;
+        chip->lfo_out2 = sum & 0xffff;
+        chip->lfo_mult_carry = sum >> 16;
+        chip->lfo_mult_p = 0;
+        chip->lfo_mult_pos = 0;
     }
+}
 
-    chip->lfo_counter3 += chip->lfo_counter3_clock;
+/* The depth is about to change, after the multiplier ran for cycle cycles */
+static void OPM_LFOMultSync(opm_t *chip, uint32_t cycles)
+{
+    uint32_t index = (cycles + 1) & 15;
+    if (!chip->lfo_mult_serial && index != 15)
+    {
+        OPM_LFOMultBits(chip, index + 1, index);
+    }
+}
+
+/* Turn the current word into the serial adder's state before cycle cycles:
+ * lfo_out2 holds the sum bits done so far above the rest of the word before,
+ * and lfo_mult_carry the carry out of them */
+static void OPM_LFOMultToSerial(opm_t *chip, uint32_t cycles)
+{
+    uint32_t n = (cycles & 15) + 1;
+    uint32_t mask, sum;
+    if (chip->lfo_mult_serial)
+    {
+        return;
+    }
+    if (n != 16) // Else the word is complete
+    {
+        OPM_LFOMultBits(chip, n, n - 1);
+        mask = (1u << n) - 1;
+        sum = (((chip->lfo_bit_counter & 7) ? chip->lfo_out2 : 0) & mask) + (chip->lfo_mult_p & mask);
+        chip->lfo_mult_carry = sum >> n;
+        chip->lfo_out2 = ((sum & mask) << (16 - n)) | (chip->lfo_out2 >> n);
+    }
+    chip->lfo_mult_p = 0;
+    chip->lfo_mult_pos = 0;
+    chip->lfo_mult_serial = 1;
+}
+#endif
+
+static OPM_INLINE void OPM_DoLFO1(opm_t *chip, uint32_t cycles)
+{
+    uint16_t counter2 = chip->lfo_counter2;
+    uint8_t of_old = chip->lfo_counter2_of;
+    uint8_t lfo_bit, noise, sum, carry, w[10];
+    uint8_t lfo_pm_sign, lfo_pm_lock;
+    uint8_t ampm_sel = (chip->lfo_bit_counter & 8) != 0;
+    counter2 += (chip->lfo_counter1_of1 & 2) != 0 || chip->mode_test[3];
+    chip->lfo_counter2_of = (counter2 >> 15) & 1;
+    if (chip->ic)
+    {
+        counter2 = 0;
+    }
+    if (chip->lfo_counter2_load)
+    {
+        counter2 = lfo_counter2_table[chip->lfo_freq_hi];
+    }
+    chip->lfo_counter2 = counter2 & 32767;
+    chip->lfo_counter2_load = chip->lfo_frq_update || of_old;
+    chip->lfo_frq_update = 0;
+    if ((cycles % 16) == 12)
+    {
+        chip->lfo_counter1++;
+    }
+    chip->lfo_counter1_of1 <<= 1;
+    chip->lfo_counter1_of1 |= (chip->lfo_counter1 >> 4) & 1;
+    chip->lfo_counter1 &= 15;
+    if (chip->ic)
+    {
+        chip->lfo_counter1 = 0;
+    }
+
+    if ((cycles & 15) == 5)
+    {
+        chip->lfo_counter2_of_lock2 = chip->lfo_counter2_of_lock;
+    }
+
+    chip->lfo_counter3 += chip->lfo_counter3_clock;
     if (chip->ic)
     {
         chip->lfo_counter3 = 0;
     }
 
-    chip->lfo_counter3_clock = (chip->cycles & 15) == 13 && chip->lfo_counter2_of_lock2;
+    chip->lfo_counter3_clock = (cycles & 15) == 13 && chip->lfo_counter2_of_lock2;
 
-    if ((chip->cycles & 15) == 15)
+    if ((cycles & 15) == 15)
     {
         chip->lfo_trig_sign = (chip->lfo_val & 0x80) != 0;
         chip->lfo_saw_sign = (chip->lfo_val & 0x100) != 0;
     }
 
-    lfo_pm_sign = chip->lfo_wave == 2 ? chip->lfo_trig_sign : chip->lfo_saw_sign;
-
-    w[5] = ampm_sel ? chip->lfo_saw_sign : (chip->lfo_wave != 2 || !chip->lfo_trig_sign);
-
-    w[1] = !chip->lfo_clock || chip->lfo_wave == 3 || (chip->cycles & 15) != 15;
+    w[1] = !chip->lfo_clock || chip->lfo_wave == 3 || (cycles & 15) != 15;
     w[2] = chip->lfo_wave == 2 && !w[1];
     w[4] = chip->lfo_clock_lock && chip->lfo_wave == 3;
     w[3] = !chip->ic && !chip->mode_test[1] && !w[4] && (chip->lfo_val & 0x8000) != 0;
 
-    w[7] = ((chip->cycles + 1) % 16) < 8;
+    w[7] = ((cycles + 1) % 16) < 8;
 
-    w[6] = w[5] ^ w[3];
-    
-    w[9] = ampm_sel ? ((chip->cycles % 16) == 6) : !chip->lfo_saw_sign;
+    w[8] = 0;
+    if (w[7]) // The waveform only reaches the multiplier in these cycles
+    {
+        w[5] = ampm_sel ? chip->lfo_saw_sign : (chip->lfo_wave != 2 || !chip->lfo_trig_sign);
 
-    w[8] = chip->lfo_wave == 1 ? w[9] : w[6];
+        w[6] = w[5] ^ w[3];
 
-    w[8] &= w[7];
+        w[9] = ampm_sel ? ((cycles % 16) == 6) : !chip->lfo_saw_sign;
+
+        w[8] = chip->lfo_wave == 1 ? w[9] : w[6];
+    }
 
     chip->lfo_out1 <<= 1;
     chip->lfo_out1 |= !w[8];
 
-    carry = !w[1] || ((chip->cycles & 15) != 15 && chip->lfo_val_carry != 0 && chip->lfo_wave != 3);
+    carry = !w[1] || ((cycles & 15) != 15 && chip->lfo_val_carry != 0 && chip->lfo_wave != 3);
     sum = carry + w[2] + w[3];
     noise = chip->lfo_clock_lock && (chip->noise_lfsr & 1) != 0;
     lfo_bit = sum & 1;
@@ -1516,12 +1697,17 @@ static void OPM_DoLFO1(opm_t *chip)
     chip->lfo_val |= lfo_bit;
     
 
-    if (chip->cycles % 16 == 15 && (chip->lfo_bit_counter & 7) == 7)
+    if (cycles % 16 == 15 && (chip->lfo_bit_counter & 7) == 7)
     {
         if (ampm_sel)
         {
-            chip->lfo_pm_lock = (chip->lfo_out2_b >> 8) & 255;
-            chip->lfo_pm_lock ^= lfo_pm_sign << 7;
+            lfo_pm_sign = chip->lfo_wave == 2 ? chip->lfo_trig_sign : chip->lfo_saw_sign;
+            lfo_pm_lock = ((chip->lfo_out2_b >> 8) & 255) ^ (lfo_pm_sign << 7);
+            if (chip->lfo_pmd && chip->lfo_pm_lock != lfo_pm_lock)
+            {
+                chip->pg_fnum_dirty = 0xffffffff;
+            }
+            chip->lfo_pm_lock = lfo_pm_lock;
         }
         else
         {
@@ -1529,22 +1715,22 @@ static void OPM_DoLFO1(opm_t *chip)
         }
     }
 
-    if ((chip->cycles & 15) == 14)
+    if ((cycles & 15) == 14)
     {
         chip->lfo_bit_counter++;
     }
-    if ((chip->cycles & 15) != 12 && chip->lfo_counter1_of2)
+    if ((cycles & 15) != 12 && chip->lfo_counter1_of2)
     {
         chip->lfo_bit_counter = 0;
     }
     chip->lfo_counter1_of2 = chip->lfo_counter1 == 2;
 }
 
-static void OPM_DoLFO2(opm_t *chip)
+static OPM_INLINE void OPM_DoLFO2(opm_t *chip, uint32_t cycles)
 {
     chip->lfo_clock_test = chip->lfo_clock;
     chip->lfo_clock = (chip->lfo_counter2_of || chip->lfo_test || chip->lfo_counter3_step);
-    if ((chip->cycles & 15) == 14)
+    if ((cycles & 15) == 14)
     {
         chip->lfo_counter2_of_lock = chip->lfo_counter2_of;
         chip->lfo_clock_lock = chip->lfo_clock;
@@ -1572,26 +1758,26 @@ static void OPM_DoLFO2(opm_t *chip)
     chip->lfo_test = chip->mode_test[2];
 }
 
-static void OPM_CSM(opm_t *chip)
+static OPM_INLINE void OPM_CSM(opm_t *chip, uint32_t cycles)
 {
     chip->kon_csm = chip->kon_csm_lock;
-    if (chip->cycles == 1)
+    if (cycles == 1)
     {
         chip->kon_csm_lock = chip->timer_a_do_load && chip->mode_csm;
     }
 }
 
-static void OPM_NoiseChannel(opm_t *chip)
+static OPM_INLINE void OPM_NoiseChannel(opm_t *chip, uint32_t cycles)
 {
     chip->nc_active |= chip->eg_serial_bit & 1;
-    if (chip->cycles == 13)
+    if (cycles == 13)
     {
         chip->nc_active = 0;
     }
     chip->nc_out <<= 1;
     chip->nc_out |= chip->nc_sign ^ chip->eg_serial_bit;
     chip->nc_sign = !chip->nc_sign_lock;
-    if (chip->cycles == 12)
+    if (cycles == 12)
     {
         chip->nc_active_lock = chip->nc_active;
         chip->nc_sign_lock2 = chip->nc_active_lock && !chip->nc_sign_lock;
@@ -1611,7 +1797,7 @@ static void OPM_NoiseChannel(opm_t *chip)
     }
 }
 
-static void OPM_DoIO(opm_t *chip)
+static OPM_INLINE void OPM_DoIO(opm_t *chip)
 {
     // Busy
     chip->write_busy_cnt += chip->write_busy;
@@ -1628,11 +1814,145 @@ static void OPM_DoIO(opm_t *chip)
     chip->write_d = 0;
 }
 
-static void OPM_DoRegWrite(opm_t *chip)
+// Channel register (0x20-0x3f) of channel
+static OPM_INLINE void OPM_WriteChannelReg(opm_t *chip, uint32_t channel, uint8_t address, uint8_t data)
+{
+    switch (address & 0x18)
+    {
+    case 0x00: // RL, FB, CONNECT
+        chip->ch_rl[channel] = data >> 6;
+        chip->ch_fb[channel] = (data >> 3) & 0x07;
+        chip->ch_connect[channel] = data & 0x07;
+        break;
+    case 0x08: // KC
+        chip->ch_kc[channel] = data & 0x7f;
+        chip->pg_fnum_dirty |= 0x01010101u << channel;
+        break;
+    case 0x10: // KF
+        chip->ch_kf[channel] = data >> 2;
+        chip->pg_fnum_dirty |= 0x01010101u << channel;
+        break;
+    case 0x18: // PMS, AMS
+        chip->ch_pms[channel] = (data >> 4) & 0x07;
+        chip->ch_ams[channel] = data & 0x03;
+        chip->pg_fnum_dirty |= 0x01010101u << channel;
+        chip->eg_rate_dirty |= 0x01010101u << channel;
+        break;
+    default:
+        break;
+    }
+}
+
+// Operator register (0x40-0xff) of slot
+static OPM_INLINE void OPM_WriteSlotReg(opm_t *chip, uint32_t slot, uint8_t address, uint8_t data)
+{
+    switch (address & 0xe0)
+    {
+    case 0x40: // DT1, MUL
+        chip->sl_dt1[slot] = (data >> 4) & 0x07;
+        chip->sl_mul[slot] = data & 0x0f;
+        chip->pg_inc_dirty |= 1u << slot;
+        break;
+    case 0x60: // TL
+        chip->sl_tl[slot] = data & 0x7f;
+        break;
+    case 0x80: // KS, AR
+        chip->sl_ks[slot] = data >> 6;
+        chip->sl_ar[slot] = data & 0x1f;
+        chip->eg_rate_dirty |= 1u << slot;
+        break;
+    case 0xa0: // AMS-EN, D1R
+        chip->sl_am_e[slot] = data >> 7;
+        chip->sl_d1r[slot] = data & 0x1f;
+        chip->eg_rate_dirty |= 1u << slot;
+        break;
+    case 0xc0: // DT2, D2R
+        chip->sl_dt2[slot] = data >> 6;
+        chip->sl_d2r[slot] = data & 0x1f;
+        chip->eg_rate_dirty |= 1u << slot;
+        chip->pg_fnum_dirty |= 1u << slot;
+        break;
+    case 0xe0: // D1L, RR
+        chip->sl_d1l[slot] = data >> 4;
+        chip->sl_rr[slot] = data & 0x0f;
+        chip->eg_rate_dirty |= 1u << slot;
+        break;
+    default:
+        break;
+    }
+}
+
+// Mode register (0x01-0x1b)
+static OPM_INLINE void OPM_WriteModeReg(opm_t *chip, uint8_t address, uint8_t data)
 {
     int32_t i;
-    uint32_t channel = chip->cycles % 8;
-    uint32_t slot = chip->cycles;
+    switch (address)
+    {
+    case 0x01:
+        for (i = 0; i < 8; i++)
+        {
+            chip->mode_test[i] = (data >> i) & 0x01;
+        }
+        break;
+    case 0x08:
+        for (i = 0; i < 4; i++)
+        {
+            chip->mode_kon_operator[i] = (data >> (i + 3)) & 0x01;
+        }
+        chip->mode_kon_channel = data & 0x07;
+        break;
+    case 0x0f:
+        chip->noise_en = data >> 7;
+        chip->noise_freq = data & 0x1f;
+        break;
+    case 0x10:
+        chip->timer_a_reg &= 0x03;
+        chip->timer_a_reg |= data << 2;
+        break;
+    case 0x11:
+        chip->timer_a_reg &= 0x3fc;
+        chip->timer_a_reg |= data & 0x03;
+        break;
+    case 0x12:
+        chip->timer_b_reg = data;
+        break;
+    case 0x14:
+        chip->mode_csm = (data >> 7) & 1;
+        chip->timer_irqb = (data >> 3) & 1;
+        chip->timer_irqa = (data >> 2) & 1;
+        chip->timer_resetb = (data >> 5) & 1;
+        chip->timer_reseta = (data >> 4) & 1;
+        chip->timer_loadb = (data >> 1) & 1;
+        chip->timer_loada = (data >> 0) & 1;
+        break;
+    case 0x18:
+        chip->lfo_freq_hi = data >> 4;
+        chip->lfo_freq_lo = data & 0x0f;
+        chip->lfo_frq_update = 1;
+        break;
+    case 0x19:
+        if (data & 0x80)
+        {
+            chip->lfo_pmd = data & 0x7f;
+            chip->pg_fnum_dirty = 0xffffffff;
+        }
+        else
+        {
+            chip->lfo_amd = data;
+        }
+        break;
+    case 0x1b:
+        chip->lfo_wave = data & 0x03;
+        chip->io_ct1 = (data >> 6) & 0x01;
+        chip->io_ct2 = data >> 7;
+        break;
+    }
+}
+
+static OPM_INLINE void OPM_DoRegWrite(opm_t *chip, uint32_t cycles)
+{
+    uint32_t channel = cycles % 8;
+    uint32_t slot = cycles;
 
     // Register write
     if (chip->reg_data_ready)
@@ -1640,124 +1960,23 @@ static void OPM_DoRegWrite(opm_t *chip)
         // Channel
         if ((chip->reg_address & 0xe7) == (0x20 | channel))
         {
-            switch (chip->reg_address & 0x18)
-            {
-            case 0x00: // RL, FB, CONNECT
-                chip->ch_rl[channel] = chip->reg_data >> 6;
-                chip->ch_fb[channel] = (chip->reg_data >> 3) & 0x07;
-                chip->ch_connect[channel] = chip->reg_data & 0x07;
-                break;
-            case 0x08: // KC
-                chip->ch_kc[channel] = chip->reg_data & 0x7f;
-                break;
-            case 0x10: // KF
-                chip->ch_kf[channel] = chip->reg_data >> 2;
-                break;
-            case 0x18: // PMS, AMS
-                chip->ch_pms[channel] = (chip->reg_data >> 4) & 0x07;
-                chip->ch_ams[channel] = chip->reg_data & 0x03;
-                break;
-            default:
-                break;
-            }
+            OPM_WriteChannelReg(chip, channel, chip->reg_address, chip->reg_data);
         }
         // Slot
         if ((chip->reg_address & 0x1f) == slot)
         {
-            switch (chip->reg_address & 0xe0)
-            {
-            case 0x40: // DT1, MUL
-                chip->sl_dt1[slot] = (chip->reg_data >> 4) & 0x07;
-                chip->sl_mul[slot] = chip->reg_data & 0x0f;
-                break;
-            case 0x60: // TL
-                chip->sl_tl[slot] = chip->reg_data & 0x7f;
-                break;
-            case 0x80: // KS, AR
-                chip->sl_ks[slot] = chip->reg_data >> 6;
-                chip->sl_ar[slot] = chip->reg_data & 0x1f;
-                break;
-            case 0xa0: // AMS-EN, D1R
-                chip->sl_am_e[slot] = chip->reg_data >> 7;
-                chip->sl_d1r[slot] = chip->reg_data & 0x1f;
-                break;
-            case 0xc0: // DT2, D2R
-                chip->sl_dt2[slot] = chip->reg_data >> 6;
-                chip->sl_d2r[slot] = chip->reg_data & 0x1f;
-                break;
-            case 0xe0: // D1L, RR
-                chip->sl_d1l[slot] = chip->reg_data >> 4;
-                chip->sl_rr[slot] = chip->reg_data & 0x0f;
-                break;
-            default:
-                break;
-            }
+            OPM_WriteSlotReg(chip, slot, chip->reg_address, chip->reg_data);
         }
     }
 
     // Mode write
     if (chip->write_d_en)
     {
-        switch (chip->mode_address)
+        if (chip->mode_address == 0x19)
         {
-        case 0x01:
-            for (i = 0; i < 8; i++)
-            {
-                chip->mode_test[i] = (chip->write_data >> i) & 0x01;
-            }
-            break;
-        case 0x08:
-            for (i = 0; i < 4; i++)
-            {
-                chip->mode_kon_operator[i] = (chip->write_data >> (i + 3)) & 0x01;
-            }
-            chip->mode_kon_channel = chip->write_data & 0x07;
-            break;
-        case 0x0f:
-            chip->noise_en = chip->write_data >> 7;
-            chip->noise_freq = chip->write_data & 0x1f;
-            break;
-        case 0x10:
-            chip->timer_a_reg &= 0x03;
-            chip->timer_a_reg |= chip->write_data << 2;
-            break;
-        case 0x11:
-            chip->timer_a_reg &= 0x3fc;
-            chip->timer_a_reg |= chip->write_data & 0x03;
-            break;
-        case 0x12:
-            chip->timer_b_reg = chip->write_data;
-            break;
-        case 0x14:
-            chip->mode_csm = (chip->write_data >> 7) & 1;
-            chip->timer_irqb = (chip->write_data >> 3) & 1;
-            chip->timer_irqa = (chip->write_data >> 2) & 1;
-            chip->timer_resetb = (chip->write_data >> 5) & 1;
-            chip->timer_reseta = (chip->write_data >> 4) & 1;
-            chip->timer_loadb = (chip->write_data >> 1) & 1;
-            chip->timer_loada = (chip->write_data >> 0) & 1;
-            break;
-        case 0x18:
-            chip->lfo_freq_hi = chip->write_data >> 4;
-            chip->lfo_freq_lo = chip->write_data & 0x0f;
-            chip->lfo_frq_update = 1;
-            break;
-        case 0x19:
-            if (chip->write_data & 0x80)
-            {
-                chip->lfo_pmd = chip->write_data & 0x7f;
-            }
-            else
-            {
-                chip->lfo_amd = chip->write_data;
-            }
-            break;
-        case 0x1b:
-            chip->lfo_wave = chip->write_data & 0x03;
-            chip->io_ct1 = (chip->write_data >> 6) & 0x01;
-            chip->io_ct2 = chip->write_data >> 7;
-            break;
+            OPM_LFOMultSync(chip, cycles);
         }
+        OPM_WriteModeReg(chip, chip->mode_address, chip->write_data);
     }
 
     // Register data write
@@ -1781,10 +2000,10 @@ static void OPM_DoRegWrite(opm_t *chip)
     }
 }
 
-static void OPM_DoIC(opm_t *chip)
+static OPM_INLINE void OPM_DoIC(opm_t *chip, uint32_t cycles)
 {
-    uint32_t channel = chip->cycles % 8;
-    uint32_t slot = chip->cycles;
+    uint32_t channel = cycles % 8;
+    uint32_t slot = cycles;
     if (chip->ic)
     {
         chip->ch_rl[channel] = 0;
@@ -1833,6 +2052,10 @@ static void OPM_DoIC(opm_t *chip)
         chip->mode_kon_operator[3] = 0;
         chip->mode_kon[(slot + 8) % 32] = 0;
 
+        OPM_LFOMultSync(chip, cycles);
+        chip->pg_fnum_dirty = 0xffffffff; // Every register in the key code is being cleared
+        chip->pg_inc_dirty = 0xffffffff;
+        chip->eg_rate_dirty = 0xffffffff;
         chip->lfo_pmd = 0;
         chip->lfo_amd = 0;
         chip->lfo_wave = 0;
@@ -1848,62 +2071,294 @@ static void OPM_DoIC(opm_t *chip)
     chip->ic2 = chip->ic;
 }
 
-void OPM_Clock(opm_t *chip, int32_t *output, uint8_t *sh1, uint8_t *sh2, uint8_t *so)
+/* Timers, LFO, noise, key on, register and IO handling, output and DAC:
+ * every stage that keeps running while the chip is idle. */
+static OPM_INLINE void OPM_ClockControlStages(opm_t *chip, uint32_t cycles)
 {
-    OPM_Mixer2(chip);
-    OPM_Mixer(chip);
-
-    OPM_OperatorPhase16(chip);
-    OPM_OperatorPhase15(chip);
-    OPM_OperatorPhase14(chip);
-    OPM_OperatorPhase13(chip);
-    OPM_OperatorPhase12(chip);
-    OPM_OperatorPhase11(chip);
-    OPM_OperatorPhase10(chip);
-    OPM_OperatorPhase9(chip);
-    OPM_OperatorPhase8(chip);
-    OPM_OperatorPhase7(chip);
-    OPM_OperatorPhase6(chip);
-    OPM_OperatorPhase5(chip);
-    OPM_OperatorPhase4(chip);
-    OPM_OperatorPhase3(chip);
-    OPM_OperatorPhase2(chip);
-    OPM_OperatorPhase1(chip);
-    OPM_OperatorCounter(chip);
-
-    OPM_EnvelopeTimer(chip);
-    OPM_EnvelopePhase6(chip);
-    OPM_EnvelopePhase5(chip);
-    OPM_EnvelopePhase4(chip);
-    OPM_EnvelopePhase3(chip);
-    OPM_EnvelopePhase2(chip);
-    OPM_EnvelopePhase1(chip);
-
-    OPM_PhaseDebug(chip);
-    OPM_PhaseGenerate(chip);
-    OPM_PhaseCalcIncrement(chip);
-    OPM_PhaseCalcFNumBlock(chip);
-
     OPM_DoTimerIRQ(chip);
     OPM_DoTimerA(chip);
-    OPM_DoTimerB(chip);
-    OPM_DoLFOMult(chip);
-    OPM_DoLFO1(chip);
+    OPM_DoTimerB(chip, cycles);
+    OPM_DoLFOMult(chip, cycles);
+    OPM_DoLFO1(chip, cycles);
     OPM_Noise(chip);
-    OPM_KeyOn2(chip);
-    OPM_DoRegWrite(chip);
-    OPM_EnvelopeClock(chip);
-    OPM_NoiseTimer(chip);
-    OPM_KeyOn1(chip);
+    OPM_KeyOn2(chip, cycles);
+    OPM_DoRegWrite(chip, cycles);
+    OPM_EnvelopeClock(chip, cycles);
+    OPM_NoiseTimer(chip, cycles);
+    OPM_KeyOn1(chip, cycles);
     OPM_DoIO(chip);
-    OPM_DoTimerA2(chip);
+    OPM_DoTimerA2(chip, cycles);
     OPM_DoTimerB2(chip);
-    OPM_DoLFO2(chip);
-    OPM_CSM(chip);
-    OPM_NoiseChannel(chip);
-    OPM_Output(chip);
+    OPM_DoLFO2(chip, cycles);
+    OPM_CSM(chip, cycles);
+    OPM_NoiseChannel(chip, cycles);
+    OPM_Output(chip, cycles);
     OPM_DAC(chip);
-    OPM_DoIC(chip);
+    OPM_DoIC(chip, cycles);
+}
+
+/* True when nothing can be heard and nothing is about to change that: every
+ * slot released to maximum attenuation with key off, the operator and mixer
+ * pipelines drained to zero, and no write, IC, CSM, noise or test mode
+ * pending. Running the operator and envelope stages then leaves the output
+ * and every state they share with the other stages unchanged. */
+static int OPM_IsSilent(opm_t *chip)
+{
+    uint32_t i;
+    if (chip->ic || chip->mode_csm || chip->noise_en || chip->kon_csm || chip->kon_csm_lock)
+    {
+        return 0;
+    }
+    if (chip->write_a || chip->write_d || chip->write_a_en || chip->write_d_en)
+    {
+        return 0;
+    }
+    if (chip->mix[0] || chip->mix[1] || chip->op_mix || chip->mix_word_wait)
+    {
+        return 0;
+    }
+    if (chip->mix_frame[0] != 0x8000 || chip->mix_frame[1] != 0x8000
+        || chip->mix_frame_prev[0] != 0x8000 || chip->mix_frame_prev[1] != 0x8000)
+    {
+        return 0;
+    }
+    if (chip->eg_out[0] != 1023 || chip->eg_out[1] != 1023 || chip->eg_serial || chip->eg_serial_bit)
+    {
+        return 0;
+    }
+    for (i = 0; i < 8; i++)
+    {
+        if (chip->mode_test[i] || chip->op_m1[i][0] || chip->op_m1[i][1] || chip->op_c1[i])
+        {
+            return 0;
+        }
+    }
+    for (i = 0; i < 8; i++)
+    {
+        if (chip->op_lin[i])
+        {
+            return 0;
+        }
+    }
+    if (chip->op_out)
+    {
+        return 0;
+    }
+    for (i = 0; i < 3; i++)
+    {
+        if (chip->op_mod[i])
+        {
+            return 0;
+        }
+    }
+    for (i = 0; i < 32; i++)
+    {
+        if (chip->eg_state[i] != eg_num_release || chip->eg_level[i] != 0x3ff
+            || chip->kon[i] || chip->kon2[i] || chip->mode_kon[i] || chip->pg_reset[i])
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* Called at every round start. The chip goes idle once it has been silent at
+ * three round starts in a row: by then a register write that landed just
+ * before has gone through the frequency and increment pipeline, and the
+ * skipped stages have run a full round on silent input. */
+static void OPM_CheckIdle(opm_t *chip)
+{
+    if (chip->idle == OPM_IDLE)
+    {
+        return;
+    }
+    if (!OPM_IsSilent(chip))
+    {
+        chip->idle = 0;
+        return;
+    }
+    chip->idle++;
+    if (chip->idle == OPM_IDLE)
+    {
+        // Idle rounds use the word mixer; this is the word built at cycle 26
+        chip->mix_out_word = OPM_MixOutWord(chip->mix_frame[0], chip->mix_frame[1]);
+    }
+}
+
+/* Leave idle before a write or IC change reaches the chip */
+static void OPM_Wake(opm_t *chip)
+{
+    if (chip->idle == OPM_IDLE && !chip->mix_word)
+    {
+        OPM_MixerToSerial(chip, chip->cycles);
+    }
+    chip->idle = 0;
+}
+
+/* An idle cycle: the operator and envelope stages are skipped, the phase
+ * counters still advance and the increments only need recomputing while PM
+ * LFO can move them. The output is the mixer's word for silence. */
+static OPM_INLINE void OPM_ClockIdleStages(opm_t *chip, uint32_t cycles)
+{
+    OPM_MixerWord(chip, cycles);
+    OPM_OperatorCounter(chip, cycles);
+    OPM_EnvelopeTimer(chip, cycles);
+
+    OPM_PhaseDebug(chip, cycles);
+    OPM_PhaseGenerate(chip, cycles);
+    if (chip->lfo_pmd)
+    {
+        OPM_PhaseCalcIncrement(chip, cycles);
+        OPM_PhaseCalcFNumBlock(chip, cycles);
+    }
+
+    OPM_ClockControlStages(chip, cycles);
+}
+
+static OPM_INLINE void OPM_ClockStages(opm_t *chip, uint32_t cycles)
+{
+    if (cycles % 16 == 10 && (chip->mix_word != chip->mix_word_req || chip->mix_word_wait))
+    {
+        OPM_MixerSetMode(chip, cycles);
+    }
+    if (chip->mix_word)
+    {
+        OPM_MixerWord(chip, cycles);
+    }
+    else
+    {
+        OPM_Mixer2(chip, cycles);
+        OPM_Mixer(chip, cycles);
+    }
+
+    OPM_OperatorPhase16(chip, cycles);
+    OPM_OperatorPhase15(chip, cycles);
+    OPM_OperatorPhase14(chip, cycles);
+    OPM_OperatorPhase13(chip, cycles);
+    OPM_OperatorPhase6(chip, cycles);
+    OPM_OperatorPhase3(chip, cycles);
+    OPM_OperatorPhase2(chip, cycles);
+    OPM_OperatorPhase1(chip, cycles);
+    OPM_OperatorCounter(chip, cycles);
+
+    OPM_EnvelopeTimer(chip, cycles);
+    OPM_EnvelopePhase6(chip, cycles);
+    OPM_EnvelopePhase5(chip, cycles);
+    OPM_EnvelopePhase4(chip, cycles);
+    OPM_EnvelopePhase3(chip, cycles);
+    OPM_EnvelopePhase2(chip, cycles);
+    OPM_EnvelopePhase1(chip, cycles);
+
+    OPM_PhaseDebug(chip, cycles);
+    OPM_PhaseGenerate(chip, cycles);
+    OPM_PhaseCalcIncrement(chip, cycles);
+    OPM_PhaseCalcFNumBlock(chip, cycles);
+
+    OPM_ClockControlStages(chip, cycles);
+}
+
+/* Issue the next step of the queued write at the head of the queue, if the
+ * chip accepts it this cycle. Data goes two cycles after its address, once
+ * the address is latched, and the next address waits two cycles for busy to
+ * rise and then for it to clear, by which time the data has been stored. */
+static void OPM_IssueWrite(opm_t *chip)
+{
+    if (chip->wq_wait)
+    {
+        chip->wq_wait--;
+        return;
+    }
+    if (chip->ic)
+    {
+        return;
+    }
+    if (!chip->wq_data_next)
+    {
+        if (chip->write_busy)
+        {
+            return;
+        }
+        OPM_Write(chip, 0, chip->wq_address[chip->wq_head]);
+        chip->wq_data_next = 1;
+    }
+    else
+    {
+        OPM_Write(chip, 1, chip->wq_data[chip->wq_head]);
+        chip->wq_data_next = 0;
+        chip->wq_head = (chip->wq_head + 1) % OPM_WRITE_QUEUE_SIZE;
+        chip->wq_count--;
+    }
+    chip->wq_wait = 1;
+}
+
+static void OPM_ClockCycle(opm_t *chip)
+{
+    if (chip->wq_count)
+    {
+        OPM_IssueWrite(chip);
+    }
+    if (chip->cycles == 0)
+    {
+        OPM_CheckIdle(chip);
+    }
+    if (chip->idle == OPM_IDLE)
+    {
+        OPM_ClockIdleStages(chip, chip->cycles);
+    }
+    else
+    {
+        OPM_ClockStages(chip, chip->cycles);
+    }
+    chip->cycles = (chip->cycles + 1) % 32;
+}
+
+/* One full 32-cycle round starting at cycle 0 */
+static void OPM_ClockBusyRound(opm_t *chip)
+{
+    uint32_t cycles;
+    for (cycles = 0; cycles < 32; cycles++)
+    {
+        OPM_ClockStages(chip, cycles);
+    }
+}
+
+/* A round of an idle chip only runs the stages that keep going */
+static void OPM_ClockRound(opm_t *chip)
+{
+    uint32_t cycles;
+    OPM_CheckIdle(chip);
+    if (chip->idle != OPM_IDLE)
+    {
+        OPM_ClockBusyRound(chip);
+        return;
+    }
+    for (cycles = 0; cycles < 32; cycles++)
+    {
+        OPM_ClockIdleStages(chip, cycles);
+    }
+}
+
+/* Whole rounds at cycle 0 unless queued writes need issuing cycle by cycle */
+void OPM_ClockCycles(opm_t *chip, uint32_t n)
+{
+    while (n)
+    {
+        if (chip->cycles == 0 && n >= 32 && !chip->wq_count)
+        {
+            OPM_ClockRound(chip);
+            n -= 32;
+        }
+        else
+        {
+            OPM_ClockCycle(chip);
+            n--;
+        }
+    }
+}
+
+void OPM_Clock(opm_t *chip, int32_t *output, uint8_t *sh1, uint8_t *sh2, uint8_t *so)
+{
+    OPM_ClockCycle(chip);
     if (sh1)
     {
         *sh1 = chip->smp_sh1;
@@ -1921,11 +2376,35 @@ void OPM_Clock(opm_t *chip, int32_t *output, uint8_t *sh1, uint8_t *sh2, uint8_t
         output[0] = chip->dac_output[0];
         output[1] = chip->dac_output[1];
     }
-    chip->cycles = (chip->cycles + 1) % 32;
+}
+
+void OPM_RenderSamples(opm_t *chip, int32_t *buffer, uint32_t num_samples)
+{
+    uint32_t i;
+    for (i = 0; i < num_samples; i++)
+    {
+        OPM_ClockCycles(chip, OPM_CYCLES_PER_SAMPLE);
+        buffer[i * 2] = chip->dac_output[0];
+        buffer[i * 2 + 1] = chip->dac_output[1];
+    }
+}
+
+void OPM_RenderSamples16(opm_t *chip, int16_t *buffer, uint32_t num_samples)
+{
+    int32_t block[256 * 2];
+    while (num_samples > 0)
+    {
+        uint32_t count = num_samples < 256 ? num_samples : 256;
+        OPM_RenderSamples(chip, block, count);
+        OPM_ConvertS16(buffer, block, count * 2);
+        buffer += count * 2;
+        num_samples -= count;
+    }
 }
 
 void OPM_Write(opm_t *chip, uint32_t port, uint8_t data)
 {
+    OPM_Wake(chip);
     chip->write_data = data;
     if (chip->ic)
     {
@@ -1941,12 +2420,78 @@ void OPM_Write(opm_t *chip, uint32_t port, uint8_t data)
     }
 }
 
+int OPM_QueueWrite(opm_t *chip, uint8_t address, uint8_t data)
+{
+    uint32_t tail;
+    if (chip->wq_count >= OPM_WRITE_QUEUE_SIZE)
+    {
+        return 0;
+    }
+    tail = (chip->wq_head + chip->wq_count) % OPM_WRITE_QUEUE_SIZE;
+    chip->wq_address[tail] = address;
+    chip->wq_data[tail] = data;
+    chip->wq_count++;
+    return 1;
+}
+
+uint32_t OPM_QueuedWrites(const opm_t *chip)
+{
+    return chip->wq_count;
+}
+
+void OPM_PokeRegister(opm_t *chip, uint8_t address, uint8_t data)
+{
+    OPM_Wake(chip);
+    if (chip->ic)
+    {
+        return;
+    }
+
+    // Leave the write latches as an address + data write would
+    chip->write_data = data;
+    chip->mode_address = address;
+    chip->reg_address_ready = 0;
+    chip->reg_data_ready = 0;
+    if ((address & 0xe0) != 0)
+    {
+        chip->reg_address = address;
+        chip->reg_address_ready = 1;
+        chip->reg_data = data;
+        chip->reg_data_ready = 1;
+    }
+
+    // Apply it now instead of at the channel's, slot's or key on cycle
+    if ((address & 0xe0) == 0x20)
+    {
+        OPM_WriteChannelReg(chip, address & 0x07, address, data);
+    }
+    else if ((address & 0xe0) != 0)
+    {
+        OPM_WriteSlotReg(chip, address & 0x1f, address, data);
+    }
+    else
+    {
+        if (address == 0x19)
+        {
+            OPM_LFOMultSync(chip, (chip->cycles + 31) % 32);
+        }
+        OPM_WriteModeReg(chip, address, data);
+        if (address == 0x08)
+        {
+            chip->mode_kon[chip->mode_kon_channel] = chip->mode_kon_operator[0];
+            chip->mode_kon[chip->mode_kon_channel + 8] = chip->mode_kon_operator[2];
+            chip->mode_kon[chip->mode_kon_channel + 16] = chip->mode_kon_operator[1];
+            chip->mode_kon[chip->mode_kon_channel + 24] = chip->mode_kon_operator[3];
+        }
+    }
+}
+
 uint8_t OPM_Read(opm_t *chip, uint32_t port)
 {
     uint16_t testdata;
     if (chip->mode_test[6])
     {
-        testdata = chip->op_out[5] | ((chip->eg_serial_bit ^ 1) << 14) | ((chip->pg_serial & 1) << 15);
+        testdata = chip->op_out | ((chip->eg_serial_bit ^ 1) << 14) | ((chip->pg_serial & 1) << 15);
         if (chip->mode_test[7])
         {
             return testdata & 255;
@@ -1982,18 +2527,37 @@ void OPM_SetIC(opm_t *chip, uint8_t ic)
 {
     if (chip->ic != ic)
     {
+        OPM_Wake(chip);
         chip->ic = ic;
         if (!ic)
         {
+            if (chip->cycles != 0)
+            {
+                // The serial stream is misaligned for a while after this jump
+                OPM_EnvelopeTimerToSerial(chip, chip->cycles);
+                OPM_LFOMultToSerial(chip, chip->cycles);
+                if (chip->mix_word)
+                {
+                    OPM_MixerToSerial(chip, chip->cycles);
+                    chip->mix_word = 0;
+                }
+                chip->mix_word_wait = 2;
+            }
             chip->cycles = 0;
         }
     }
 }
 
-void OPM_Reset(opm_t *chip)
+void OPM_SetWordMixer(opm_t *chip, uint8_t enable)
+{
+    chip->mix_word_req = enable != 0;
+}
+
+static void OPM_ResetSequence(opm_t *chip)
 {
     uint32_t i;
     memset(chip, 0, sizeof(opm_t));
+    chip->pg_fnum_dirty = chip->pg_inc_dirty = 0xffffffff; // Nothing is cached yet
     OPM_SetIC(chip, 1);
     for (i = 0; i < 32 * 64; i++)
     {
@@ -2001,3 +2565,175 @@ void OPM_Reset(opm_t *chip)
     }
     OPM_SetIC(chip, 0);
 }
+
+#if OPM_RESET_IMAGE
+/* The chip right after the reset sequence, built by the first OPM_Reset and
+ * copied by later ones. A reset that finds it still being built runs the
+ * sequence itself, so concurrent resets neither wait nor see a partial image. */
+enum
+{
+    OPM_RESET_IMAGE_EMPTY,
+    OPM_RESET_IMAGE_BUILDING,
+    OPM_RESET_IMAGE_READY
+};
+static opm_t OPM_ResetImage;
+static atomic_int OPM_ResetImageState;
+#endif
+
+void OPM_Reset(opm_t *chip)
+{
+#if OPM_RESET_IMAGE
+    int expected = OPM_RESET_IMAGE_EMPTY;
+    if (atomic_load_explicit(&OPM_ResetImageState, memory_order_acquire) == OPM_RESET_IMAGE_READY)
+    {
+        memcpy(chip, &OPM_ResetImage, sizeof(opm_t));
+        return;
+    }
+    if (atomic_compare_exchange_strong(&OPM_ResetImageState, &expected, OPM_RESET_IMAGE_BUILDING))
+    {
+        OPM_ResetSequence(&OPM_ResetImage);
+        atomic_store_explicit(&OPM_ResetImageState, OPM_RESET_IMAGE_READY, memory_order_release);
+        memcpy(chip, &OPM_ResetImage, sizeof(opm_t));
+        return;
+    }
+#endif
+    OPM_ResetSequence(chip);
+}
+
+static void OPM_PutU32(uint8_t *p, uint32_t v)
+{
+    p[0] = v & 255;
+    p[1] = (v >> 8) & 255;
+    p[2] = (v >> 16) & 255;
+    p[3] = v >> 24;
+}
+
+static uint32_t OPM_GetU32(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/* FNV-1a over the unpacked state */
+static uint32_t OPM_StateChecksum(const uint8_t *p, size_t n)
+{
+    uint32_t h = 2166136261u;
+    size_t i;
+    for (i = 0; i < n; i++)
+    {
+        h = (h ^ p[i]) * 16777619u;
+    }
+    return h;
+}
+
+/* Zero-run packing of the opm_t bytes. A control byte c < 128 is followed by
+ * c + 1 literal bytes, c >= 128 stands for c - 126 zero bytes (2 to 129).
+ * Single zeros stay in literal runs, so the packed size never exceeds
+ * sizeof(opm_t) + sizeof(opm_t) / 128 + 1. */
+size_t OPM_SaveState(const opm_t *chip, uint8_t *buffer, size_t size)
+{
+    const uint8_t *src = (const uint8_t *)chip;
+    size_t n = sizeof(opm_t);
+    size_t pos = OPM_STATE_HEADER_SIZE;
+    size_t i = 0, lit = 0, run;
+    if (buffer)
+    {
+        if (size < OPM_STATE_HEADER_SIZE)
+        {
+            return 0;
+        }
+        memcpy(buffer, "OPMS", 4);
+        OPM_PutU32(buffer + 4, OPM_STATE_VERSION);
+        OPM_PutU32(buffer + 8, sizeof(opm_t));
+        OPM_PutU32(buffer + 12, OPM_StateChecksum(src, n));
+    }
+    while (i < n)
+    {
+        run = 0;
+        while (i + run < n && src[i + run] == 0 && run < 129)
+        {
+            run++;
+        }
+        if (run < 2 && i < n)
+        {
+            // Literal run: extend until two zeros in a row or 128 bytes
+            lit = 1;
+            while (i + lit < n && lit < 128 && !(src[i + lit] == 0 && i + lit + 1 < n && src[i + lit + 1] == 0))
+            {
+                lit++;
+            }
+            if (buffer)
+            {
+                if (pos + 1 + lit > size)
+                {
+                    return 0;
+                }
+                buffer[pos] = (uint8_t)(lit - 1);
+                memcpy(buffer + pos + 1, src + i, lit);
+            }
+            pos += 1 + lit;
+            i += lit;
+        }
+        else
+        {
+            if (buffer)
+            {
+                if (pos + 1 > size)
+                {
+                    return 0;
+                }
+                buffer[pos] = (uint8_t)(run + 126);
+            }
+            pos++;
+            i += run;
+        }
+    }
+    return pos;
+}
+
+int OPM_LoadState(opm_t *chip, const uint8_t *data, size_t size)
+{
+    opm_t state;
+    uint8_t *dst = (uint8_t *)&state;
+    size_t n = sizeof(opm_t);
+    size_t pos = OPM_STATE_HEADER_SIZE;
+    size_t i = 0, len;
+    if (size < OPM_STATE_HEADER_SIZE || memcmp(data, "OPMS", 4) != 0
+        || OPM_GetU32(data + 4) != OPM_STATE_VERSION || OPM_GetU32(data + 8) != sizeof(opm_t))
+    {
+        return 0;
+    }
+    while (i < n)
+    {
+        if (pos >= size)
+        {
+            return 0;
+        }
+        if (data[pos] < 128)
+        {
+            len = data[pos] + 1;
+            if (i + len > n || pos + 1 + len > size)
+            {
+                return 0;
+            }
+            memcpy(dst + i, data + pos + 1, len);
+            pos += 1 + len;
+        }
+        else
+        {
+            len = data[pos] - 126;
+            if (i + len > n)
+            {
+                return 0;
+            }
+            memset(dst + i, 0, len);
+            pos++;
+        }
+        i += len;
+    }
+    if (pos != size || OPM_StateChecksum(dst, n) != OPM_GetU32(data + 12))
+    {
+        return 0;
+    }
+    memcpy(chip, &state, sizeof(opm_t));
+    return 1;
+}
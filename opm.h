@@ -26,12 +26,30 @@
 #ifndef _OPM_H_
 #define _OPM_H_
 
+#include <stddef.h>
 #include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/* Chip clock cycles per output sample (one stereo sample per 64 cycles) */
+#define OPM_CYCLES_PER_SAMPLE 64
+
+/* Register writes OPM_QueueWrite can hold */
+#define OPM_WRITE_QUEUE_SIZE 64
+
+/* Saved state format (OPM_SaveState): "OPMS", version, sizeof(opm_t) and a
+ * checksum of the opm_t bytes, then those bytes with zero runs packed.
+ * OPM_STATE_MAX_SIZE is enough for any state. The state is the raw opm_t, so
+ * OPM_STATE_VERSION must be bumped whenever the opm_t layout changes. */
+#define OPM_STATE_VERSION 2
+#define OPM_STATE_HEADER_SIZE 16
+#define OPM_STATE_MAX_SIZE (OPM_STATE_HEADER_SIZE + sizeof(opm_t) + sizeof(opm_t) / 128 + 1)
+
+/* opm_t.idle of a silent chip that skips the operator and envelope stages */
+#define OPM_IDLE 3
+
 typedef struct {
     uint32_t cycles;
     uint8_t ic;
@@ -76,6 +94,9 @@ typedef struct {
     uint8_t lfo_trig_sign;
     uint8_t lfo_saw_sign;
     uint8_t lfo_bit_counter;
+    uint16_t lfo_mult_p;     // Word-level multiplier: partial product of the current word
+    uint8_t lfo_mult_pos;    // Its bits below this are done
+    uint8_t lfo_mult_serial; // Multiplying bit-serially until the next word (after an IC jump)
 
     // Env Gen
     uint8_t eg_state[32];
@@ -105,6 +126,12 @@ typedef struct {
     uint32_t eg_timer;
     uint32_t eg_timer2;
     uint8_t eg_timerbstop;
+    uint8_t eg_timer_word;   // Word-parallel timer: this round was done at cycle 1 (2: so was the last)
+    uint8_t eg_timer_clock;  // EG clock at that cycle 1
+    uint16_t eg_timer_start; // eg_timer before that cycle 1
+    uint8_t eg_slot_rate[32][5]; // Rate with key scaling per state (4: under IC), bit 7 set for a zero base rate
+    uint8_t eg_slot_am[32];      // AM lock multiplier: 0, 1, 2 or 4
+    uint32_t eg_rate_dirty;      // Slots whose eg_slot_rate/eg_slot_am inputs changed
     uint32_t eg_serial;
     uint8_t eg_serial_bit;
     uint8_t eg_test;
@@ -118,17 +145,18 @@ typedef struct {
     uint8_t pg_reset[32];
     uint8_t pg_reset_latch[32];
     uint32_t pg_serial;
+    uint32_t pg_fnum_dirty; // Slots whose pg_fnum/pg_kcode inputs changed since they were last computed
+    uint32_t pg_inc_dirty;  // Slots whose pg_inc needs computing again
 
     // Operator
     uint16_t op_phase_in;
     uint16_t op_mod_in;
     uint16_t op_phase;
-    uint16_t op_logsin[3];
-    uint16_t op_atten;
-    uint16_t op_exp[2];
-    uint8_t op_pow[2];
+    uint16_t op_logsin[4]; // Ring indexed by op_ring, read 3 cycles after it is written
+    int16_t op_lin[8];     // Ring of signed linear outputs, read 8 cycles after they are written
+    uint8_t op_ring;
     uint32_t op_sign;
-    int16_t op_out[6];
+    int16_t op_out;
     uint32_t op_connect;
     uint8_t op_counter;
     uint8_t op_fbupdate;
@@ -156,6 +184,13 @@ typedef struct {
     uint8_t mix_clamp_low[2];
     uint8_t mix_clamp_high[2];
     uint8_t mix_out_bit;
+    // Word-level mixer (OPM_SetWordMixer)
+    uint16_t mix_frame[2];
+    uint16_t mix_frame_prev[2];
+    uint16_t mix_out_word;
+    uint8_t mix_word;
+    uint8_t mix_word_req;
+    uint8_t mix_word_wait;
 
     // Output
     uint8_t smp_so;
@@ -251,16 +286,62 @@ typedef struct {
     uint8_t dac_osh1, dac_osh2;
     uint16_t dac_bits;
     int32_t dac_output[2];
+
+    // Idle fast-forward: silent round starts in a row, up to OPM_IDLE
+    uint8_t idle;
+
+    // Register write queue (OPM_QueueWrite)
+    uint8_t wq_address[OPM_WRITE_QUEUE_SIZE];
+    uint8_t wq_data[OPM_WRITE_QUEUE_SIZE];
+    uint8_t wq_head;
+    uint8_t wq_count;
+    uint8_t wq_data_next;
+    uint8_t wq_wait;
 } opm_t;
 
 void OPM_Clock(opm_t *chip, int32_t *output, uint8_t *sh1, uint8_t *sh2, uint8_t *so);
+/* Advance n cycles without output, like n OPM_Clock calls; dac_output holds the
+ * latest sample afterwards. Lets a sample be split at the cycle of a write. */
+void OPM_ClockCycles(opm_t *chip, uint32_t n);
+/* Render num_samples stereo samples (interleaved L/R), OPM_CYCLES_PER_SAMPLE cycles each.
+ * Same output as calling OPM_Clock OPM_CYCLES_PER_SAMPLE times per sample.
+ * The 16-bit variant stores each sample divided by 2. */
+void OPM_RenderSamples(opm_t *chip, int32_t *buffer, uint32_t num_samples);
+void OPM_RenderSamples16(opm_t *chip, int16_t *buffer, uint32_t num_samples);
 void OPM_Write(opm_t *chip, uint32_t port, uint8_t data);
+/* Queue a register write. The chip issues it at the earliest cycle it accepts
+ * it while being clocked: the address once the busy flag (OPM_Read bit 7) of
+ * the previous data write has cleared, the data two cycles after the address.
+ * A queued write takes about 36 cycles. Returns 0 if the queue is full. */
+int OPM_QueueWrite(opm_t *chip, uint8_t address, uint8_t data);
+/* Queued writes whose data has not been written yet */
+uint32_t OPM_QueuedWrites(const opm_t *chip);
+/* Set a register at once, without bus timing or the busy flag: the channel,
+ * operator, mode or key on state changes as a completed OPM_Write address +
+ * data pair would leave it. For setup before rendering (e.g. right after
+ * OPM_Reset); do not mix with a write the chip has not finished. */
+void OPM_PokeRegister(opm_t *chip, uint8_t address, uint8_t data);
 uint8_t OPM_Read(opm_t *chip, uint32_t port);
 uint8_t OPM_ReadIRQ(opm_t *chip);
 uint8_t OPM_ReadCT1(opm_t *chip);
 uint8_t OPM_ReadCT2(opm_t *chip);
 void OPM_SetIC(opm_t *chip, uint8_t ic);
+/* Put the chip in its power-on state: clear it and clock 32 * 64 cycles with IC
+ * held. The resulting state is built once and then copied into each chip. */
 void OPM_Reset(opm_t *chip);
+/* Select the word-level mixer (1) or the bit-serial one (0, the default after
+ * OPM_Reset). Both give the same output; the switch takes effect at the next
+ * output word boundary, at most 16 cycles later. */
+void OPM_SetWordMixer(opm_t *chip, uint8_t enable);
+/* Serialize the complete chip state into buffer (capacity size bytes, NULL to
+ * only measure). Returns the state size, or 0 if it does not fit. The state
+ * holds opm_t as laid out in memory, so it loads back into builds with the
+ * same opm_t only. */
+size_t OPM_SaveState(const opm_t *chip, uint8_t *buffer, size_t size);
+/* Restore a state saved by OPM_SaveState. Returns 1 on success, 0 if the data
+ * is truncated, malformed, or from another version or opm_t layout; the chip
+ * is left untouched on failure. */
+int OPM_LoadState(opm_t *chip, const uint8_t *data, size_t size);
 
 #ifdef __cplusplus
 } // extern "C"
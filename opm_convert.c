@@ -0,0 +1,143 @@
+/* Nuked OPM
+ * Copyright (C) 2022 Nuke.YKT
+ *
+ * This file is part of Nuked OPM.
+ *
+ * Nuked OPM is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * Nuked OPM is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Nuked OPM. If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  Sample conversion kernels. See opm_convert.h.
+ */
+#include <stdint.h>
+#include "opm_convert.h"
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#define OPM_S24_MAX 0x7fffff
+
+/* output / 2 rounded toward zero */
+static inline int32_t OPM_Half(int32_t x)
+{
+    return (x + (int32_t)((uint32_t)x >> 31)) >> 1;
+}
+
+static inline int16_t OPM_SatS16(int32_t x)
+{
+    return (int16_t)(x > INT16_MAX ? INT16_MAX : x < INT16_MIN ? INT16_MIN : x);
+}
+
+#if defined(__SSE2__)
+static inline __m128i OPM_Half128(__m128i x)
+{
+    return _mm_srai_epi32(_mm_add_epi32(x, _mm_srli_epi32(x, 31)), 1);
+}
+#endif
+
+#if defined(__AVX2__)
+static inline __m256i OPM_Half256(__m256i x)
+{
+    return _mm256_srai_epi32(_mm256_add_epi32(x, _mm256_srli_epi32(x, 31)), 1);
+}
+#endif
+
+void OPM_ConvertS16(int16_t *dst, const int32_t *src, uint32_t count)
+{
+    uint32_t i = 0;
+#if defined(__AVX2__)
+    for (; i + 16 <= count; i += 16)
+    {
+        __m256i a = OPM_Half256(_mm256_loadu_si256((const __m256i *)(src + i)));
+        __m256i b = OPM_Half256(_mm256_loadu_si256((const __m256i *)(src + i + 8)));
+        /* packs works per 128-bit half; restore the order afterwards */
+        __m256i p = _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), 0xd8);
+        _mm256_storeu_si256((__m256i *)(dst + i), p);
+    }
+#endif
+#if defined(__SSE2__)
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i a = OPM_Half128(_mm_loadu_si128((const __m128i *)(src + i)));
+        __m128i b = OPM_Half128(_mm_loadu_si128((const __m128i *)(src + i + 4)));
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_packs_epi32(a, b));
+    }
+#endif
+    for (; i < count; i++)
+    {
+        dst[i] = OPM_SatS16(OPM_Half(src[i]));
+    }
+}
+
+void OPM_ConvertS24(uint8_t *dst, const int32_t *src, uint32_t count)
+{
+    /* Packed 3-byte samples do not map onto vector stores; the saturation is
+     * two compares and the byte stores vectorize well enough as is */
+    uint32_t i;
+    for (i = 0; i < count; i++)
+    {
+        int32_t x = src[i];
+        x = x > OPM_S24_MAX / 128 ? OPM_S24_MAX / 128 : x < -(OPM_S24_MAX + 1) / 128 ? -(OPM_S24_MAX + 1) / 128 : x;
+        uint32_t v = (uint32_t)x * 128;
+        dst[i * 3] = (uint8_t)v;
+        dst[i * 3 + 1] = (uint8_t)(v >> 8);
+        dst[i * 3 + 2] = (uint8_t)(v >> 16);
+    }
+}
+
+void OPM_ConvertF32(float *dst, const int32_t *src, uint32_t count)
+{
+    const float scale = 1.0f / 65536.0f;
+    uint32_t i = 0;
+#if defined(__AVX2__)
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 v = _mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i *)(src + i)));
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(v, _mm256_set1_ps(scale)));
+    }
+#endif
+#if defined(__SSE2__)
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 v = _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i *)(src + i)));
+        _mm_storeu_ps(dst + i, _mm_mul_ps(v, _mm_set1_ps(scale)));
+    }
+#endif
+    for (; i < count; i++)
+    {
+        /* Chip output fits in 24 bits, so the conversion is exact and full
+         * scale is never exceeded */
+        dst[i] = (float)src[i] * scale;
+    }
+}
+
+void OPM_InterleaveS16(int16_t *dst, const int32_t *left, const int32_t *right, uint32_t num_frames)
+{
+    uint32_t i = 0;
+#if defined(__SSE2__)
+    for (; i + 4 <= num_frames; i += 4)
+    {
+        __m128i l = OPM_Half128(_mm_loadu_si128((const __m128i *)(left + i)));
+        __m128i r = OPM_Half128(_mm_loadu_si128((const __m128i *)(right + i)));
+        /* l0 r0 l1 r1 ..., then saturate to 16 bits */
+        __m128i lo = _mm_unpacklo_epi32(l, r);
+        __m128i hi = _mm_unpackhi_epi32(l, r);
+        _mm_storeu_si128((__m128i *)(dst + i * 2), _mm_packs_epi32(lo, hi));
+    }
+#endif
+    for (; i < num_frames; i++)
+    {
+        dst[i * 2] = OPM_SatS16(OPM_Half(left[i]));
+        dst[i * 2 + 1] = OPM_SatS16(OPM_Half(right[i]));
+    }
+}
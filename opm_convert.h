@@ -0,0 +1,53 @@
+/* Nuked OPM
+ * Copyright (C) 2022 Nuke.YKT
+ *
+ * This file is part of Nuked OPM.
+ *
+ * Nuked OPM is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * Nuked OPM is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Nuked OPM. If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  Sample conversion: chip output (OPM_Clock / dac_output scale) to the
+ *  16-bit, 24-bit and float formats used by the players and WAV writers,
+ *  over whole blocks of interleaved samples. 16-bit is output / 2 (rounded
+ *  toward zero, as the per-sample casts did) and 24-bit and float keep the
+ *  same level. The integer formats saturate; float needs no clipping, as
+ *  chip output stays within +-0.5 on that scale. AVX2 or SSE2 is used when the target
+ *  flags allow it, with a scalar fallback; every path gives the same result.
+ */
+#ifndef _OPM_CONVERT_H_
+#define _OPM_CONVERT_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* count values (frames * 2 for stereo) to int16: output / 2, saturated */
+void OPM_ConvertS16(int16_t *dst, const int32_t *src, uint32_t count);
+
+/* count values to packed little-endian 24-bit (3 bytes each): output * 128, saturated */
+void OPM_ConvertS24(uint8_t *dst, const int32_t *src, uint32_t count);
+
+/* count values to float: output / 65536, so 1.0 is 16-bit full scale */
+void OPM_ConvertF32(float *dst, const int32_t *src, uint32_t count);
+
+/* Interleave num_frames frames of left/right planes (e.g. OPM_MultiRenderSamples
+ * lanes) into stereo int16: output / 2, saturated */
+void OPM_InterleaveS16(int16_t *dst, const int32_t *left, const int32_t *right, uint32_t num_frames);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
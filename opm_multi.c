@@ -0,0 +1,1443 @@
+/* Nuked OPM
+ * Copyright (C) 2022 Nuke.YKT
+ *
+ * This file is part of Nuked OPM.
+ *
+ * Nuked OPM is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * Nuked OPM is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Nuked OPM. If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  Multi-chip Nuked OPM: opm.c with every chip variable widened to one
+ *  SIMD lane per chip. Each stage function mirrors its opm.c counterpart;
+ *  branches on chip state become per-lane selects, and ROM lookups are
+ *  gathered lane by lane. Boolean fields hold 0 or 1 in every lane, and
+ *  narrow fields are masked so every lane keeps exactly the value the
+ *  scalar opm_t would hold.
+ */
+#include <string.h>
+#include <stdint.h>
+#include "opm_multi.h"
+#include "opm_tables.h"
+
+#if !defined(__GNUC__)
+#error "opm_multi.c requires GCC/Clang vector extensions"
+#endif
+
+#define OPM_INLINE inline __attribute__((always_inline))
+
+typedef int32_t opm_svec_t __attribute__((vector_size(OPM_MULTI_LANES * 4), aligned(16)));
+
+/* Comparison result (0 or -1 per lane) to 0/1 */
+#define OPM_VB(cmp) ((opm_vec_t)(cmp) & 1)
+/* Nonzero to 0/1 */
+#define OPM_VNZ(x) OPM_VB((x) != 0)
+/* Per-lane b ? x : y for b in {0, 1} */
+#define OPM_VSEL(b, x, y) (((x) & -(b)) | ((y) & ((b) - 1)))
+/* Sign-extend the low 16 bits, as a store to an int16_t field would */
+#define OPM_VS16(x) ((opm_vec_t)(((opm_svec_t)((x) << 16)) >> 16))
+
+static const opm_vec_t vzero;
+
+static OPM_INLINE opm_vec_t OPM_VSplat(uint32_t x)
+{
+    return vzero + x;
+}
+
+static OPM_INLINE int OPM_VAny(opm_vec_t v)
+{
+    uint32_t r = 0;
+    int i;
+    for (i = 0; i < OPM_MULTI_LANES; i++)
+    {
+        r |= v[i];
+    }
+    return r != 0;
+}
+
+static OPM_INLINE opm_vec_t OPM_VGather16(const uint16_t *table, opm_vec_t idx)
+{
+    opm_vec_t r;
+    int i;
+    for (i = 0; i < OPM_MULTI_LANES; i++)
+    {
+        r[i] = table[idx[i]];
+    }
+    return r;
+}
+
+static OPM_INLINE opm_vec_t OPM_VGather32(const uint32_t *table, opm_vec_t idx)
+{
+    opm_vec_t r;
+    int i;
+    for (i = 0; i < OPM_MULTI_LANES; i++)
+    {
+        r[i] = table[idx[i]];
+    }
+    return r;
+}
+
+/* fm_algorithm[row][op][connect] for each lane's connect */
+static OPM_INLINE opm_vec_t OPM_VAlgorithm(uint32_t row, uint32_t op, opm_vec_t connect)
+{
+    uint32_t bits = 0;
+    uint32_t i;
+    for (i = 0; i < 8; i++)
+    {
+        bits |= fm_algorithm[row][op][i] << i;
+    }
+    return (OPM_VSplat(bits) >> connect) & 1;
+}
+
+static OPM_INLINE opm_vec_t OPM_KCToFNum(opm_vec_t kcode)
+{
+    opm_vec_t kcode_h = (kcode >> 4) & 63;
+    opm_vec_t kcode_l = kcode & 15;
+    opm_vec_t basefreq, approxtype, slope, slope1, sum_a, sum_b;
+    int i;
+    for (i = 0; i < OPM_MULTI_LANES; i++)
+    {
+        basefreq[i] = pg_freqtable[kcode_h[i]].basefreq;
+        approxtype[i] = pg_freqtable[kcode_h[i]].approxtype;
+        slope[i] = pg_freqtable[kcode_h[i]].slope;
+    }
+    sum_a = ((slope >> 3) & -(kcode_l & 1))
+        + ((slope >> 2) & -((kcode_l >> 1) & 1))
+        + ((slope >> 1) & -((kcode_l >> 2) & 1))
+        + (slope & -((kcode_l >> 3) & 1));
+
+    slope1 = slope | 1;
+    sum_b = (((slope1 >> 3) + 2) & -(kcode_l & 1))
+        + (8 & -((kcode_l >> 1) & 1))
+        + ((slope1 >> 1) & -((kcode_l >> 2) & 1))
+        + ((slope1 + 1) & -((kcode_l >> 3) & 1))
+        + (4 & -(OPM_VB((kcode_l & 12) == 12) & OPM_VB((slope & 1) == 0)));
+
+    return basefreq + (OPM_VSEL(OPM_VNZ(approxtype), sum_a, sum_b) >> 1);
+}
+
+static OPM_INLINE opm_vec_t OPM_LFOApplyPMS(opm_vec_t lfo, opm_vec_t pms)
+{
+    opm_vec_t pms7 = OPM_VB(pms == 7);
+    opm_vec_t top = (lfo >> 4) & 7;
+    opm_vec_t t, out, out_lo, out_hi;
+    top = OPM_VSEL(pms7, top, top >> 1);
+    t = OPM_VB((top & 6) == 6) | (OPM_VB((top & 3) == 3) & OPM_VB(pms >= 6));
+
+    out = top + ((top >> 2) & 1) + t;
+    out = out * 2 + ((lfo >> 4) & 1);
+    out = OPM_VSEL(pms7, out >> 1, out);
+    out &= 15;
+    out = (lfo & 15) + out * 16;
+
+    /* pms 1..5: (out >> (6 - pms)) & ((2 << pms) - 1), pms 6..7: out << (pms - 5) */
+    out_lo = (out >> ((6 - pms) & 7)) & ((OPM_VSplat(2) << pms) - 1);
+    out_hi = (out & 255) << ((pms - 5) & 3);
+    out = OPM_VSEL(OPM_VB(pms >= 6), out_hi, out_lo);
+    return OPM_VSEL(OPM_VB(pms == 0), vzero, out);
+}
+
+static OPM_INLINE opm_vec_t OPM_CalcKCode(opm_vec_t kcf, opm_vec_t lfo, opm_vec_t lfo_sign, opm_vec_t dt)
+{
+    opm_vec_t t2, t3, b0, b1, b2, b3, w2, w3, w6;
+    opm_vec_t overflow1, overflow2, negoverflow;
+    opm_vec_t sum, cr, nsign = lfo_sign ^ 1;
+    lfo = OPM_VSEL(lfo_sign, lfo, ~lfo);
+    sum = (kcf & 8191) + (lfo & 8191) + nsign;
+    cr = ((kcf & 255) + (lfo & 255) + nsign) >> 8;
+    overflow1 = (sum >> 13) & 1;
+    sum &= 8191;
+    sum += 64 & -(lfo_sign & (OPM_VB(((sum >> 6) & 3) == 3) | cr));
+    negoverflow = nsign & (cr ^ 1);
+    sum += ((-64) & 8191) & -negoverflow;
+    overflow2 = (sum >> 13) & 1;
+    sum &= 8191;
+    sum = OPM_VSEL((nsign & (overflow1 ^ 1)) | (negoverflow & (overflow2 ^ 1)), vzero, sum);
+    sum = OPM_VSEL(lfo_sign & (overflow1 | overflow2), OPM_VSplat(8127), sum);
+
+    t2 = sum & 63;
+    t2 += 20 & -OPM_VB(dt == 2);
+    t2 += 32 & -OPM_VB(dt >= 2);
+
+    b0 = (t2 >> 6) & 1;
+    b1 = OPM_VB(dt == 2);
+    b2 = (sum >> 6) & 1;
+    b3 = (sum >> 7) & 1;
+
+    w2 = b0 & b1 & b2;
+    w3 = b0 & b3;
+    w6 = (b0 & (w2 ^ 1) & (w3 ^ 1)) | (b3 & (b0 ^ 1) & b1);
+
+    t2 &= 63;
+
+    t3 = (sum >> 6) + w6 + b1 + (w2 | w3) * 2 + OPM_VB(dt == 3) * 4 + OPM_VNZ(dt) * 8;
+    b0 = OPM_VNZ(t3 & 128);
+    t2 = OPM_VSEL(b0, OPM_VSplat(63), t2);
+    t3 = OPM_VSEL(b0, OPM_VSplat(126), t3);
+    return t3 * 64 + t2;
+}
+
+static OPM_INLINE void OPM_PhaseCalcFNumBlock(opm_multi_t *chip, uint32_t cycles)
+{
+    uint32_t slot = (cycles + 7) % 32;
+    uint32_t channel = slot % 8;
+    opm_vec_t kcf = (chip->ch_kc[channel] << 6) + chip->ch_kf[channel];
+    opm_vec_t lfo = chip->lfo_pm_lock & -OPM_VNZ(chip->lfo_pmd);
+    opm_vec_t pms = chip->ch_pms[channel];
+    opm_vec_t dt = chip->sl_dt2[slot];
+    opm_vec_t lfo_pm = OPM_LFOApplyPMS(lfo & 127, pms);
+    opm_vec_t lfo_sign = (OPM_VNZ(lfo & 0x80) & OPM_VNZ(pms)) ^ 1;
+    opm_vec_t kcode = OPM_CalcKCode(kcf, lfo_pm, lfo_sign, dt);
+    chip->pg_fnum[slot] = OPM_KCToFNum(kcode);
+    chip->pg_kcode[slot] = kcode >> 8;
+}
+
+static OPM_INLINE void OPM_PhaseCalcIncrement(opm_multi_t *chip, uint32_t cycles)
+{
+    uint32_t slot = cycles;
+    opm_vec_t dt = chip->sl_dt1[slot];
+    opm_vec_t dt_l = dt & 3;
+    opm_vec_t multi = chip->sl_mul[slot];
+    opm_vec_t kcode = chip->pg_kcode[slot];
+    opm_vec_t fnum = chip->pg_fnum[slot];
+    opm_vec_t block = kcode >> 2;
+    opm_vec_t basefreq = (fnum << block) >> 2;
+    opm_vec_t note, sum, sum_h, sum_l, detune, inc;
+    /* Apply detune */
+    kcode = OPM_VSEL(OPM_VB(kcode > 0x1c), OPM_VSplat(0x1c), kcode);
+    block = kcode >> 2;
+    note = kcode & 0x03;
+    sum = block + 9 + (OPM_VB(dt_l == 3) | (dt_l & 0x02));
+    sum_h = sum >> 1;
+    sum_l = sum & 0x01;
+    detune = OPM_VGather32(pg_detune, (sum_l << 2) | note) >> (9 - sum_h);
+    detune &= -OPM_VNZ(dt_l);
+    basefreq = OPM_VSEL((dt >> 2) & 1, basefreq - detune, basefreq + detune);
+    basefreq &= 0x1ffff;
+    inc = OPM_VSEL(OPM_VNZ(multi), basefreq * multi, basefreq >> 1);
+    chip->pg_inc[slot] = inc & 0xfffff;
+}
+
+static OPM_INLINE void OPM_PhaseGenerate(opm_multi_t *chip, uint32_t cycles)
+{
+    uint32_t slot = (cycles + 27) % 32;
+    chip->pg_reset_latch[slot] = chip->pg_reset[slot];
+    slot = (cycles + 25) % 32;
+    /* Mask increment */
+    chip->pg_inc[slot] &= chip->pg_reset_latch[slot] - 1;
+    /* Phase step */
+    slot = (cycles + 24) % 32;
+    chip->pg_phase[slot] &= (chip->pg_reset_latch[slot] | chip->mode_test[3]) - 1;
+    chip->pg_phase[slot] += chip->pg_inc[slot];
+    chip->pg_phase[slot] &= 0xfffff;
+}
+
+static OPM_INLINE void OPM_PhaseDebug(opm_multi_t *chip, uint32_t cycles)
+{
+    chip->pg_serial >>= 1;
+    if (cycles == 5)
+    {
+        chip->pg_serial |= (chip->pg_phase[29] & 0x3ff);
+    }
+}
+
+static OPM_INLINE void OPM_KeyOn1(opm_multi_t *chip, uint32_t cycles)
+{
+    uint32_t cycles1 = (cycles + 1) % 32;
+    chip->kon_chanmatch = OPM_VB(chip->mode_kon_channel + 24 == cycles1);
+}
+
+static OPM_INLINE void OPM_KeyOn2(opm_multi_t *chip, uint32_t cycles)
+{
+    uint32_t slot = (cycles + 8) % 32;
+    opm_vec_t m = chip->kon_chanmatch;
+    chip->mode_kon[(slot + 0) % 32] = OPM_VSEL(m, chip->mode_kon_operator[0], chip->mode_kon[(slot + 0) % 32]);
+    chip->mode_kon[(slot + 8) % 32] = OPM_VSEL(m, chip->mode_kon_operator[2], chip->mode_kon[(slot + 8) % 32]);
+    chip->mode_kon[(slot + 16) % 32] = OPM_VSEL(m, chip->mode_kon_operator[1], chip->mode_kon[(slot + 16) % 32]);
+    chip->mode_kon[(slot + 24) % 32] = OPM_VSEL(m, chip->mode_kon_operator[3], chip->mode_kon[(slot + 24) % 32]);
+}
+
+static OPM_INLINE void OPM_EnvelopePhase1(opm_multi_t *chip, uint32_t cycles)
+{
+    uint32_t slot = (cycles + 2) % 32;
+    opm_vec_t kon = chip->mode_kon[slot] | chip->kon_csm;
+    opm_vec_t konevent = (chip->kon[slot] ^ 1) & kon;
+    chip->eg_state[slot] = OPM_VSEL(konevent, OPM_VSplat(eg_num_attack), chip->eg_state[slot]);
+
+    chip->kon2[slot] = chip->kon[slot];
+    chip->kon[slot] = kon;
+}
+
+static OPM_INLINE void OPM_EnvelopePhase2(opm_multi_t *chip, uint32_t cycles)
+{
+    uint32_t slot = cycles;
+    uint32_t chan = slot % 8;
+    opm_vec_t state = chip->eg_state[slot];
+    opm_vec_t rate, ksv, zr, ams;
+    rate = OPM_VSEL(OPM_VB(state == eg_num_attack), chip->sl_ar[slot],
+           OPM_VSEL(OPM_VB(state == eg_num_decay), chip->sl_d1r[slot],
+           OPM_VSEL(OPM_VB(state == eg_num_sustain), chip->sl_d2r[slot],
+                    chip->sl_rr[slot] * 2 + 1)));
+    if (chip->ic)
+    {
+        rate = OPM_VSplat(31);
+    }
+
+    zr = OPM_VB(rate == 0);
+
+    ksv = chip->pg_kcode[slot] >> (chip->sl_ks[slot] ^ 3);
+    ksv &= ~(3 & -(OPM_VB(chip->sl_ks[slot] == 0) & zr));
+    rate = rate * 2 + ksv;
+    rate = OPM_VSEL(OPM_VNZ(rate & 64), OPM_VSplat(63), rate);
+
+    chip->eg_tl[2] = chip->eg_tl[1];
+    chip->eg_tl[1] = chip->eg_tl[0];
+    chip->eg_tl[0] = chip->sl_tl[slot];
+    chip->eg_sl[1] = chip->eg_sl[0];
+    chip->eg_sl[0] = OPM_VSEL(OPM_VB(chip->sl_d1l[slot] == 15), OPM_VSplat(31), chip->sl_d1l[slot]);
+    chip->eg_zr[1] = chip->eg_zr[0];
+    chip->eg_zr[0] = zr;
+    chip->eg_rate[1] = chip->eg_rate[0];
+    chip->eg_rate[0] = rate;
+    chip->eg_ratemax[1] = chip->eg_ratemax[0];
+    chip->eg_ratemax[0] = OPM_VB((rate >> 1) == 31);
+    ams = chip->ch_ams[chan] & -chip->sl_am_e[slot];
+    chip->eg_am = (chip->lfo_am_lock << ((ams - 1) & 3)) & -OPM_VNZ(ams);
+}
+
+static OPM_INLINE void OPM_EnvelopePhase3(opm_multi_t *chip, uint32_t cycles)
+{
+    uint32_t slot = (cycles + 31) % 32;
+    chip->eg_shift = (chip->eg_timershift_lock + (chip->eg_rate[0] >> 2)) & 15;
+    chip->eg_inchi = OPM_VGather32(&eg_stephi[0][0], ((chip->eg_rate[0] & 3) << 2) | (chip->eg_timer_lock & 3));
+
+    chip->eg_outtemp[1] = chip->eg_outtemp[0];
+    chip->eg_outtemp[0] = chip->eg_level[slot] + chip->eg_am;
+    chip->eg_outtemp[0] = OPM_VSEL(OPM_VNZ(chip->eg_outtemp[0] & 1024), OPM_VSplat(1023), chip->eg_outtemp[0]);
+}
+
+static OPM_INLINE void OPM_EnvelopePhase4(opm_multi_t *chip, uint32_t cycles)
+{
+    uint32_t slot = (cycles + 30) % 32;
+    opm_vec_t rate = chip->eg_rate[1];
+    opm_vec_t state = chip->eg_state[slot];
+    opm_vec_t level = chip->eg_level[slot];
+    opm_vec_t kon_slot = chip->kon[slot];
+    opm_vec_t inc_hi, inc_lo, inc, kon, eg_off, eg_zero, slreach, next;
+
+    inc_hi = chip->eg_inchi + (rate >> 2) - 11;
+    inc_hi = OPM_VSEL(OPM_VB(inc_hi > 4), OPM_VSplat(4), inc_hi);
+    inc_lo = (OPM_VNZ(rate) & -OPM_VB(chip->eg_shift == 12))
+        | (((rate >> 1) & 1) & -OPM_VB(chip->eg_shift == 13))
+        | ((rate & 1) & -OPM_VB(chip->eg_shift == 14));
+    inc_lo &= -(chip->eg_zr[1] ^ 1);
+    inc = OPM_VSEL(OPM_VB(rate >= 48), inc_hi, inc_lo);
+    chip->eg_inc = inc & -((chip->eg_clock >> 1) & 1);
+
+    kon = kon_slot & (chip->kon2[slot] ^ 1);
+    chip->pg_reset[slot] = kon;
+    chip->eg_instantattack = chip->eg_ratemax[1] & kon;
+
+    eg_off = OPM_VB((level & 0x3f0) == 0x3f0);
+    slreach = OPM_VB((level >> 4) == (chip->eg_sl[1] << 1));
+    eg_zero = OPM_VB(level == 0);
+
+    chip->eg_mute = eg_off & OPM_VB(state != eg_num_attack) & (kon ^ 1);
+    chip->eg_inclinear = (kon ^ 1) & (eg_off ^ 1)
+        & ((OPM_VB(state == eg_num_decay) & (slreach ^ 1)) | OPM_VB(state >= eg_num_sustain));
+    chip->eg_incattack = OPM_VB(state == eg_num_attack) & (chip->eg_ratemax[1] ^ 1) & kon_slot & (eg_zero ^ 1);
+
+    // Update state
+    next = OPM_VSEL(OPM_VB(state == eg_num_attack),
+                    OPM_VSEL(eg_zero, OPM_VSplat(eg_num_decay), state),
+           OPM_VSEL(OPM_VB(state == eg_num_decay),
+                    OPM_VSEL(eg_off, OPM_VSplat(eg_num_release),
+                    OPM_VSEL(slreach, OPM_VSplat(eg_num_sustain), state)),
+           OPM_VSEL(OPM_VB(state == eg_num_sustain),
+                    OPM_VSEL(eg_off, OPM_VSplat(eg_num_release), state),
+                    state)));
+    next = OPM_VSEL(kon_slot, next, OPM_VSplat(eg_num_release));
+    next = OPM_VSEL(kon, OPM_VSplat(eg_num_attack), next);
+
+    if (chip->ic)
+    {
+        next = OPM_VSplat(eg_num_release);
+    }
+    chip->eg_state[slot] = next;
+}
+
+static OPM_INLINE void OPM_EnvelopePhase5(opm_multi_t *chip, uint32_t cycles)
+{
+    uint32_t slot = (cycles + 29) % 32;
+    opm_vec_t level = chip->eg_level[slot];
+    opm_vec_t inc = chip->eg_inc;
+    opm_vec_t step;
+    level &= chip->eg_instantattack - 1;
+    level = OPM_VSEL(chip->eg_mute | chip->ic, OPM_VSplat(0x3ff), level);
+    step = ((OPM_VSplat(1) << ((inc - 1) & 31)) & -chip->eg_inclinear)
+        | ((opm_vec_t)(((~(opm_svec_t)chip->eg_level[slot]) << (opm_svec_t)inc) >> 5) & -chip->eg_incattack);
+    step &= -OPM_VNZ(inc);
+    level += step;
+    chip->eg_level[slot] = level & 0xffff;
+
+    chip->eg_out[0] = chip->eg_outtemp[1] + (chip->eg_tl[2] << 3);
+    chip->eg_out[0] = OPM_VSEL(OPM_VNZ(chip->eg_out[0] & 1024), OPM_VSplat(1023), chip->eg_out[0]);
+    chip->eg_out[0] &= chip->eg_test - 1;
+
+    chip->eg_test = chip->mode_test[5];
+}
+
+static OPM_INLINE void OPM_EnvelopePhase6(opm_multi_t *chip, uint32_t cycles)
+{
+    chip->eg_serial_bit = (chip->eg_serial >> 9) & 1;
+    if (cycles == 3)
+    {
+        chip->eg_serial = chip->eg_out[0] ^ 1023;
+    }
+    else
+    {
+        chip->eg_serial <<= 1;
+    }
+
+    chip->eg_out[1] = chip->eg_out[0];
+}
+
+static OPM_INLINE void OPM_EnvelopeClock(opm_multi_t *chip, uint32_t cycles)
+{
+    chip->eg_clock <<= 1;
+    chip->eg_clock |= ((chip->eg_clockcnt >> 1) & 1) | chip->mode_test[0];
+    chip->eg_clock &= 0xff;
+    if (chip->ic || (cycles == 31 && (chip->eg_clockcnt & 2) != 0))
+    {
+        chip->eg_clockcnt = 0;
+    }
+    else if (cycles == 31)
+    {
+        chip->eg_clockcnt++;
+    }
+}
+
+static OPM_INLINE void OPM_EnvelopeTimer(opm_multi_t *chip, uint32_t cycles)
+{
+    uint32_t cycle = (cycles + 31) % 16;
+    uint32_t cycle2;
+    opm_vec_t inc = chip->eg_clock & 1;
+    opm_vec_t timerbit = (chip->eg_timer >> cycle) & 1;
+    opm_vec_t sum, sum0, bit2, m, shift_lock;
+    if (cycle != 0)
+    {
+        inc &= chip->eg_timercarry;
+    }
+    if (((cycles + 31) % 32) >= 16)
+    {
+        inc = vzero;
+    }
+    sum = timerbit + inc;
+    sum0 = sum & 1 & (chip->ic ^ 1);
+    chip->eg_timercarry = sum >> 1;
+    chip->eg_timer = (chip->eg_timer & (~(1u << cycle))) | (sum0 << cycle);
+
+    cycle2 = (cycles + 30) % 16;
+
+    bit2 = (chip->eg_timer >> cycle2) & 1;
+    chip->eg_timer2 <<= 1;
+    chip->eg_timer2 |= bit2 & (chip->eg_timerbstop ^ 1);
+
+    chip->eg_timerbstop |= bit2;
+
+    if (cycle == 0 || chip->ic2)
+    {
+        chip->eg_timerbstop = vzero;
+    }
+
+    if (cycles == 1)
+    {
+        m = chip->eg_clock & 1;
+        shift_lock = OPM_VNZ(chip->eg_timer2 & (8 + 32 + 128 + 512 + 2048 + 8192 + 32768))
+            | (OPM_VNZ(chip->eg_timer2 & (4 + 32 + 64 + 512 + 1024 + 8192 + 16384)) << 1)
+            | (OPM_VNZ(chip->eg_timer2 & (4 + 8 + 16 + 512 + 1024 + 2048 + 4096)) << 2)
+            | (OPM_VNZ(chip->eg_timer2 & (4 + 8 + 16 + 32 + 64 + 128 + 256)) << 3);
+        chip->eg_timershift_lock = OPM_VSEL(m, shift_lock, chip->eg_timershift_lock);
+        chip->eg_timer_lock = OPM_VSEL(m, chip->eg_timer & 0xff, chip->eg_timer_lock);
+    }
+}
+
+static OPM_INLINE void OPM_OperatorPhase1(opm_multi_t *chip, uint32_t cycles)
+{
+    uint32_t slot = cycles;
+    opm_vec_t mod = chip->op_mod[2];
+    opm_vec_t fb = chip->op_fb[1];
+    chip->op_phase_in = chip->pg_phase[slot] >> 10;
+    if (chip->op_fbshift & 8)
+    {
+        mod = (opm_vec_t)((opm_svec_t)mod >> (opm_svec_t)((9 - fb) & 15));
+        mod &= -OPM_VNZ(fb);
+    }
+    chip->op_mod_in = mod & 0xffff;
+}
+
+static OPM_INLINE void OPM_OperatorPhase2(opm_multi_t *chip)
+{
+    chip->op_phase = (chip->op_phase_in + chip->op_mod_in) & 1023;
+}
+
+static OPM_INLINE void OPM_OperatorPhase3(opm_multi_t *chip)
+{
+    opm_vec_t phase = chip->op_phase & 255;
+    phase ^= 255 & -((chip->op_phase >> 8) & 1);
+    chip->op_logsin[0] = OPM_VGather16(logsinrom, phase);
+    chip->op_sign <<= 1;
+    chip->op_sign |= (chip->op_phase >> 9) & 1;
+}
+
+static OPM_INLINE void OPM_OperatorPhase4(opm_multi_t *chip)
+{
+    chip->op_logsin[1] = chip->op_logsin[0];
+}
+
+static OPM_INLINE void OPM_OperatorPhase5(opm_multi_t *chip)
+{
+    chip->op_logsin[2] = chip->op_logsin[1];
+}
+
+static OPM_INLINE void OPM_OperatorPhase6(opm_multi_t *chip)
+{
+    chip->op_atten = chip->op_logsin[2] + (chip->eg_out[1] << 2);
+    chip->op_atten = OPM_VSEL(OPM_VNZ(chip->op_atten & 4096), OPM_VSplat(4095), chip->op_atten);
+}
+
+static OPM_INLINE void OPM_OperatorPhase7(opm_multi_t *chip)
+{
+    chip->op_exp[0] = OPM_VGather16(exprom, chip->op_atten & 255);
+    chip->op_pow[0] = chip->op_atten >> 8;
+}
+
+static OPM_INLINE void OPM_OperatorPhase8(opm_multi_t *chip)
+{
+    chip->op_exp[1] = chip->op_exp[0];
+    chip->op_pow[1] = chip->op_pow[0];
+}
+
+static OPM_INLINE void OPM_OperatorPhase9(opm_multi_t *chip)
+{
+    opm_vec_t out = (chip->op_exp[1] << 2) >> chip->op_pow[1];
+    opm_vec_t neg = -((chip->op_sign >> 5) & 1);
+    chip->op_out[0] = (out ^ neg) - neg;
+}
+
+static OPM_INLINE void OPM_OperatorPhase10(opm_multi_t *chip)
+{
+    chip->op_out[1] = chip->op_out[0];
+}
+
+static OPM_INLINE void OPM_OperatorPhase11(opm_multi_t *chip)
+{
+    chip->op_out[2] = chip->op_out[1];
+}
+
+static OPM_INLINE void OPM_OperatorPhase12(opm_multi_t *chip)
+{
+    chip->op_out[3] = chip->op_out[2];
+}
+
+static OPM_INLINE void OPM_OperatorPhase13(opm_multi_t *chip, uint32_t cycles)
+{
+    uint32_t slot = (cycles + 20) % 32;
+    chip->op_out[4] = chip->op_out[3];
+    chip->op_connect = chip->ch_connect[slot % 8];
+}
+
+static OPM_INLINE void OPM_OperatorPhase14(opm_multi_t *chip, uint32_t cycles)
+{
+    uint32_t slot = (cycles + 19) % 32;
+    uint32_t row = (chip->op_counter + 2) % 4;
+    opm_vec_t out;
+    chip->op_mix = chip->op_out[5] = chip->op_out[4];
+    chip->op_fbupdate = (chip->op_counter == 0);
+    chip->op_c1update = (chip->op_counter == 2);
+    chip->op_fbshift <<= 1;
+    chip->op_fbshift |= (chip->op_counter == 2);
+
+    chip->op_modtable[0] = OPM_VAlgorithm(row, 0, chip->op_connect);
+    chip->op_modtable[1] = OPM_VAlgorithm(row, 1, chip->op_connect);
+    chip->op_modtable[2] = OPM_VAlgorithm(row, 2, chip->op_connect);
+    chip->op_modtable[3] = OPM_VAlgorithm(row, 3, chip->op_connect);
+    chip->op_modtable[4] = OPM_VAlgorithm(row, 4, chip->op_connect);
+    out = OPM_VAlgorithm(chip->op_counter, 5, chip->op_connect);
+    chip->op_mixl = out & chip->ch_rl[slot % 8] & 1;
+    chip->op_mixr = out & (chip->ch_rl[slot % 8] >> 1) & 1;
+}
+
+static OPM_INLINE void OPM_OperatorPhase15(opm_multi_t *chip, uint32_t cycles)
+{
+    uint32_t slot = (cycles + 18) % 32;
+    opm_vec_t mod, mod1, mod2;
+    mod2 = (chip->op_m1[slot % 8][0] & -chip->op_modtable[0])
+        | (chip->op_out[5] & -chip->op_modtable[3]);
+    mod1 = (chip->op_m1[slot % 8][1] & -chip->op_modtable[1])
+        | (chip->op_c1[slot % 8] & -chip->op_modtable[2])
+        | (chip->op_out[5] & -chip->op_modtable[4]);
+    mod = (opm_vec_t)(((opm_svec_t)mod1 + (opm_svec_t)mod2) >> 1);
+    chip->op_mod[0] = mod;
+    if (chip->op_fbupdate)
+    {
+        chip->op_m1[slot % 8][1] = chip->op_m1[slot % 8][0];
+        chip->op_m1[slot % 8][0] = chip->op_out[5];
+    }
+    if (chip->op_c1update)
+    {
+        chip->op_c1[slot % 8] = chip->op_out[5];
+    }
+}
+
+static OPM_INLINE void OPM_OperatorPhase16(opm_multi_t *chip, uint32_t cycles)
+{
+    uint32_t slot = (cycles + 17) % 32;
+    // hack
+    chip->op_mod[2] = chip->op_mod[1];
+    chip->op_fb[1] = chip->op_fb[0];
+
+    chip->op_mod[1] = chip->op_mod[0];
+    chip->op_fb[0] = chip->ch_fb[slot % 8];
+}
+
+static OPM_INLINE void OPM_OperatorCounter(opm_multi_t *chip, uint32_t cycles)
+{
+    if ((cycles % 8) == 4)
+    {
+        chip->op_counter++;
+    }
+    if (cycles == 12)
+    {
+        chip->op_counter = 0;
+    }
+}
+
+static OPM_INLINE void OPM_Mixer2(opm_multi_t *chip, uint32_t cycles)
+{
+    uint32_t cycles30 = (cycles + 30) % 32;
+    opm_vec_t bit, top, ex;
+    if (cycles30 < 16)
+    {
+        bit = chip->mix_serial[0] & 1;
+    }
+    else
+    {
+        bit = chip->mix_serial[1] & 1;
+    }
+    if (cycles % 16 == 1)
+    {
+        chip->mix_sign_lock = bit ^ 1;
+        chip->mix_top_bits_lock = (chip->mix_bits >> 15) & 63;
+    }
+    chip->mix_bits >>= 1;
+    chip->mix_bits |= bit << 20;
+    if (cycles % 16 == 10)
+    {
+        top = chip->mix_top_bits_lock ^ (63 & -chip->mix_sign_lock);
+        ex = OPM_VSplat(1);
+        ex = OPM_VSEL(top & 1, OPM_VSplat(2), ex);
+        ex = OPM_VSEL((top >> 1) & 1, OPM_VSplat(3), ex);
+        ex = OPM_VSEL((top >> 2) & 1, OPM_VSplat(4), ex);
+        ex = OPM_VSEL((top >> 3) & 1, OPM_VSplat(5), ex);
+        ex = OPM_VSEL((top >> 4) & 1, OPM_VSplat(6), ex);
+        ex = OPM_VSEL((top >> 5) & 1, OPM_VSplat(7), ex);
+        chip->mix_sign_lock2 = chip->mix_sign_lock;
+        chip->mix_exp_lock = ex;
+    }
+    chip->mix_out_bit = (chip->mix_out_bit << 1) & 0xff;
+    switch ((cycles + 1) % 16)
+    {
+    case 0:
+        chip->mix_out_bit |= chip->mix_sign_lock2 ^ 1;
+        break;
+    case 1:
+        chip->mix_out_bit |= (chip->mix_exp_lock >> 0) & 1;
+        break;
+    case 2:
+        chip->mix_out_bit |= (chip->mix_exp_lock >> 1) & 1;
+        break;
+    case 3:
+        chip->mix_out_bit |= (chip->mix_exp_lock >> 2) & 1;
+        break;
+    default:
+        chip->mix_out_bit |= (chip->mix_bits >> ((chip->mix_exp_lock - 1) & 31)) & 1
+            & OPM_VNZ(chip->mix_exp_lock);
+        break;
+    }
+}
+
+static OPM_INLINE void OPM_Output(opm_multi_t *chip, uint32_t cycles)
+{
+    uint32_t slot = (cycles + 27) % 32;
+    chip->smp_so = (chip->mix_out_bit >> 2) & 1;
+    chip->smp_sh1 = (slot & 24) == 8 && !chip->ic;
+    chip->smp_sh2 = (slot & 24) == 24 && !chip->ic;
+}
+
+static OPM_INLINE void OPM_DAC(opm_multi_t *chip)
+{
+    opm_vec_t exp, mant;
+    if (chip->dac_osh1 && !chip->smp_sh1)
+    {
+        exp = (chip->dac_bits >> 10) & 7;
+        mant = (chip->dac_bits >> 0) & 1023;
+        mant -= 512;
+        chip->dac_output[1] = (opm_vec_t)((opm_svec_t)(mant << exp) >> 1);
+    }
+    if (chip->dac_osh2 && !chip->smp_sh2)
+    {
+        exp = (chip->dac_bits >> 10) & 7;
+        mant = (chip->dac_bits >> 0) & 1023;
+        mant -= 512;
+        chip->dac_output[0] = (opm_vec_t)((opm_svec_t)(mant << exp) >> 1);
+    }
+    chip->dac_bits >>= 1;
+    chip->dac_bits |= chip->smp_so << 12;
+    chip->dac_osh1 = chip->smp_sh1;
+    chip->dac_osh2 = chip->smp_sh2;
+}
+
+/* Serialize one channel of mix2 into mix_serial, clamping on overflow */
+static OPM_INLINE void OPM_MixerLoad(opm_multi_t *chip, uint32_t ch)
+{
+    opm_vec_t top = (chip->mix2[ch] >> 15) & 7;
+    chip->mix_serial[ch] |= ((chip->mix2[ch] >> 10) & 31) << 13;
+    chip->mix_serial[ch] |= (((chip->mix2[ch] >> 17) & 1) ^ 1) << 18;
+    chip->mix_clamp_low[ch] = OPM_VB(top >= 4) & OPM_VB(top <= 6);
+    chip->mix_clamp_high[ch] = OPM_VB(top >= 1) & OPM_VB(top <= 3);
+}
+
+static OPM_INLINE void OPM_Mixer(opm_multi_t *chip, uint32_t cycles)
+{
+    // Right channel
+    chip->mix_serial[1] >>= 1;
+    if (cycles == 13)
+    {
+        chip->mix_serial[1] |= (chip->mix[1] & 1023) << 4;
+    }
+    if (cycles == 14)
+    {
+        OPM_MixerLoad(chip, 1);
+    }
+    chip->mix_serial[1] &= ~(chip->mix_clamp_low[1] << 1);
+    chip->mix_serial[1] |= chip->mix_clamp_high[1] << 1;
+    // Left channel
+    chip->mix_serial[0] >>= 1;
+    if (cycles == 29)
+    {
+        chip->mix_serial[0] |= (chip->mix[0] & 1023) << 4;
+    }
+    if (cycles == 30)
+    {
+        OPM_MixerLoad(chip, 0);
+    }
+    chip->mix_serial[0] &= ~(chip->mix_clamp_low[0] << 1);
+    chip->mix_serial[0] |= chip->mix_clamp_high[0] << 1;
+    chip->mix2[0] = chip->mix[0];
+    chip->mix2[1] = chip->mix[1];
+    if (cycles == 13)
+    {
+        chip->mix[1] = vzero;
+    }
+    if (cycles == 29)
+    {
+        chip->mix[0] = vzero;
+    }
+    chip->mix[0] += chip->op_mix & -chip->op_mixl;
+    chip->mix[1] += chip->op_mix & -chip->op_mixr;
+}
+
+static OPM_INLINE void OPM_Noise(opm_multi_t *chip)
+{
+    opm_vec_t nic = OPM_VSplat(!chip->ic);
+    opm_vec_t w1 = nic & (chip->noise_update ^ 1);
+    opm_vec_t xr = ((chip->noise_lfsr >> 2) & 1) ^ chip->noise_temp;
+    opm_vec_t w2t = OPM_VB((chip->noise_lfsr & 0xffff) == 0xffff) & OPM_VB(chip->noise_temp == 0);
+    opm_vec_t w2 = (w2t ^ 1) & (xr ^ 1);
+    opm_vec_t w3 = nic & (w1 ^ 1) & (w2 ^ 1);
+    opm_vec_t w4 = (((chip->noise_lfsr & 1) ^ 1) | (w1 ^ 1)) & (w3 ^ 1);
+    chip->noise_temp = OPM_VSEL(w1, chip->noise_temp, (chip->noise_lfsr & 1) ^ 1);
+    chip->noise_lfsr >>= 1;
+    chip->noise_lfsr |= w4 << 15;
+}
+
+static OPM_INLINE void OPM_NoiseTimer(opm_multi_t *chip, uint32_t cycles)
+{
+    opm_vec_t timer = chip->noise_timer;
+
+    chip->noise_update = chip->noise_timer_of;
+
+    if (cycles % 16 == 15)
+    {
+        timer++;
+        timer &= 31;
+        timer &= chip->noise_timer_of - 1;
+    }
+    if (chip->ic)
+    {
+        timer = vzero;
+    }
+
+    chip->noise_timer_of = OPM_VB(chip->noise_timer == (chip->noise_freq ^ 31));
+    chip->noise_timer = timer;
+}
+
+static OPM_INLINE void OPM_DoTimerA(opm_multi_t *chip)
+{
+    opm_vec_t value = chip->timer_a_val;
+    value += chip->timer_a_inc;
+    chip->timer_a_of = (value >> 10) & 1;
+    value &= chip->timer_a_do_reset - 1;
+    value = OPM_VSEL(chip->timer_a_do_load, chip->timer_a_reg, value);
+
+    chip->timer_a_val = value & 1023;
+}
+
+static OPM_INLINE void OPM_DoTimerA2(opm_multi_t *chip, uint32_t cycles)
+{
+    if (cycles == 1)
+    {
+        chip->timer_a_load = chip->timer_loada;
+    }
+    chip->timer_a_inc = chip->mode_test[2] | (cycles == 0 ? chip->timer_a_load : vzero);
+    chip->timer_a_do_load = chip->timer_a_of | (chip->timer_a_load & chip->timer_a_temp);
+    chip->timer_a_do_reset = chip->timer_a_temp;
+    chip->timer_a_temp = chip->timer_a_load ^ 1;
+    if (chip->ic)
+    {
+        chip->timer_a_status = vzero;
+    }
+    else
+    {
+        chip->timer_a_status |= chip->timer_irqa & chip->timer_a_of;
+        chip->timer_a_status &= chip->timer_reseta - 1;
+    }
+    chip->timer_reseta = vzero;
+}
+
+static OPM_INLINE void OPM_DoTimerB(opm_multi_t *chip, uint32_t cycles)
+{
+    opm_vec_t value = chip->timer_b_val;
+    value += chip->timer_b_inc;
+    chip->timer_b_of = (value >> 8) & 1;
+    value &= chip->timer_b_do_reset - 1;
+    value = OPM_VSEL(chip->timer_b_do_load, chip->timer_b_reg, value);
+
+    chip->timer_b_val = value & 255;
+
+    if (cycles == 0)
+    {
+        chip->timer_b_sub++;
+    }
+
+    chip->timer_b_sub_of = (chip->timer_b_sub >> 4) & 1;
+    chip->timer_b_sub &= 15;
+    if (chip->ic)
+    {
+        chip->timer_b_sub = 0;
+    }
+}
+
+static OPM_INLINE void OPM_DoTimerB2(opm_multi_t *chip)
+{
+    chip->timer_b_inc = chip->mode_test[2] | (chip->timer_b_sub_of ? chip->timer_loadb : vzero);
+    chip->timer_b_do_load = chip->timer_b_of | (chip->timer_loadb & chip->timer_b_temp);
+    chip->timer_b_do_reset = chip->timer_b_temp;
+    chip->timer_b_temp = chip->timer_loadb ^ 1;
+    if (chip->ic)
+    {
+        chip->timer_b_status = vzero;
+    }
+    else
+    {
+        chip->timer_b_status |= chip->timer_irqb & chip->timer_b_of;
+        chip->timer_b_status &= chip->timer_resetb - 1;
+    }
+    chip->timer_resetb = vzero;
+}
+
+static OPM_INLINE void OPM_DoTimerIRQ(opm_multi_t *chip)
+{
+    chip->timer_irq = chip->timer_a_status | chip->timer_b_status;
+}
+
+static OPM_INLINE void OPM_DoLFOMult(opm_multi_t *chip, uint32_t cycles)
+{
+    uint32_t ampm_sel = (chip->lfo_bit_counter & 8) != 0;
+    uint32_t bitpos = chip->lfo_bit_counter & 7;
+    opm_vec_t dp = ampm_sel ? chip->lfo_pmd : chip->lfo_amd;
+    opm_vec_t bit = vzero, b1, b2, sum;
+
+    chip->lfo_out2_b = chip->lfo_out2;
+
+    if (bitpos != 7)
+    {
+        bit = ((dp >> (6 - bitpos)) & 1) & (((chip->lfo_out1 >> (6 - bitpos)) & 1) ^ 1);
+    }
+
+    b1 = chip->lfo_out2 & 1;
+    if (bitpos == 0)
+    {
+        b1 = vzero;
+    }
+    b2 = chip->lfo_mult_carry;
+    if (cycles % 16 == 15)
+    {
+        b2 = vzero;
+    }
+    sum = bit + b1 + b2;
+    chip->lfo_out2 >>= 1;
+    chip->lfo_out2 |= (sum & 1) << 15;
+    chip->lfo_mult_carry = sum >> 1;
+}
+
+static OPM_INLINE void OPM_DoLFO1(opm_multi_t *chip, uint32_t cycles)
+{
+    opm_vec_t counter2 = chip->lfo_counter2;
+    opm_vec_t of_old = chip->lfo_counter2_of;
+    opm_vec_t lfo_bit, noise, sum, carry, w1, w2, w3, w4, w5, w6, w8, w9;
+    opm_vec_t lfo_pm_sign, wave2, wave3;
+    uint32_t ampm_sel = (chip->lfo_bit_counter & 8) != 0;
+    counter2 += ((chip->lfo_counter1_of1 >> 1) & 1) | chip->mode_test[3];
+    chip->lfo_counter2_of = (counter2 >> 15) & 1;
+    if (chip->ic)
+    {
+        counter2 = vzero;
+    }
+    counter2 = OPM_VSEL(chip->lfo_counter2_load, OPM_VGather16(lfo_counter2_table, chip->lfo_freq_hi), counter2);
+    chip->lfo_counter2 = counter2 & 32767;
+    chip->lfo_counter2_load = chip->lfo_frq_update | of_old;
+    chip->lfo_frq_update = vzero;
+    if ((cycles % 16) == 12)
+    {
+        chip->lfo_counter1++;
+    }
+    chip->lfo_counter1_of1 <<= 1;
+    chip->lfo_counter1_of1 |= (chip->lfo_counter1 >> 4) & 1;
+    chip->lfo_counter1 &= 15;
+    if (chip->ic)
+    {
+        chip->lfo_counter1 = 0;
+    }
+
+    if ((cycles & 15) == 5)
+    {
+        chip->lfo_counter2_of_lock2 = chip->lfo_counter2_of_lock;
+    }
+
+    chip->lfo_counter3 += chip->lfo_counter3_clock;
+    chip->lfo_counter3 &= 0xffff;
+    if (chip->ic)
+    {
+        chip->lfo_counter3 = vzero;
+    }
+
+    chip->lfo_counter3_clock = (cycles & 15) == 13 ? chip->lfo_counter2_of_lock2 : vzero;
+
+    if ((cycles & 15) == 15)
+    {
+        chip->lfo_trig_sign = (chip->lfo_val >> 7) & 1;
+        chip->lfo_saw_sign = (chip->lfo_val >> 8) & 1;
+    }
+
+    wave2 = OPM_VB(chip->lfo_wave == 2);
+    wave3 = OPM_VB(chip->lfo_wave == 3);
+
+    lfo_pm_sign = OPM_VSEL(wave2, chip->lfo_trig_sign, chip->lfo_saw_sign);
+
+    w5 = ampm_sel ? chip->lfo_saw_sign : (wave2 & chip->lfo_trig_sign) ^ 1;
+
+    w1 = (chip->lfo_clock ^ 1) | wave3 | OPM_VSplat((cycles & 15) != 15);
+    w2 = wave2 & (w1 ^ 1);
+    w4 = chip->lfo_clock_lock & wave3;
+    w3 = OPM_VSplat(!chip->ic) & (chip->mode_test[1] ^ 1) & (w4 ^ 1) & ((chip->lfo_val >> 15) & 1);
+
+    w6 = w5 ^ w3;
+
+    w9 = ampm_sel ? OPM_VSplat((cycles % 16) == 6) : chip->lfo_saw_sign ^ 1;
+
+    w8 = OPM_VSEL(OPM_VB(chip->lfo_wave == 1), w9, w6);
+
+    if (((cycles + 1) % 16) >= 8)
+    {
+        w8 = vzero;
+    }
+
+    chip->lfo_out1 <<= 1;
+    chip->lfo_out1 |= w8 ^ 1;
+
+    carry = (w1 ^ 1) | (OPM_VSplat((cycles & 15) != 15) & OPM_VNZ(chip->lfo_val_carry) & (wave3 ^ 1));
+    sum = carry + w2 + w3;
+    noise = chip->lfo_clock_lock & chip->noise_lfsr & 1;
+    lfo_bit = sum & 1;
+    lfo_bit |= wave3 & noise;
+    chip->lfo_val_carry = sum >> 1;
+    chip->lfo_val <<= 1;
+    chip->lfo_val |= lfo_bit;
+
+
+    if (cycles % 16 == 15 && (chip->lfo_bit_counter & 7) == 7)
+    {
+        if (ampm_sel)
+        {
+            chip->lfo_pm_lock = (chip->lfo_out2_b >> 8) & 255;
+            chip->lfo_pm_lock ^= lfo_pm_sign << 7;
+        }
+        else
+        {
+            chip->lfo_am_lock = (chip->lfo_out2_b >> 8) & 255;
+        }
+    }
+
+    if ((cycles & 15) == 14)
+    {
+        chip->lfo_bit_counter++;
+    }
+    if ((cycles & 15) != 12 && chip->lfo_counter1_of2)
+    {
+        chip->lfo_bit_counter = 0;
+    }
+    chip->lfo_counter1_of2 = chip->lfo_counter1 == 2;
+}
+
+static OPM_INLINE void OPM_DoLFO2(opm_multi_t *chip, uint32_t cycles)
+{
+    opm_vec_t c3 = chip->lfo_counter3;
+    opm_vec_t lo = chip->lfo_freq_lo;
+    opm_vec_t step;
+    chip->lfo_clock_test = chip->lfo_clock;
+    chip->lfo_clock = chip->lfo_counter2_of | chip->lfo_test | chip->lfo_counter3_step;
+    if ((cycles & 15) == 14)
+    {
+        chip->lfo_counter2_of_lock = chip->lfo_counter2_of;
+        chip->lfo_clock_lock = chip->lfo_clock;
+    }
+    /* Step on the lowest clear bit of counter3 */
+    step = OPM_VSEL((c3 >> 3) & 1, vzero, lo & 1);
+    step = OPM_VSEL((c3 >> 2) & 1, step, (lo >> 1) & 1);
+    step = OPM_VSEL((c3 >> 1) & 1, step, (lo >> 2) & 1);
+    step = OPM_VSEL(c3 & 1, step, (lo >> 3) & 1);
+    chip->lfo_counter3_step = step & chip->lfo_counter3_clock;
+    chip->lfo_test = chip->mode_test[2];
+}
+
+static OPM_INLINE void OPM_CSM(opm_multi_t *chip, uint32_t cycles)
+{
+    chip->kon_csm = chip->kon_csm_lock;
+    if (cycles == 1)
+    {
+        chip->kon_csm_lock = chip->timer_a_do_load & chip->mode_csm;
+    }
+}
+
+static OPM_INLINE void OPM_NoiseChannel(opm_multi_t *chip, uint32_t cycles)
+{
+    opm_vec_t mix;
+    chip->nc_active |= chip->eg_serial_bit & 1;
+    if (cycles == 13)
+    {
+        chip->nc_active = vzero;
+    }
+    chip->nc_out <<= 1;
+    chip->nc_out |= chip->nc_sign ^ chip->eg_serial_bit;
+    chip->nc_out &= 0xffff;
+    chip->nc_sign = chip->nc_sign_lock ^ 1;
+    if (cycles == 12)
+    {
+        chip->nc_active_lock = chip->nc_active;
+        chip->nc_sign_lock2 = chip->nc_active_lock & (chip->nc_sign_lock ^ 1);
+        chip->nc_sign_lock = chip->noise_lfsr & 1;
+
+        mix = (chip->nc_out & ~1u) << 2;
+        mix |= (uint32_t)-4089 & -chip->nc_sign_lock2;
+        chip->op_mix = OPM_VSEL(chip->noise_en, OPM_VS16(mix), chip->op_mix);
+    }
+}
+
+static OPM_INLINE void OPM_DoIO(opm_multi_t *chip)
+{
+    // Busy
+    chip->write_busy_cnt += chip->write_busy;
+    chip->write_busy = (OPM_VB((chip->write_busy_cnt >> 5) == 0) & chip->write_busy & OPM_VSplat(!chip->ic)) | chip->write_d_en;
+    chip->write_busy_cnt &= 0x1f;
+    if (chip->ic)
+    {
+        chip->write_busy_cnt = vzero;
+    }
+    // Write signal check
+    chip->write_a_en = chip->write_a;
+    chip->write_d_en = chip->write_d;
+    chip->write_a = vzero;
+    chip->write_d = vzero;
+}
+
+static OPM_INLINE void OPM_DoRegWrite(opm_multi_t *chip, uint32_t cycles)
+{
+    int32_t i;
+    uint32_t channel = cycles % 8;
+    uint32_t slot = cycles;
+    opm_vec_t data, addr, m, sel;
+
+    // Register write
+    if (OPM_VAny(chip->reg_data_ready))
+    {
+        data = chip->reg_data;
+        addr = chip->reg_address;
+        // Channel
+        m = chip->reg_data_ready & OPM_VB((addr & 0xe7) == (0x20 | channel));
+        if (OPM_VAny(m))
+        {
+            sel = m & OPM_VB((addr & 0x18) == 0x00); // RL, FB, CONNECT
+            chip->ch_rl[channel] = OPM_VSEL(sel, data >> 6, chip->ch_rl[channel]);
+            chip->ch_fb[channel] = OPM_VSEL(sel, (data >> 3) & 0x07, chip->ch_fb[channel]);
+            chip->ch_connect[channel] = OPM_VSEL(sel, data & 0x07, chip->ch_connect[channel]);
+            sel = m & OPM_VB((addr & 0x18) == 0x08); // KC
+            chip->ch_kc[channel] = OPM_VSEL(sel, data & 0x7f, chip->ch_kc[channel]);
+            sel = m & OPM_VB((addr & 0x18) == 0x10); // KF
+            chip->ch_kf[channel] = OPM_VSEL(sel, data >> 2, chip->ch_kf[channel]);
+            sel = m & OPM_VB((addr & 0x18) == 0x18); // PMS, AMS
+            chip->ch_pms[channel] = OPM_VSEL(sel, (data >> 4) & 0x07, chip->ch_pms[channel]);
+            chip->ch_ams[channel] = OPM_VSEL(sel, data & 0x03, chip->ch_ams[channel]);
+        }
+        // Slot
+        m = chip->reg_data_ready & OPM_VB((addr & 0x1f) == slot);
+        if (OPM_VAny(m))
+        {
+            sel = m & OPM_VB((addr & 0xe0) == 0x40); // DT1, MUL
+            chip->sl_dt1[slot] = OPM_VSEL(sel, (data >> 4) & 0x07, chip->sl_dt1[slot]);
+            chip->sl_mul[slot] = OPM_VSEL(sel, data & 0x0f, chip->sl_mul[slot]);
+            sel = m & OPM_VB((addr & 0xe0) == 0x60); // TL
+            chip->sl_tl[slot] = OPM_VSEL(sel, data & 0x7f, chip->sl_tl[slot]);
+            sel = m & OPM_VB((addr & 0xe0) == 0x80); // KS, AR
+            chip->sl_ks[slot] = OPM_VSEL(sel, data >> 6, chip->sl_ks[slot]);
+            chip->sl_ar[slot] = OPM_VSEL(sel, data & 0x1f, chip->sl_ar[slot]);
+            sel = m & OPM_VB((addr & 0xe0) == 0xa0); // AMS-EN, D1R
+            chip->sl_am_e[slot] = OPM_VSEL(sel, data >> 7, chip->sl_am_e[slot]);
+            chip->sl_d1r[slot] = OPM_VSEL(sel, data & 0x1f, chip->sl_d1r[slot]);
+            sel = m & OPM_VB((addr & 0xe0) == 0xc0); // DT2, D2R
+            chip->sl_dt2[slot] = OPM_VSEL(sel, data >> 6, chip->sl_dt2[slot]);
+            chip->sl_d2r[slot] = OPM_VSEL(sel, data & 0x1f, chip->sl_d2r[slot]);
+            sel = m & OPM_VB((addr & 0xe0) == 0xe0); // D1L, RR
+            chip->sl_d1l[slot] = OPM_VSEL(sel, data >> 4, chip->sl_d1l[slot]);
+            chip->sl_rr[slot] = OPM_VSEL(sel, data & 0x0f, chip->sl_rr[slot]);
+        }
+    }
+
+    if (!OPM_VAny(chip->write_d_en | chip->write_a_en))
+    {
+        return;
+    }
+    data = chip->write_data;
+
+    // Mode write
+    addr = chip->mode_address;
+    m = chip->write_d_en;
+    sel = m & OPM_VB(addr == 0x01);
+    for (i = 0; i < 8; i++)
+    {
+        chip->mode_test[i] = OPM_VSEL(sel, (data >> i) & 0x01, chip->mode_test[i]);
+    }
+    sel = m & OPM_VB(addr == 0x08);
+    for (i = 0; i < 4; i++)
+    {
+        chip->mode_kon_operator[i] = OPM_VSEL(sel, (data >> (i + 3)) & 0x01, chip->mode_kon_operator[i]);
+    }
+    chip->mode_kon_channel = OPM_VSEL(sel, data & 0x07, chip->mode_kon_channel);
+    sel = m & OPM_VB(addr == 0x0f);
+    chip->noise_en = OPM_VSEL(sel, data >> 7, chip->noise_en);
+    chip->noise_freq = OPM_VSEL(sel, data & 0x1f, chip->noise_freq);
+    sel = m & OPM_VB(addr == 0x10);
+    chip->timer_a_reg = OPM_VSEL(sel, (chip->timer_a_reg & 0x03) | (data << 2), chip->timer_a_reg);
+    sel = m & OPM_VB(addr == 0x11);
+    chip->timer_a_reg = OPM_VSEL(sel, (chip->timer_a_reg & 0x3fc) | (data & 0x03), chip->timer_a_reg);
+    sel = m & OPM_VB(addr == 0x12);
+    chip->timer_b_reg = OPM_VSEL(sel, data, chip->timer_b_reg);
+    sel = m & OPM_VB(addr == 0x14);
+    chip->mode_csm = OPM_VSEL(sel, (data >> 7) & 1, chip->mode_csm);
+    chip->timer_irqb = OPM_VSEL(sel, (data >> 3) & 1, chip->timer_irqb);
+    chip->timer_irqa = OPM_VSEL(sel, (data >> 2) & 1, chip->timer_irqa);
+    chip->timer_resetb = OPM_VSEL(sel, (data >> 5) & 1, chip->timer_resetb);
+    chip->timer_reseta = OPM_VSEL(sel, (data >> 4) & 1, chip->timer_reseta);
+    chip->timer_loadb = OPM_VSEL(sel, (data >> 1) & 1, chip->timer_loadb);
+    chip->timer_loada = OPM_VSEL(sel, (data >> 0) & 1, chip->timer_loada);
+    sel = m & OPM_VB(addr == 0x18);
+    chip->lfo_freq_hi = OPM_VSEL(sel, data >> 4, chip->lfo_freq_hi);
+    chip->lfo_freq_lo = OPM_VSEL(sel, data & 0x0f, chip->lfo_freq_lo);
+    chip->lfo_frq_update |= sel;
+    sel = m & OPM_VB(addr == 0x19);
+    chip->lfo_pmd = OPM_VSEL(sel & (data >> 7), data & 0x7f, chip->lfo_pmd);
+    chip->lfo_amd = OPM_VSEL(sel & ((data >> 7) ^ 1), data, chip->lfo_amd);
+    sel = m & OPM_VB(addr == 0x1b);
+    chip->lfo_wave = OPM_VSEL(sel, data & 0x03, chip->lfo_wave);
+    chip->io_ct1 = OPM_VSEL(sel, (data >> 6) & 0x01, chip->io_ct1);
+    chip->io_ct2 = OPM_VSEL(sel, data >> 7, chip->io_ct2);
+
+    // Register data write
+    chip->reg_data_ready &= chip->write_a_en ^ 1;
+    m = chip->reg_address_ready & chip->write_d_en;
+    chip->reg_data = OPM_VSEL(m, data, chip->reg_data);
+    chip->reg_data_ready |= m;
+
+    // Register address write
+    chip->reg_address_ready &= chip->write_a_en ^ 1;
+    m = chip->write_a_en & OPM_VNZ(data & 0xe0);
+    chip->reg_address = OPM_VSEL(m, data, chip->reg_address);
+    chip->reg_address_ready |= m;
+    chip->mode_address = OPM_VSEL(chip->write_a_en, data, chip->mode_address);
+}
+
+static OPM_INLINE void OPM_DoIC(opm_multi_t *chip, uint32_t cycles)
+{
+    uint32_t channel = cycles % 8;
+    uint32_t slot = cycles;
+    uint32_t i;
+    if (chip->ic)
+    {
+        chip->ch_rl[channel] = vzero;
+        chip->ch_fb[channel] = vzero;
+        chip->ch_connect[channel] = vzero;
+        chip->ch_kc[channel] = vzero;
+        chip->ch_kf[channel] = vzero;
+        chip->ch_pms[channel] = vzero;
+        chip->ch_ams[channel] = vzero;
+
+        chip->sl_dt1[slot] = vzero;
+        chip->sl_mul[slot] = vzero;
+        chip->sl_tl[slot] = vzero;
+        chip->sl_ks[slot] = vzero;
+        chip->sl_ar[slot] = vzero;
+        chip->sl_am_e[slot] = vzero;
+        chip->sl_d1r[slot] = vzero;
+        chip->sl_dt2[slot] = vzero;
+        chip->sl_d2r[slot] = vzero;
+        chip->sl_d1l[slot] = vzero;
+        chip->sl_rr[slot] = vzero;
+
+        chip->timer_a_reg = vzero;
+        chip->timer_b_reg = vzero;
+        chip->timer_irqa = vzero;
+        chip->timer_irqb = vzero;
+        chip->timer_loada = vzero;
+        chip->timer_loadb = vzero;
+        chip->mode_csm = vzero;
+
+        for (i = 0; i < 8; i++)
+        {
+            chip->mode_test[i] = vzero;
+        }
+        chip->noise_en = vzero;
+        chip->noise_freq = vzero;
+
+        chip->mode_kon_channel = vzero;
+        for (i = 0; i < 4; i++)
+        {
+            chip->mode_kon_operator[i] = vzero;
+        }
+        chip->mode_kon[(slot + 8) % 32] = vzero;
+
+        chip->lfo_pmd = vzero;
+        chip->lfo_amd = vzero;
+        chip->lfo_wave = vzero;
+        chip->lfo_freq_hi = vzero;
+        chip->lfo_freq_lo = vzero;
+
+        chip->io_ct1 = vzero;
+        chip->io_ct2 = vzero;
+
+        chip->reg_address = vzero;
+        chip->reg_data = vzero;
+    }
+    chip->ic2 = chip->ic;
+}
+
+static OPM_INLINE void OPM_ClockStages(opm_multi_t *chip, uint32_t cycles)
+{
+    OPM_Mixer2(chip, cycles);
+    OPM_Mixer(chip, cycles);
+
+    OPM_OperatorPhase16(chip, cycles);
+    OPM_OperatorPhase15(chip, cycles);
+    OPM_OperatorPhase14(chip, cycles);
+    OPM_OperatorPhase13(chip, cycles);
+    OPM_OperatorPhase12(chip);
+    OPM_OperatorPhase11(chip);
+    OPM_OperatorPhase10(chip);
+    OPM_OperatorPhase9(chip);
+    OPM_OperatorPhase8(chip);
+    OPM_OperatorPhase7(chip);
+    OPM_OperatorPhase6(chip);
+    OPM_OperatorPhase5(chip);
+    OPM_OperatorPhase4(chip);
+    OPM_OperatorPhase3(chip);
+    OPM_OperatorPhase2(chip);
+    OPM_OperatorPhase1(chip, cycles);
+    OPM_OperatorCounter(chip, cycles);
+
+    OPM_EnvelopeTimer(chip, cycles);
+    OPM_EnvelopePhase6(chip, cycles);
+    OPM_EnvelopePhase5(chip, cycles);
+    OPM_EnvelopePhase4(chip, cycles);
+    OPM_EnvelopePhase3(chip, cycles);
+    OPM_EnvelopePhase2(chip, cycles);
+    OPM_EnvelopePhase1(chip, cycles);
+
+    OPM_PhaseDebug(chip, cycles);
+    OPM_PhaseGenerate(chip, cycles);
+    OPM_PhaseCalcIncrement(chip, cycles);
+    OPM_PhaseCalcFNumBlock(chip, cycles);
+
+    OPM_DoTimerIRQ(chip);
+    OPM_DoTimerA(chip);
+    OPM_DoTimerB(chip, cycles);
+    OPM_DoLFOMult(chip, cycles);
+    OPM_DoLFO1(chip, cycles);
+    OPM_Noise(chip);
+    OPM_KeyOn2(chip, cycles);
+    OPM_DoRegWrite(chip, cycles);
+    OPM_EnvelopeClock(chip, cycles);
+    OPM_NoiseTimer(chip, cycles);
+    OPM_KeyOn1(chip, cycles);
+    OPM_DoIO(chip);
+    OPM_DoTimerA2(chip, cycles);
+    OPM_DoTimerB2(chip);
+    OPM_DoLFO2(chip, cycles);
+    OPM_CSM(chip, cycles);
+    OPM_NoiseChannel(chip, cycles);
+    OPM_Output(chip, cycles);
+    OPM_DAC(chip);
+    OPM_DoIC(chip, cycles);
+}
+
+static void OPM_ClockCycle(opm_multi_t *chip)
+{
+    OPM_ClockStages(chip, chip->cycles);
+    chip->cycles = (chip->cycles + 1) % 32;
+}
+
+/* One full 32-cycle round starting at cycle 0 */
+static void OPM_ClockRound(opm_multi_t *chip)
+{
+    uint32_t cycles;
+    for (cycles = 0; cycles < 32; cycles++)
+    {
+        OPM_ClockStages(chip, cycles);
+    }
+}
+
+/* Advance n cycles, using whole rounds once the chips reach cycle 0 */
+static void OPM_MultiClockCycles(opm_multi_t *chip, uint32_t n)
+{
+    while (n && chip->cycles != 0)
+    {
+        OPM_ClockCycle(chip);
+        n--;
+    }
+    while (n >= 32)
+    {
+        OPM_ClockRound(chip);
+        n -= 32;
+    }
+    while (n)
+    {
+        OPM_ClockCycle(chip);
+        n--;
+    }
+}
+
+void OPM_MultiClock(opm_multi_t *chip, int32_t *output)
+{
+    int i;
+    OPM_ClockCycle(chip);
+    if (output)
+    {
+        for (i = 0; i < OPM_MULTI_LANES; i++)
+        {
+            output[i * 2] = (int32_t)chip->dac_output[0][i];
+            output[i * 2 + 1] = (int32_t)chip->dac_output[1][i];
+        }
+    }
+}
+
+void OPM_MultiRenderSamples(opm_multi_t *chip, int32_t *const *buffers, uint32_t num_samples)
+{
+    uint32_t n;
+    int i;
+    for (n = 0; n < num_samples; n++)
+    {
+        OPM_MultiClockCycles(chip, OPM_CYCLES_PER_SAMPLE);
+        for (i = 0; i < OPM_MULTI_LANES; i++)
+        {
+            buffers[i][n * 2] = (int32_t)chip->dac_output[0][i];
+            buffers[i][n * 2 + 1] = (int32_t)chip->dac_output[1][i];
+        }
+    }
+}
+
+void OPM_MultiWrite(opm_multi_t *chip, uint32_t lane, uint32_t port, uint8_t data)
+{
+    chip->write_data[lane] = data;
+    if (chip->ic)
+    {
+        return;
+    }
+    if (port & 0x01)
+    {
+        chip->write_d[lane] = 1;
+    }
+    else
+    {
+        chip->write_a[lane] = 1;
+    }
+}
+
+uint8_t OPM_MultiRead(opm_multi_t *chip, uint32_t lane, uint32_t port)
+{
+    uint16_t testdata;
+    (void)port;
+    if (chip->mode_test[6][lane])
+    {
+        testdata = chip->op_out[5][lane] | ((chip->eg_serial_bit[lane] ^ 1) << 14) | ((chip->pg_serial[lane] & 1) << 15);
+        if (chip->mode_test[7][lane])
+        {
+            return testdata & 255;
+        }
+        else
+        {
+            return testdata >> 8;
+        }
+    }
+    return (chip->write_busy[lane] << 7) | (chip->timer_b_status[lane] << 1) | chip->timer_a_status[lane];
+}
+
+void OPM_MultiSetIC(opm_multi_t *chip, uint8_t ic)
+{
+    if (chip->ic != ic)
+    {
+        chip->ic = ic;
+        if (!ic)
+        {
+            chip->cycles = 0;
+        }
+    }
+}
+
+void OPM_MultiReset(opm_multi_t *chip)
+{
+    uint32_t i;
+    memset(chip, 0, sizeof(opm_multi_t));
+    OPM_MultiSetIC(chip, 1);
+    for (i = 0; i < 32 * 64; i++)
+    {
+        OPM_MultiClock(chip, NULL);
+    }
+    OPM_MultiSetIC(chip, 0);
+}
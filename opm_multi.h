@@ -0,0 +1,281 @@
+/* Nuked OPM
+ * Copyright (C) 2022 Nuke.YKT
+ *
+ * This file is part of Nuked OPM.
+ *
+ * Nuked OPM is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * Nuked OPM is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Nuked OPM. If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  Multi-chip Nuked OPM: OPM_MULTI_LANES independent chips clocked in
+ *  lockstep, one SIMD lane per chip (8 lanes with AVX2, 4 with SSE2).
+ *  Every lane produces the same output as its own opm_t driven by
+ *  OPM_Clock with the same writes.
+ *
+ *  The state is opm_t in structure-of-arrays form: each field holds one
+ *  32-bit value per lane. The cycle counter and IC pin are shared, since
+ *  all chips are reset and clocked together, and so is every counter that
+ *  only depends on them (the uint8_t fields below).
+ *
+ *  OPM_MULTI_LANES depends on the target flags, so opm_multi.c and its
+ *  users must be compiled with the same -m options.
+ *
+ *  Requires GCC/Clang vector extensions (zig cc, gcc, clang).
+ */
+#ifndef _OPM_MULTI_H_
+#define _OPM_MULTI_H_
+
+#include <stdint.h>
+#include "opm.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(__AVX2__)
+#define OPM_MULTI_LANES 8
+#else
+#define OPM_MULTI_LANES 4
+#endif
+
+/* One 32-bit value per lane. Aligned to 16 so heap allocations work as is. */
+typedef uint32_t opm_vec_t __attribute__((vector_size(OPM_MULTI_LANES * 4), aligned(16)));
+
+typedef struct {
+    uint32_t cycles;
+    uint8_t ic;
+    uint8_t ic2;
+    // IO
+    opm_vec_t write_data;
+    opm_vec_t write_a;
+    opm_vec_t write_a_en;
+    opm_vec_t write_d;
+    opm_vec_t write_d_en;
+    opm_vec_t write_busy;
+    opm_vec_t write_busy_cnt;
+    opm_vec_t mode_address;
+    opm_vec_t io_ct1;
+    opm_vec_t io_ct2;
+
+    // LFO
+    opm_vec_t lfo_am_lock;
+    opm_vec_t lfo_pm_lock;
+    uint8_t lfo_counter1;
+    uint8_t lfo_counter1_of1;
+    uint8_t lfo_counter1_of2;
+    opm_vec_t lfo_counter2;
+    opm_vec_t lfo_counter2_load;
+    opm_vec_t lfo_counter2_of;
+    opm_vec_t lfo_counter2_of_lock;
+    opm_vec_t lfo_counter2_of_lock2;
+    opm_vec_t lfo_counter3_clock;
+    opm_vec_t lfo_counter3;
+    opm_vec_t lfo_counter3_step;
+    opm_vec_t lfo_frq_update;
+    opm_vec_t lfo_clock;
+    opm_vec_t lfo_clock_lock;
+    opm_vec_t lfo_clock_test;
+    opm_vec_t lfo_test;
+    opm_vec_t lfo_val;
+    opm_vec_t lfo_val_carry;
+    opm_vec_t lfo_out1;
+    opm_vec_t lfo_out2;
+    opm_vec_t lfo_out2_b;
+    opm_vec_t lfo_mult_carry;
+    opm_vec_t lfo_trig_sign;
+    opm_vec_t lfo_saw_sign;
+    uint8_t lfo_bit_counter;
+
+    // Env Gen
+    opm_vec_t eg_state[32];
+    opm_vec_t eg_level[32];
+    opm_vec_t eg_rate[2];
+    opm_vec_t eg_sl[2];
+    opm_vec_t eg_tl[3];
+    opm_vec_t eg_zr[2];
+    opm_vec_t eg_timershift_lock;
+    opm_vec_t eg_timer_lock;
+    opm_vec_t eg_inchi;
+    opm_vec_t eg_shift;
+    opm_vec_t eg_clock;
+    uint8_t eg_clockcnt;
+    opm_vec_t eg_inc;
+    opm_vec_t eg_ratemax[2];
+    opm_vec_t eg_instantattack;
+    opm_vec_t eg_inclinear;
+    opm_vec_t eg_incattack;
+    opm_vec_t eg_mute;
+    opm_vec_t eg_outtemp[2];
+    opm_vec_t eg_out[2];
+    opm_vec_t eg_am;
+    opm_vec_t eg_timercarry;
+    opm_vec_t eg_timer;
+    opm_vec_t eg_timer2;
+    opm_vec_t eg_timerbstop;
+    opm_vec_t eg_serial;
+    opm_vec_t eg_serial_bit;
+    opm_vec_t eg_test;
+
+    // Phase Gen
+    opm_vec_t pg_fnum[32];
+    opm_vec_t pg_kcode[32];
+    opm_vec_t pg_inc[32];
+    opm_vec_t pg_phase[32];
+    opm_vec_t pg_reset[32];
+    opm_vec_t pg_reset_latch[32];
+    opm_vec_t pg_serial;
+
+    // Operator (int16_t fields are kept sign-extended)
+    opm_vec_t op_phase_in;
+    opm_vec_t op_mod_in;
+    opm_vec_t op_phase;
+    opm_vec_t op_logsin[3];
+    opm_vec_t op_atten;
+    opm_vec_t op_exp[2];
+    opm_vec_t op_pow[2];
+    opm_vec_t op_sign;
+    opm_vec_t op_out[6];
+    opm_vec_t op_connect;
+    uint8_t op_counter;
+    uint8_t op_fbupdate;
+    uint8_t op_fbshift;
+    uint8_t op_c1update;
+    opm_vec_t op_modtable[5];
+    opm_vec_t op_m1[8][2];
+    opm_vec_t op_c1[8];
+    opm_vec_t op_mod[3];
+    opm_vec_t op_fb[2];
+    opm_vec_t op_mixl;
+    opm_vec_t op_mixr;
+
+    // Mixer
+    opm_vec_t mix[2];
+    opm_vec_t mix2[2];
+    opm_vec_t mix_serial[2];
+    opm_vec_t mix_bits;
+    opm_vec_t mix_top_bits_lock;
+    opm_vec_t mix_sign_lock;
+    opm_vec_t mix_sign_lock2;
+    opm_vec_t mix_exp_lock;
+    opm_vec_t mix_clamp_low[2];
+    opm_vec_t mix_clamp_high[2];
+    opm_vec_t mix_out_bit;
+
+    // Output
+    opm_vec_t smp_so;
+    uint8_t smp_sh1;
+    uint8_t smp_sh2;
+
+    // Noise
+    opm_vec_t noise_lfsr;
+    opm_vec_t noise_timer;
+    opm_vec_t noise_timer_of;
+    opm_vec_t noise_update;
+    opm_vec_t noise_temp;
+
+    // Register set
+    opm_vec_t mode_test[8];
+    opm_vec_t mode_kon_operator[4];
+    opm_vec_t mode_kon_channel;
+
+    opm_vec_t reg_address;
+    opm_vec_t reg_address_ready;
+    opm_vec_t reg_data;
+    opm_vec_t reg_data_ready;
+
+    opm_vec_t ch_rl[8];
+    opm_vec_t ch_fb[8];
+    opm_vec_t ch_connect[8];
+    opm_vec_t ch_kc[8];
+    opm_vec_t ch_kf[8];
+    opm_vec_t ch_pms[8];
+    opm_vec_t ch_ams[8];
+
+    opm_vec_t sl_dt1[32];
+    opm_vec_t sl_mul[32];
+    opm_vec_t sl_tl[32];
+    opm_vec_t sl_ks[32];
+    opm_vec_t sl_ar[32];
+    opm_vec_t sl_am_e[32];
+    opm_vec_t sl_d1r[32];
+    opm_vec_t sl_dt2[32];
+    opm_vec_t sl_d2r[32];
+    opm_vec_t sl_d1l[32];
+    opm_vec_t sl_rr[32];
+
+    opm_vec_t noise_en;
+    opm_vec_t noise_freq;
+
+    // Timer
+    opm_vec_t timer_a_reg;
+    opm_vec_t timer_b_reg;
+    opm_vec_t timer_a_temp;
+    opm_vec_t timer_a_do_reset, timer_a_do_load;
+    opm_vec_t timer_a_inc;
+    opm_vec_t timer_a_val;
+    opm_vec_t timer_a_of;
+    opm_vec_t timer_a_load;
+    opm_vec_t timer_a_status;
+
+    uint8_t timer_b_sub;
+    uint8_t timer_b_sub_of;
+    opm_vec_t timer_b_inc;
+    opm_vec_t timer_b_val;
+    opm_vec_t timer_b_of;
+    opm_vec_t timer_b_do_reset, timer_b_do_load;
+    opm_vec_t timer_b_temp;
+    opm_vec_t timer_b_status;
+    opm_vec_t timer_irq;
+
+    opm_vec_t lfo_freq_hi;
+    opm_vec_t lfo_freq_lo;
+    opm_vec_t lfo_pmd;
+    opm_vec_t lfo_amd;
+    opm_vec_t lfo_wave;
+
+    opm_vec_t timer_irqa, timer_irqb;
+    opm_vec_t timer_loada, timer_loadb;
+    opm_vec_t timer_reseta, timer_resetb;
+    opm_vec_t mode_csm;
+
+    opm_vec_t nc_active, nc_active_lock, nc_sign, nc_sign_lock, nc_sign_lock2;
+    opm_vec_t nc_out;
+    opm_vec_t op_mix;
+
+    opm_vec_t kon_csm, kon_csm_lock;
+    opm_vec_t kon_chanmatch;
+    opm_vec_t kon[32];
+    opm_vec_t kon2[32];
+    opm_vec_t mode_kon[32];
+
+    // DAC
+    uint8_t dac_osh1, dac_osh2;
+    opm_vec_t dac_bits;
+    opm_vec_t dac_output[2];
+} opm_multi_t;
+
+/* Clock every lane one cycle. output (optional) receives OPM_MULTI_LANES
+ * interleaved stereo pairs, like OPM_Clock's output for each chip. */
+void OPM_MultiClock(opm_multi_t *chip, int32_t *output);
+/* Render num_samples stereo samples per lane, OPM_CYCLES_PER_SAMPLE cycles each.
+ * buffers[lane] receives that lane's interleaved L/R samples. */
+void OPM_MultiRenderSamples(opm_multi_t *chip, int32_t *const *buffers, uint32_t num_samples);
+void OPM_MultiWrite(opm_multi_t *chip, uint32_t lane, uint32_t port, uint8_t data);
+uint8_t OPM_MultiRead(opm_multi_t *chip, uint32_t lane, uint32_t port);
+void OPM_MultiSetIC(opm_multi_t *chip, uint8_t ic);
+void OPM_MultiReset(opm_multi_t *chip);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif
@@ -0,0 +1,326 @@
+/* Nuked OPM
+ * Copyright (C) 2022 Nuke.YKT
+ *
+ * This file is part of Nuked OPM.
+ *
+ * Nuked OPM is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * Nuked OPM is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Nuked OPM. If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  Fixed-ratio polyphase FIR resampler. See opm_resample.h.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include "opm_resample.h"
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#define OPM_RESAMPLE_MAX_PHASES 512  /* 128 KB of coefficients at most */
+#define OPM_RESAMPLE_MIN_CAPACITY 1024 /* Input frames; grown on demand */
+#define OPM_RESAMPLE_KAISER_BETA 9.5  /* ~95 dB stopband */
+#define OPM_PI 3.14159265358979323846
+
+static uint32_t OPM_Gcd(uint32_t a, uint32_t b)
+{
+    while (b)
+    {
+        uint32_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+/* Closest step/phases to in_rate/out_rate with at most max_phases phases,
+ * from the continued fraction convergents and their best semiconvergent.
+ * The device rates used here come within 10 ppm at 512 phases. */
+static void OPM_ResamplerRatio(opm_resampler_t *resampler, uint32_t in_rate, uint32_t out_rate, uint32_t max_phases)
+{
+    uint64_t p0 = 0, q0 = 1, p1 = 1, q1 = 0;
+    uint64_t n = in_rate, d = out_rate;
+    uint64_t k;
+    while (d)
+    {
+        uint64_t a = n / d;
+        uint64_t q2 = q0 + a * q1;
+        uint64_t t;
+        if (q2 > max_phases)
+        {
+            break;
+        }
+        t = p0 + a * p1;
+        p0 = p1;
+        q0 = q1;
+        p1 = t;
+        q1 = q2;
+        t = n - a * d;
+        n = d;
+        d = t;
+    }
+    if (d)
+    {
+        /* Ran out of phases: take the semiconvergent if it is closer */
+        k = (max_phases - q0) / q1;
+        uint64_t ps = p0 + k * p1, qs = q0 + k * q1;
+        /* |ps/qs - in/out| < |p1/q1 - in/out|, cross-multiplied */
+        double es = fabs((double)ps * out_rate - (double)in_rate * qs) / qs;
+        double e1 = fabs((double)p1 * out_rate - (double)in_rate * q1) / q1;
+        if (es < e1)
+        {
+            p1 = ps;
+            q1 = qs;
+        }
+    }
+    resampler->step = (uint32_t)p1;
+    resampler->phases = (uint32_t)q1;
+}
+
+/* Zeroth-order modified Bessel function of the first kind */
+static double OPM_BesselI0(double x)
+{
+    double sum = 1.0, term = 1.0;
+    int k;
+    for (k = 1; k < 50 && term > sum * 1e-12; k++)
+    {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+int OPM_ResamplerInit(opm_resampler_t *resampler, uint32_t in_rate, uint32_t out_rate)
+{
+    const int half = OPM_RESAMPLE_TAPS / 2;
+    uint32_t g;
+    uint32_t k;
+    int t;
+
+    memset(resampler, 0, sizeof(*resampler));
+    if (in_rate == 0 || out_rate == 0)
+    {
+        return 0;
+    }
+    g = OPM_Gcd(in_rate, out_rate);
+    resampler->in_rate = in_rate;
+    resampler->out_rate = out_rate;
+    resampler->phases = out_rate / g;
+    resampler->step = in_rate / g;
+    if (resampler->phases > OPM_RESAMPLE_MAX_PHASES)
+    {
+        OPM_ResamplerRatio(resampler, resampler->step, resampler->phases, OPM_RESAMPLE_MAX_PHASES);
+    }
+    resampler->capacity = OPM_RESAMPLE_MIN_CAPACITY;
+    resampler->coeffs = (float *)malloc((size_t)resampler->phases * OPM_RESAMPLE_TAPS * sizeof(float));
+    resampler->input[0] = (float *)malloc(resampler->capacity * sizeof(float));
+    resampler->input[1] = (float *)malloc(resampler->capacity * sizeof(float));
+    if (!resampler->coeffs || !resampler->input[0] || !resampler->input[1])
+    {
+        OPM_ResamplerFree(resampler);
+        return 0;
+    }
+
+    /* Kaiser transition width (in input-rate cycles per sample) for the
+     * window's stopband attenuation. The stopband starts at the lower of the
+     * two Nyquist rates, so nothing aliases. Far below the input rate the
+     * transition would not fit under it, so the cutoff stays above 0. */
+    double attenuation = OPM_RESAMPLE_KAISER_BETA / 0.1102 + 8.7;
+    double transition = (attenuation - 7.95) / (14.36 * OPM_RESAMPLE_TAPS);
+    double stop = (double)out_rate / (2.0 * in_rate);
+    stop = stop < 0.5 ? stop : 0.5;
+    double cutoff = stop - transition / 2;
+    cutoff = cutoff > stop / 2 ? cutoff : stop / 2;
+    double i0_beta = OPM_BesselI0(OPM_RESAMPLE_KAISER_BETA);
+
+    /* Rows are stored in the order outputs use them (output k of each ratio
+     * period has phase k * step mod phases), so the table is read linearly */
+    for (k = 0; k < resampler->phases; k++)
+    {
+        uint32_t p = (uint32_t)(((uint64_t)k * resampler->step) % resampler->phases);
+        float *row = resampler->coeffs + (size_t)k * OPM_RESAMPLE_TAPS;
+
+        /* Output of phase p sits p/phases input samples after tap half - 1 */
+        double offset = (double)p / resampler->phases;
+        double sum = 0.0;
+        for (t = 0; t < OPM_RESAMPLE_TAPS; t++)
+        {
+            double x = t - (half - 1) - offset;
+            double sinc = x == 0.0 ? 1.0 : sin(2.0 * OPM_PI * cutoff * x) / (2.0 * OPM_PI * cutoff * x);
+            double w = x / half;
+            double window = w >= 1.0 || w <= -1.0 ? 0.0 : OPM_BesselI0(OPM_RESAMPLE_KAISER_BETA * sqrt(1.0 - w * w)) / i0_beta;
+            row[t] = (float)(sinc * window);
+            sum += sinc * window;
+        }
+        /* Unity DC gain in every phase, times 1/2 for the 16-bit level */
+        for (t = 0; t < OPM_RESAMPLE_TAPS; t++)
+        {
+            row[t] = (float)(row[t] * 0.5 / sum);
+        }
+    }
+
+    OPM_ResamplerReset(resampler);
+    return 1;
+}
+
+void OPM_ResamplerFree(opm_resampler_t *resampler)
+{
+    free(resampler->coeffs);
+    free(resampler->input[0]);
+    free(resampler->input[1]);
+    memset(resampler, 0, sizeof(*resampler));
+}
+
+void OPM_ResamplerReset(opm_resampler_t *resampler)
+{
+    /* Start with a window of silence, so output begins at the first input
+     * sample delayed by OPM_RESAMPLE_TAPS / 2 - 1 */
+    memset(resampler->input[0], 0, (OPM_RESAMPLE_TAPS - 1) * sizeof(float));
+    memset(resampler->input[1], 0, (OPM_RESAMPLE_TAPS - 1) * sizeof(float));
+    resampler->buffered = OPM_RESAMPLE_TAPS - 1;
+    resampler->pos = 0;
+    resampler->phase = 0;
+    resampler->row = 0;
+}
+
+uint32_t OPM_ResamplerRequiredInput(const opm_resampler_t *resampler, uint32_t out_frames)
+{
+    uint32_t buffered = resampler->buffered;
+    if (out_frames == 0)
+    {
+        return 0;
+    }
+    uint64_t last = resampler->pos + (resampler->phase + (uint64_t)(out_frames - 1) * resampler->step) / resampler->phases;
+    uint64_t end = last + OPM_RESAMPLE_TAPS;
+    return end > buffered ? (uint32_t)(end - buffered) : 0;
+}
+
+static int OPM_ResamplerReserve(opm_resampler_t *resampler, uint32_t frames)
+{
+    float *left, *right;
+    if (frames <= resampler->capacity)
+    {
+        return 1;
+    }
+    left = (float *)realloc(resampler->input[0], frames * sizeof(float));
+    if (left)
+    {
+        resampler->input[0] = left;
+    }
+    right = (float *)realloc(resampler->input[1], frames * sizeof(float));
+    if (right)
+    {
+        resampler->input[1] = right;
+    }
+    if (!left || !right)
+    {
+        return 0;
+    }
+    resampler->capacity = frames;
+    return 1;
+}
+
+static inline float OPM_Dot(const float *x, const float *h)
+{
+    int t = 0;
+    float sum;
+#if defined(__AVX2__)
+    __m256 acc = _mm256_setzero_ps();
+    for (; t < OPM_RESAMPLE_TAPS; t += 8)
+    {
+        acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_loadu_ps(x + t), _mm256_loadu_ps(h + t)));
+    }
+    __m128 acc4 = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+#elif defined(__SSE2__)
+    __m128 acc4 = _mm_setzero_ps();
+    for (; t < OPM_RESAMPLE_TAPS; t += 4)
+    {
+        acc4 = _mm_add_ps(acc4, _mm_mul_ps(_mm_loadu_ps(x + t), _mm_loadu_ps(h + t)));
+    }
+#endif
+#if defined(__AVX2__) || defined(__SSE2__)
+    acc4 = _mm_add_ps(acc4, _mm_movehl_ps(acc4, acc4));
+    acc4 = _mm_add_ss(acc4, _mm_shuffle_ps(acc4, acc4, 1));
+    sum = _mm_cvtss_f32(acc4);
+#else
+    float acc[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    for (; t < OPM_RESAMPLE_TAPS; t += 4)
+    {
+        acc[0] += x[t] * h[t];
+        acc[1] += x[t + 1] * h[t + 1];
+        acc[2] += x[t + 2] * h[t + 2];
+        acc[3] += x[t + 3] * h[t + 3];
+    }
+    sum = (acc[0] + acc[2]) + (acc[1] + acc[3]);
+#endif
+    return sum;
+}
+
+static inline int16_t OPM_RoundS16(float x)
+{
+    x += x < 0.0f ? -0.5f : 0.5f;
+    return (int16_t)(x > 32767.0f ? 32767 : x < -32768.0f ? -32768 : (int32_t)x);
+}
+
+uint32_t OPM_ResamplerProcess(opm_resampler_t *resampler, const int32_t *in, uint32_t in_frames,
+                              int16_t *out, uint32_t out_frames)
+{
+    uint32_t i, n = 0;
+    uint32_t step_int = resampler->step / resampler->phases;
+    uint32_t step_frac = resampler->step % resampler->phases;
+
+    if (!OPM_ResamplerReserve(resampler, resampler->buffered + in_frames))
+    {
+        return 0;
+    }
+
+    /* Append the input as planar float */
+    float *left = resampler->input[0] + resampler->buffered;
+    float *right = resampler->input[1] + resampler->buffered;
+    for (i = 0; i < in_frames; i++)
+    {
+        left[i] = (float)in[i * 2];
+        right[i] = (float)in[i * 2 + 1];
+    }
+    resampler->buffered += in_frames;
+
+    while (n < out_frames && resampler->pos + OPM_RESAMPLE_TAPS <= resampler->buffered)
+    {
+        const float *h = resampler->coeffs + (size_t)resampler->row * OPM_RESAMPLE_TAPS;
+        out[n * 2] = OPM_RoundS16(OPM_Dot(resampler->input[0] + resampler->pos, h));
+        out[n * 2 + 1] = OPM_RoundS16(OPM_Dot(resampler->input[1] + resampler->pos, h));
+        n++;
+
+        /* Advance by step / phases input frames without a division */
+        resampler->pos += step_int;
+        resampler->phase += step_frac;
+        if (resampler->phase >= resampler->phases)
+        {
+            resampler->phase -= resampler->phases;
+            resampler->pos++;
+        }
+        if (++resampler->row == resampler->phases)
+        {
+            resampler->row = 0;
+        }
+    }
+
+    /* Keep only the input from the next window on */
+    uint32_t keep = resampler->pos < resampler->buffered ? resampler->buffered - resampler->pos : 0;
+    memmove(resampler->input[0], resampler->input[0] + resampler->pos, keep * sizeof(float));
+    memmove(resampler->input[1], resampler->input[1] + resampler->pos, keep * sizeof(float));
+    resampler->pos -= resampler->buffered - keep;
+    resampler->buffered = keep;
+    return n;
+}
@@ -0,0 +1,79 @@
+/* Nuked OPM
+ * Copyright (C) 2022 Nuke.YKT
+ *
+ * This file is part of Nuked OPM.
+ *
+ * Nuked OPM is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * Nuked OPM is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Nuked OPM. If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  Fixed-ratio polyphase FIR resampler from the chip sample rate to a
+ *  device rate (48000 or 44100 Hz from 55930 Hz, or whatever the backend
+ *  runs at). The ratio is reduced to out_rate/in_rate = L/M, or approximated
+ *  to within a few ppm when L would exceed 512 phases, and one row of
+ *  OPM_RESAMPLE_TAPS Kaiser-windowed sinc coefficients is precomputed for
+ *  each of the L output phases, so every output frame is two dot products
+ *  over consecutive input samples (SSE2/AVX2 with a scalar fallback). The
+ *  stopband (about 95 dB down) starts at the lower Nyquist rate and the
+ *  transition band is about 5.4 kHz wide below it, so the passband is flat
+ *  to about 18.6 kHz at 48000 Hz and 16.7 kHz at 44100 Hz.
+ *
+ *  Input is chip output (int32, as OPM_RenderSamples); output is int16 at
+ *  the same level as OPM_ConvertS16 (output / 2, saturated).
+ */
+#ifndef _OPM_RESAMPLE_H_
+#define _OPM_RESAMPLE_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Taps per phase (a multiple of 8 for the vector loop) */
+#define OPM_RESAMPLE_TAPS 64
+
+typedef struct {
+    uint32_t in_rate;
+    uint32_t out_rate;
+    uint32_t phases;  /* L: output steps per ratio period */
+    uint32_t step;    /* M: input samples per ratio period */
+    float *coeffs;    /* phases rows of OPM_RESAMPLE_TAPS, in output order, gain 1/2 folded in */
+    float *input[2];  /* Planar input history, left and right */
+    uint32_t capacity; /* Frames allocated per channel in input */
+    uint32_t buffered; /* Valid frames in input */
+    uint32_t pos;      /* First input frame of the next output's window */
+    uint32_t phase;    /* Phase of the next output, 0..phases-1 */
+    uint32_t row;      /* Its coefficient row: outputs since the ratio period began */
+} opm_resampler_t;
+
+/* Set up for in_rate -> out_rate. Returns 0 if out of memory or a rate is 0. */
+int OPM_ResamplerInit(opm_resampler_t *resampler, uint32_t in_rate, uint32_t out_rate);
+void OPM_ResamplerFree(opm_resampler_t *resampler);
+
+/* Drop buffered input and start again from phase 0 */
+void OPM_ResamplerReset(opm_resampler_t *resampler);
+
+/* Input frames needed before OPM_ResamplerProcess can produce out_frames */
+uint32_t OPM_ResamplerRequiredInput(const opm_resampler_t *resampler, uint32_t out_frames);
+
+/* Append in_frames stereo frames and write up to out_frames resampled frames
+ * to out (interleaved). Returns the frames written; input that is not used
+ * yet stays buffered. Returns 0 without consuming input if out of memory. */
+uint32_t OPM_ResamplerProcess(opm_resampler_t *resampler, const int32_t *in, uint32_t in_frames,
+                              int16_t *out, uint32_t out_frames);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,750 @@
+/* Nuked OPM
+ * Copyright (C) 2022 Nuke.YKT
+ *
+ * This file is part of Nuked OPM.
+ *
+ * Nuked OPM is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * Nuked OPM is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Nuked OPM. If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  Nuked OPM ROM tables, shared by opm.c and opm_multi.c.
+ *  Internal header: not part of the public API.
+ */
+#ifndef _OPM_TABLES_H_
+#define _OPM_TABLES_H_
+
+#include <stdint.h>
+
+enum {
+    eg_num_attack = 0,
+    eg_num_decay = 1,
+    eg_num_sustain = 2,
+    eg_num_release = 3
+};
+
+/* logsin table */
+static const uint16_t logsinrom[256] = {
+    0x859, 0x6c3, 0x607, 0x58b, 0x52e, 0x4e4, 0x4a6, 0x471,
+    0x443, 0x41a, 0x3f5, 0x3d3, 0x3b5, 0x398, 0x37e, 0x365,
+    0x34e, 0x339, 0x324, 0x311, 0x2ff, 0x2ed, 0x2dc, 0x2cd,
+    0x2bd, 0x2af, 0x2a0, 0x293, 0x286, 0x279, 0x26d, 0x261,
+    0x256, 0x24b, 0x240, 0x236, 0x22c, 0x222, 0x218, 0x20f,
+    0x206, 0x1fd, 0x1f5, 0x1ec, 0x1e4, 0x1dc, 0x1d4, 0x1cd,
+    0x1c5, 0x1be, 0x1b7, 0x1b0, 0x1a9, 0x1a2, 0x19b, 0x195,
+    0x18f, 0x188, 0x182, 0x17c, 0x177, 0x171, 0x16b, 0x166,
+    0x160, 0x15b, 0x155, 0x150, 0x14b, 0x146, 0x141, 0x13c,
+    0x137, 0x133, 0x12e, 0x129, 0x125, 0x121, 0x11c, 0x118,
+    0x114, 0x10f, 0x10b, 0x107, 0x103, 0x0ff, 0x0fb, 0x0f8,
+    0x0f4, 0x0f0, 0x0ec, 0x0e9, 0x0e5, 0x0e2, 0x0de, 0x0db,
+    0x0d7, 0x0d4, 0x0d1, 0x0cd, 0x0ca, 0x0c7, 0x0c4, 0x0c1,
+    0x0be, 0x0bb, 0x0b8, 0x0b5, 0x0b2, 0x0af, 0x0ac, 0x0a9,
+    0x0a7, 0x0a4, 0x0a1, 0x09f, 0x09c, 0x099, 0x097, 0x094,
+    0x092, 0x08f, 0x08d, 0x08a, 0x088, 0x086, 0x083, 0x081,
+    0x07f, 0x07d, 0x07a, 0x078, 0x076, 0x074, 0x072, 0x070,
+    0x06e, 0x06c, 0x06a, 0x068, 0x066, 0x064, 0x062, 0x060,
+    0x05e, 0x05c, 0x05b, 0x059, 0x057, 0x055, 0x053, 0x052,
+    0x050, 0x04e, 0x04d, 0x04b, 0x04a, 0x048, 0x046, 0x045,
+    0x043, 0x042, 0x040, 0x03f, 0x03e, 0x03c, 0x03b, 0x039,
+    0x038, 0x037, 0x035, 0x034, 0x033, 0x031, 0x030, 0x02f,
+    0x02e, 0x02d, 0x02b, 0x02a, 0x029, 0x028, 0x027, 0x026,
+    0x025, 0x024, 0x023, 0x022, 0x021, 0x020, 0x01f, 0x01e,
+    0x01d, 0x01c, 0x01b, 0x01a, 0x019, 0x018, 0x017, 0x017,
+    0x016, 0x015, 0x014, 0x014, 0x013, 0x012, 0x011, 0x011,
+    0x010, 0x00f, 0x00f, 0x00e, 0x00d, 0x00d, 0x00c, 0x00c,
+    0x00b, 0x00a, 0x00a, 0x009, 0x009, 0x008, 0x008, 0x007,
+    0x007, 0x007, 0x006, 0x006, 0x005, 0x005, 0x005, 0x004,
+    0x004, 0x004, 0x003, 0x003, 0x003, 0x002, 0x002, 0x002,
+    0x002, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000
+};
+
+/* exp table */
+static const uint16_t exprom[256] = {
+    0x7fa, 0x7f5, 0x7ef, 0x7ea, 0x7e4, 0x7df, 0x7da, 0x7d4,
+    0x7cf, 0x7c9, 0x7c4, 0x7bf, 0x7b9, 0x7b4, 0x7ae, 0x7a9,
+    0x7a4, 0x79f, 0x799, 0x794, 0x78f, 0x78a, 0x784, 0x77f,
+    0x77a, 0x775, 0x770, 0x76a, 0x765, 0x760, 0x75b, 0x756,
+    0x751, 0x74c, 0x747, 0x742, 0x73d, 0x738, 0x733, 0x72e,
+    0x729, 0x724, 0x71f, 0x71a, 0x715, 0x710, 0x70b, 0x706,
+    0x702, 0x6fd, 0x6f8, 0x6f3, 0x6ee, 0x6e9, 0x6e5, 0x6e0,
+    0x6db, 0x6d6, 0x6d2, 0x6cd, 0x6c8, 0x6c4, 0x6bf, 0x6ba,
+    0x6b5, 0x6b1, 0x6ac, 0x6a8, 0x6a3, 0x69e, 0x69a, 0x695,
+    0x691, 0x68c, 0x688, 0x683, 0x67f, 0x67a, 0x676, 0x671,
+    0x66d, 0x668, 0x664, 0x65f, 0x65b, 0x657, 0x652, 0x64e,
+    0x649, 0x645, 0x641, 0x63c, 0x638, 0x634, 0x630, 0x62b,
+    0x627, 0x623, 0x61e, 0x61a, 0x616, 0x612, 0x60e, 0x609,
+    0x605, 0x601, 0x5fd, 0x5f9, 0x5f5, 0x5f0, 0x5ec, 0x5e8,
+    0x5e4, 0x5e0, 0x5dc, 0x5d8, 0x5d4, 0x5d0, 0x5cc, 0x5c8,
+    0x5c4, 0x5c0, 0x5bc, 0x5b8, 0x5b4, 0x5b0, 0x5ac, 0x5a8,
+    0x5a4, 0x5a0, 0x59c, 0x599, 0x595, 0x591, 0x58d, 0x589,
+    0x585, 0x581, 0x57e, 0x57a, 0x576, 0x572, 0x56f, 0x56b,
+    0x567, 0x563, 0x560, 0x55c, 0x558, 0x554, 0x551, 0x54d,
+    0x549, 0x546, 0x542, 0x53e, 0x53b, 0x537, 0x534, 0x530,
+    0x52c, 0x529, 0x525, 0x522, 0x51e, 0x51b, 0x517, 0x514,
+    0x510, 0x50c, 0x509, 0x506, 0x502, 0x4ff, 0x4fb, 0x4f8,
+    0x4f4, 0x4f1, 0x4ed, 0x4ea, 0x4e7, 0x4e3, 0x4e0, 0x4dc,
+    0x4d9, 0x4d6, 0x4d2, 0x4cf, 0x4cc, 0x4c8, 0x4c5, 0x4c2,
+    0x4be, 0x4bb, 0x4b8, 0x4b5, 0x4b1, 0x4ae, 0x4ab, 0x4a8,
+    0x4a4, 0x4a1, 0x49e, 0x49b, 0x498, 0x494, 0x491, 0x48e,
+    0x48b, 0x488, 0x485, 0x482, 0x47e, 0x47b, 0x478, 0x475,
+    0x472, 0x46f, 0x46c, 0x469, 0x466, 0x463, 0x460, 0x45d,
+    0x45a, 0x457, 0x454, 0x451, 0x44e, 0x44b, 0x448, 0x445,
+    0x442, 0x43f, 0x43c, 0x439, 0x436, 0x433, 0x430, 0x42d,
+    0x42a, 0x428, 0x425, 0x422, 0x41f, 0x41c, 0x419, 0x416,
+    0x414, 0x411, 0x40e, 0x40b, 0x408, 0x406, 0x403, 0x400
+};
+
+/* attenuation to linear table: (exprom[atten & 255] << 2) >> (atten >> 8) */
+static const uint16_t explinrom[4096] = {
+    0x1fe8, 0x1fd4, 0x1fbc, 0x1fa8, 0x1f90, 0x1f7c, 0x1f68, 0x1f50,
+    0x1f3c, 0x1f24, 0x1f10, 0x1efc, 0x1ee4, 0x1ed0, 0x1eb8, 0x1ea4,
+    0x1e90, 0x1e7c, 0x1e64, 0x1e50, 0x1e3c, 0x1e28, 0x1e10, 0x1dfc,
+    0x1de8, 0x1dd4, 0x1dc0, 0x1da8, 0x1d94, 0x1d80, 0x1d6c, 0x1d58,
+    0x1d44, 0x1d30, 0x1d1c, 0x1d08, 0x1cf4, 0x1ce0, 0x1ccc, 0x1cb8,
+    0x1ca4, 0x1c90, 0x1c7c, 0x1c68, 0x1c54, 0x1c40, 0x1c2c, 0x1c18,
+    0x1c08, 0x1bf4, 0x1be0, 0x1bcc, 0x1bb8, 0x1ba4, 0x1b94, 0x1b80,
+    0x1b6c, 0x1b58, 0x1b48, 0x1b34, 0x1b20, 0x1b10, 0x1afc, 0x1ae8,
+    0x1ad4, 0x1ac4, 0x1ab0, 0x1aa0, 0x1a8c, 0x1a78, 0x1a68, 0x1a54,
+    0x1a44, 0x1a30, 0x1a20, 0x1a0c, 0x19fc, 0x19e8, 0x19d8, 0x19c4,
+    0x19b4, 0x19a0, 0x1990, 0x197c, 0x196c, 0x195c, 0x1948, 0x1938,
+    0x1924, 0x1914, 0x1904, 0x18f0, 0x18e0, 0x18d0, 0x18c0, 0x18ac,
+    0x189c, 0x188c, 0x1878, 0x1868, 0x1858, 0x1848, 0x1838, 0x1824,
+    0x1814, 0x1804, 0x17f4, 0x17e4, 0x17d4, 0x17c0, 0x17b0, 0x17a0,
+    0x1790, 0x1780, 0x1770, 0x1760, 0x1750, 0x1740, 0x1730, 0x1720,
+    0x1710, 0x1700, 0x16f0, 0x16e0, 0x16d0, 0x16c0, 0x16b0, 0x16a0,
+    0x1690, 0x1680, 0x1670, 0x1664, 0x1654, 0x1644, 0x1634, 0x1624,
+    0x1614, 0x1604, 0x15f8, 0x15e8, 0x15d8, 0x15c8, 0x15bc, 0x15ac,
+    0x159c, 0x158c, 0x1580, 0x1570, 0x1560, 0x1550, 0x1544, 0x1534,
+    0x1524, 0x1518, 0x1508, 0x14f8, 0x14ec, 0x14dc, 0x14d0, 0x14c0,
+    0x14b0, 0x14a4, 0x1494, 0x1488, 0x1478, 0x146c, 0x145c, 0x1450,
+    0x1440, 0x1430, 0x1424, 0x1418, 0x1408, 0x13fc, 0x13ec, 0x13e0,
+    0x13d0, 0x13c4, 0x13b4, 0x13a8, 0x139c, 0x138c, 0x1380, 0x1370,
+    0x1364, 0x1358, 0x1348, 0x133c, 0x1330, 0x1320, 0x1314, 0x1308,
+    0x12f8, 0x12ec, 0x12e0, 0x12d4, 0x12c4, 0x12b8, 0x12ac, 0x12a0,
+    0x1290, 0x1284, 0x1278, 0x126c, 0x1260, 0x1250, 0x1244, 0x1238,
+    0x122c, 0x1220, 0x1214, 0x1208, 0x11f8, 0x11ec, 0x11e0, 0x11d4,
+    0x11c8, 0x11bc, 0x11b0, 0x11a4, 0x1198, 0x118c, 0x1180, 0x1174,
+    0x1168, 0x115c, 0x1150, 0x1144, 0x1138, 0x112c, 0x1120, 0x1114,
+    0x1108, 0x10fc, 0x10f0, 0x10e4, 0x10d8, 0x10cc, 0x10c0, 0x10b4,
+    0x10a8, 0x10a0, 0x1094, 0x1088, 0x107c, 0x1070, 0x1064, 0x1058,
+    0x1050, 0x1044, 0x1038, 0x102c, 0x1020, 0x1018, 0x100c, 0x1000,
+    0xff4, 0xfea, 0xfde, 0xfd4, 0xfc8, 0xfbe, 0xfb4, 0xfa8,
+    0xf9e, 0xf92, 0xf88, 0xf7e, 0xf72, 0xf68, 0xf5c, 0xf52,
+    0xf48, 0xf3e, 0xf32, 0xf28, 0xf1e, 0xf14, 0xf08, 0xefe,
+    0xef4, 0xeea, 0xee0, 0xed4, 0xeca, 0xec0, 0xeb6, 0xeac,
+    0xea2, 0xe98, 0xe8e, 0xe84, 0xe7a, 0xe70, 0xe66, 0xe5c,
+    0xe52, 0xe48, 0xe3e, 0xe34, 0xe2a, 0xe20, 0xe16, 0xe0c,
+    0xe04, 0xdfa, 0xdf0, 0xde6, 0xddc, 0xdd2, 0xdca, 0xdc0,
+    0xdb6, 0xdac, 0xda4, 0xd9a, 0xd90, 0xd88, 0xd7e, 0xd74,
+    0xd6a, 0xd62, 0xd58, 0xd50, 0xd46, 0xd3c, 0xd34, 0xd2a,
+    0xd22, 0xd18, 0xd10, 0xd06, 0xcfe, 0xcf4, 0xcec, 0xce2,
+    0xcda, 0xcd0, 0xcc8, 0xcbe, 0xcb6, 0xcae, 0xca4, 0xc9c,
+    0xc92, 0xc8a, 0xc82, 0xc78, 0xc70, 0xc68, 0xc60, 0xc56,
+    0xc4e, 0xc46, 0xc3c, 0xc34, 0xc2c, 0xc24, 0xc1c, 0xc12,
+    0xc0a, 0xc02, 0xbfa, 0xbf2, 0xbea, 0xbe0, 0xbd8, 0xbd0,
+    0xbc8, 0xbc0, 0xbb8, 0xbb0, 0xba8, 0xba0, 0xb98, 0xb90,
+    0xb88, 0xb80, 0xb78, 0xb70, 0xb68, 0xb60, 0xb58, 0xb50,
+    0xb48, 0xb40, 0xb38, 0xb32, 0xb2a, 0xb22, 0xb1a, 0xb12,
+    0xb0a, 0xb02, 0xafc, 0xaf4, 0xaec, 0xae4, 0xade, 0xad6,
+    0xace, 0xac6, 0xac0, 0xab8, 0xab0, 0xaa8, 0xaa2, 0xa9a,
+    0xa92, 0xa8c, 0xa84, 0xa7c, 0xa76, 0xa6e, 0xa68, 0xa60,
+    0xa58, 0xa52, 0xa4a, 0xa44, 0xa3c, 0xa36, 0xa2e, 0xa28,
+    0xa20, 0xa18, 0xa12, 0xa0c, 0xa04, 0x9fe, 0x9f6, 0x9f0,
+    0x9e8, 0x9e2, 0x9da, 0x9d4, 0x9ce, 0x9c6, 0x9c0, 0x9b8,
+    0x9b2, 0x9ac, 0x9a4, 0x99e, 0x998, 0x990, 0x98a, 0x984,
+    0x97c, 0x976, 0x970, 0x96a, 0x962, 0x95c, 0x956, 0x950,
+    0x948, 0x942, 0x93c, 0x936, 0x930, 0x928, 0x922, 0x91c,
+    0x916, 0x910, 0x90a, 0x904, 0x8fc, 0x8f6, 0x8f0, 0x8ea,
+    0x8e4, 0x8de, 0x8d8, 0x8d2, 0x8cc, 0x8c6, 0x8c0, 0x8ba,
+    0x8b4, 0x8ae, 0x8a8, 0x8a2, 0x89c, 0x896, 0x890, 0x88a,
+    0x884, 0x87e, 0x878, 0x872, 0x86c, 0x866, 0x860, 0x85a,
+    0x854, 0x850, 0x84a, 0x844, 0x83e, 0x838, 0x832, 0x82c,
+    0x828, 0x822, 0x81c, 0x816, 0x810, 0x80c, 0x806, 0x800,
+    0x7fa, 0x7f5, 0x7ef, 0x7ea, 0x7e4, 0x7df, 0x7da, 0x7d4,
+    0x7cf, 0x7c9, 0x7c4, 0x7bf, 0x7b9, 0x7b4, 0x7ae, 0x7a9,
+    0x7a4, 0x79f, 0x799, 0x794, 0x78f, 0x78a, 0x784, 0x77f,
+    0x77a, 0x775, 0x770, 0x76a, 0x765, 0x760, 0x75b, 0x756,
+    0x751, 0x74c, 0x747, 0x742, 0x73d, 0x738, 0x733, 0x72e,
+    0x729, 0x724, 0x71f, 0x71a, 0x715, 0x710, 0x70b, 0x706,
+    0x702, 0x6fd, 0x6f8, 0x6f3, 0x6ee, 0x6e9, 0x6e5, 0x6e0,
+    0x6db, 0x6d6, 0x6d2, 0x6cd, 0x6c8, 0x6c4, 0x6bf, 0x6ba,
+    0x6b5, 0x6b1, 0x6ac, 0x6a8, 0x6a3, 0x69e, 0x69a, 0x695,
+    0x691, 0x68c, 0x688, 0x683, 0x67f, 0x67a, 0x676, 0x671,
+    0x66d, 0x668, 0x664, 0x65f, 0x65b, 0x657, 0x652, 0x64e,
+    0x649, 0x645, 0x641, 0x63c, 0x638, 0x634, 0x630, 0x62b,
+    0x627, 0x623, 0x61e, 0x61a, 0x616, 0x612, 0x60e, 0x609,
+    0x605, 0x601, 0x5fd, 0x5f9, 0x5f5, 0x5f0, 0x5ec, 0x5e8,
+    0x5e4, 0x5e0, 0x5dc, 0x5d8, 0x5d4, 0x5d0, 0x5cc, 0x5c8,
+    0x5c4, 0x5c0, 0x5bc, 0x5b8, 0x5b4, 0x5b0, 0x5ac, 0x5a8,
+    0x5a4, 0x5a0, 0x59c, 0x599, 0x595, 0x591, 0x58d, 0x589,
+    0x585, 0x581, 0x57e, 0x57a, 0x576, 0x572, 0x56f, 0x56b,
+    0x567, 0x563, 0x560, 0x55c, 0x558, 0x554, 0x551, 0x54d,
+    0x549, 0x546, 0x542, 0x53e, 0x53b, 0x537, 0x534, 0x530,
+    0x52c, 0x529, 0x525, 0x522, 0x51e, 0x51b, 0x517, 0x514,
+    0x510, 0x50c, 0x509, 0x506, 0x502, 0x4ff, 0x4fb, 0x4f8,
+    0x4f4, 0x4f1, 0x4ed, 0x4ea, 0x4e7, 0x4e3, 0x4e0, 0x4dc,
+    0x4d9, 0x4d6, 0x4d2, 0x4cf, 0x4cc, 0x4c8, 0x4c5, 0x4c2,
+    0x4be, 0x4bb, 0x4b8, 0x4b5, 0x4b1, 0x4ae, 0x4ab, 0x4a8,
+    0x4a4, 0x4a1, 0x49e, 0x49b, 0x498, 0x494, 0x491, 0x48e,
+    0x48b, 0x488, 0x485, 0x482, 0x47e, 0x47b, 0x478, 0x475,
+    0x472, 0x46f, 0x46c, 0x469, 0x466, 0x463, 0x460, 0x45d,
+    0x45a, 0x457, 0x454, 0x451, 0x44e, 0x44b, 0x448, 0x445,
+    0x442, 0x43f, 0x43c, 0x439, 0x436, 0x433, 0x430, 0x42d,
+    0x42a, 0x428, 0x425, 0x422, 0x41f, 0x41c, 0x419, 0x416,
+    0x414, 0x411, 0x40e, 0x40b, 0x408, 0x406, 0x403, 0x400,
+    0x3fd, 0x3fa, 0x3f7, 0x3f5, 0x3f2, 0x3ef, 0x3ed, 0x3ea,
+    0x3e7, 0x3e4, 0x3e2, 0x3df, 0x3dc, 0x3da, 0x3d7, 0x3d4,
+    0x3d2, 0x3cf, 0x3cc, 0x3ca, 0x3c7, 0x3c5, 0x3c2, 0x3bf,
+    0x3bd, 0x3ba, 0x3b8, 0x3b5, 0x3b2, 0x3b0, 0x3ad, 0x3ab,
+    0x3a8, 0x3a6, 0x3a3, 0x3a1, 0x39e, 0x39c, 0x399, 0x397,
+    0x394, 0x392, 0x38f, 0x38d, 0x38a, 0x388, 0x385, 0x383,
+    0x381, 0x37e, 0x37c, 0x379, 0x377, 0x374, 0x372, 0x370,
+    0x36d, 0x36b, 0x369, 0x366, 0x364, 0x362, 0x35f, 0x35d,
+    0x35a, 0x358, 0x356, 0x354, 0x351, 0x34f, 0x34d, 0x34a,
+    0x348, 0x346, 0x344, 0x341, 0x33f, 0x33d, 0x33b, 0x338,
+    0x336, 0x334, 0x332, 0x32f, 0x32d, 0x32b, 0x329, 0x327,
+    0x324, 0x322, 0x320, 0x31e, 0x31c, 0x31a, 0x318, 0x315,
+    0x313, 0x311, 0x30f, 0x30d, 0x30b, 0x309, 0x307, 0x304,
+    0x302, 0x300, 0x2fe, 0x2fc, 0x2fa, 0x2f8, 0x2f6, 0x2f4,
+    0x2f2, 0x2f0, 0x2ee, 0x2ec, 0x2ea, 0x2e8, 0x2e6, 0x2e4,
+    0x2e2, 0x2e0, 0x2de, 0x2dc, 0x2da, 0x2d8, 0x2d6, 0x2d4,
+    0x2d2, 0x2d0, 0x2ce, 0x2cc, 0x2ca, 0x2c8, 0x2c6, 0x2c4,
+    0x2c2, 0x2c0, 0x2bf, 0x2bd, 0x2bb, 0x2b9, 0x2b7, 0x2b5,
+    0x2b3, 0x2b1, 0x2b0, 0x2ae, 0x2ac, 0x2aa, 0x2a8, 0x2a6,
+    0x2a4, 0x2a3, 0x2a1, 0x29f, 0x29d, 0x29b, 0x29a, 0x298,
+    0x296, 0x294, 0x292, 0x291, 0x28f, 0x28d, 0x28b, 0x28a,
+    0x288, 0x286, 0x284, 0x283, 0x281, 0x27f, 0x27d, 0x27c,
+    0x27a, 0x278, 0x276, 0x275, 0x273, 0x271, 0x270, 0x26e,
+    0x26c, 0x26b, 0x269, 0x267, 0x266, 0x264, 0x262, 0x261,
+    0x25f, 0x25d, 0x25c, 0x25a, 0x258, 0x257, 0x255, 0x254,
+    0x252, 0x250, 0x24f, 0x24d, 0x24c, 0x24a, 0x248, 0x247,
+    0x245, 0x244, 0x242, 0x241, 0x23f, 0x23d, 0x23c, 0x23a,
+    0x239, 0x237, 0x236, 0x234, 0x233, 0x231, 0x230, 0x22e,
+    0x22d, 0x22b, 0x22a, 0x228, 0x227, 0x225, 0x224, 0x222,
+    0x221, 0x21f, 0x21e, 0x21c, 0x21b, 0x219, 0x218, 0x216,
+    0x215, 0x214, 0x212, 0x211, 0x20f, 0x20e, 0x20c, 0x20b,
+    0x20a, 0x208, 0x207, 0x205, 0x204, 0x203, 0x201, 0x200,
+    0x1fe, 0x1fd, 0x1fb, 0x1fa, 0x1f9, 0x1f7, 0x1f6, 0x1f5,
+    0x1f3, 0x1f2, 0x1f1, 0x1ef, 0x1ee, 0x1ed, 0x1eb, 0x1ea,
+    0x1e9, 0x1e7, 0x1e6, 0x1e5, 0x1e3, 0x1e2, 0x1e1, 0x1df,
+    0x1de, 0x1dd, 0x1dc, 0x1da, 0x1d9, 0x1d8, 0x1d6, 0x1d5,
+    0x1d4, 0x1d3, 0x1d1, 0x1d0, 0x1cf, 0x1ce, 0x1cc, 0x1cb,
+    0x1ca, 0x1c9, 0x1c7, 0x1c6, 0x1c5, 0x1c4, 0x1c2, 0x1c1,
+    0x1c0, 0x1bf, 0x1be, 0x1bc, 0x1bb, 0x1ba, 0x1b9, 0x1b8,
+    0x1b6, 0x1b5, 0x1b4, 0x1b3, 0x1b2, 0x1b1, 0x1af, 0x1ae,
+    0x1ad, 0x1ac, 0x1ab, 0x1aa, 0x1a8, 0x1a7, 0x1a6, 0x1a5,
+    0x1a4, 0x1a3, 0x1a2, 0x1a0, 0x19f, 0x19e, 0x19d, 0x19c,
+    0x19b, 0x19a, 0x199, 0x197, 0x196, 0x195, 0x194, 0x193,
+    0x192, 0x191, 0x190, 0x18f, 0x18e, 0x18d, 0x18c, 0x18a,
+    0x189, 0x188, 0x187, 0x186, 0x185, 0x184, 0x183, 0x182,
+    0x181, 0x180, 0x17f, 0x17e, 0x17d, 0x17c, 0x17b, 0x17a,
+    0x179, 0x178, 0x177, 0x176, 0x175, 0x174, 0x173, 0x172,
+    0x171, 0x170, 0x16f, 0x16e, 0x16d, 0x16c, 0x16b, 0x16a,
+    0x169, 0x168, 0x167, 0x166, 0x165, 0x164, 0x163, 0x162,
+    0x161, 0x160, 0x15f, 0x15e, 0x15d, 0x15c, 0x15b, 0x15a,
+    0x159, 0x158, 0x158, 0x157, 0x156, 0x155, 0x154, 0x153,
+    0x152, 0x151, 0x150, 0x14f, 0x14e, 0x14d, 0x14d, 0x14c,
+    0x14b, 0x14a, 0x149, 0x148, 0x147, 0x146, 0x145, 0x145,
+    0x144, 0x143, 0x142, 0x141, 0x140, 0x13f, 0x13e, 0x13e,
+    0x13d, 0x13c, 0x13b, 0x13a, 0x139, 0x138, 0x138, 0x137,
+    0x136, 0x135, 0x134, 0x133, 0x133, 0x132, 0x131, 0x130,
+    0x12f, 0x12e, 0x12e, 0x12d, 0x12c, 0x12b, 0x12a, 0x12a,
+    0x129, 0x128, 0x127, 0x126, 0x126, 0x125, 0x124, 0x123,
+    0x122, 0x122, 0x121, 0x120, 0x11f, 0x11e, 0x11e, 0x11d,
+    0x11c, 0x11b, 0x11b, 0x11a, 0x119, 0x118, 0x118, 0x117,
+    0x116, 0x115, 0x115, 0x114, 0x113, 0x112, 0x112, 0x111,
+    0x110, 0x10f, 0x10f, 0x10e, 0x10d, 0x10c, 0x10c, 0x10b,
+    0x10a, 0x10a, 0x109, 0x108, 0x107, 0x107, 0x106, 0x105,
+    0x105, 0x104, 0x103, 0x102, 0x102, 0x101, 0x100, 0x100,
+    0x0ff, 0x0fe, 0x0fd, 0x0fd, 0x0fc, 0x0fb, 0x0fb, 0x0fa,
+    0x0f9, 0x0f9, 0x0f8, 0x0f7, 0x0f7, 0x0f6, 0x0f5, 0x0f5,
+    0x0f4, 0x0f3, 0x0f3, 0x0f2, 0x0f1, 0x0f1, 0x0f0, 0x0ef,
+    0x0ef, 0x0ee, 0x0ee, 0x0ed, 0x0ec, 0x0ec, 0x0eb, 0x0ea,
+    0x0ea, 0x0e9, 0x0e8, 0x0e8, 0x0e7, 0x0e7, 0x0e6, 0x0e5,
+    0x0e5, 0x0e4, 0x0e3, 0x0e3, 0x0e2, 0x0e2, 0x0e1, 0x0e0,
+    0x0e0, 0x0df, 0x0df, 0x0de, 0x0dd, 0x0dd, 0x0dc, 0x0dc,
+    0x0db, 0x0da, 0x0da, 0x0d9, 0x0d9, 0x0d8, 0x0d7, 0x0d7,
+    0x0d6, 0x0d6, 0x0d5, 0x0d5, 0x0d4, 0x0d3, 0x0d3, 0x0d2,
+    0x0d2, 0x0d1, 0x0d1, 0x0d0, 0x0cf, 0x0cf, 0x0ce, 0x0ce,
+    0x0cd, 0x0cd, 0x0cc, 0x0cb, 0x0cb, 0x0ca, 0x0ca, 0x0c9,
+    0x0c9, 0x0c8, 0x0c8, 0x0c7, 0x0c7, 0x0c6, 0x0c6, 0x0c5,
+    0x0c4, 0x0c4, 0x0c3, 0x0c3, 0x0c2, 0x0c2, 0x0c1, 0x0c1,
+    0x0c0, 0x0c0, 0x0bf, 0x0bf, 0x0be, 0x0be, 0x0bd, 0x0bd,
+    0x0bc, 0x0bc, 0x0bb, 0x0bb, 0x0ba, 0x0ba, 0x0b9, 0x0b9,
+    0x0b8, 0x0b8, 0x0b7, 0x0b7, 0x0b6, 0x0b6, 0x0b5, 0x0b5,
+    0x0b4, 0x0b4, 0x0b3, 0x0b3, 0x0b2, 0x0b2, 0x0b1, 0x0b1,
+    0x0b0, 0x0b0, 0x0af, 0x0af, 0x0ae, 0x0ae, 0x0ad, 0x0ad,
+    0x0ac, 0x0ac, 0x0ac, 0x0ab, 0x0ab, 0x0aa, 0x0aa, 0x0a9,
+    0x0a9, 0x0a8, 0x0a8, 0x0a7, 0x0a7, 0x0a6, 0x0a6, 0x0a6,
+    0x0a5, 0x0a5, 0x0a4, 0x0a4, 0x0a3, 0x0a3, 0x0a2, 0x0a2,
+    0x0a2, 0x0a1, 0x0a1, 0x0a0, 0x0a0, 0x09f, 0x09f, 0x09f,
+    0x09e, 0x09e, 0x09d, 0x09d, 0x09c, 0x09c, 0x09c, 0x09b,
+    0x09b, 0x09a, 0x09a, 0x099, 0x099, 0x099, 0x098, 0x098,
+    0x097, 0x097, 0x097, 0x096, 0x096, 0x095, 0x095, 0x095,
+    0x094, 0x094, 0x093, 0x093, 0x093, 0x092, 0x092, 0x091,
+    0x091, 0x091, 0x090, 0x090, 0x08f, 0x08f, 0x08f, 0x08e,
+    0x08e, 0x08d, 0x08d, 0x08d, 0x08c, 0x08c, 0x08c, 0x08b,
+    0x08b, 0x08a, 0x08a, 0x08a, 0x089, 0x089, 0x089, 0x088,
+    0x088, 0x087, 0x087, 0x087, 0x086, 0x086, 0x086, 0x085,
+    0x085, 0x085, 0x084, 0x084, 0x083, 0x083, 0x083, 0x082,
+    0x082, 0x082, 0x081, 0x081, 0x081, 0x080, 0x080, 0x080,
+    0x07f, 0x07f, 0x07e, 0x07e, 0x07e, 0x07d, 0x07d, 0x07d,
+    0x07c, 0x07c, 0x07c, 0x07b, 0x07b, 0x07b, 0x07a, 0x07a,
+    0x07a, 0x079, 0x079, 0x079, 0x078, 0x078, 0x078, 0x077,
+    0x077, 0x077, 0x077, 0x076, 0x076, 0x076, 0x075, 0x075,
+    0x075, 0x074, 0x074, 0x074, 0x073, 0x073, 0x073, 0x072,
+    0x072, 0x072, 0x071, 0x071, 0x071, 0x071, 0x070, 0x070,
+    0x070, 0x06f, 0x06f, 0x06f, 0x06e, 0x06e, 0x06e, 0x06e,
+    0x06d, 0x06d, 0x06d, 0x06c, 0x06c, 0x06c, 0x06b, 0x06b,
+    0x06b, 0x06b, 0x06a, 0x06a, 0x06a, 0x069, 0x069, 0x069,
+    0x069, 0x068, 0x068, 0x068, 0x067, 0x067, 0x067, 0x067,
+    0x066, 0x066, 0x066, 0x065, 0x065, 0x065, 0x065, 0x064,
+    0x064, 0x064, 0x064, 0x063, 0x063, 0x063, 0x063, 0x062,
+    0x062, 0x062, 0x061, 0x061, 0x061, 0x061, 0x060, 0x060,
+    0x060, 0x060, 0x05f, 0x05f, 0x05f, 0x05f, 0x05e, 0x05e,
+    0x05e, 0x05e, 0x05d, 0x05d, 0x05d, 0x05d, 0x05c, 0x05c,
+    0x05c, 0x05c, 0x05b, 0x05b, 0x05b, 0x05b, 0x05a, 0x05a,
+    0x05a, 0x05a, 0x059, 0x059, 0x059, 0x059, 0x058, 0x058,
+    0x058, 0x058, 0x057, 0x057, 0x057, 0x057, 0x056, 0x056,
+    0x056, 0x056, 0x056, 0x055, 0x055, 0x055, 0x055, 0x054,
+    0x054, 0x054, 0x054, 0x053, 0x053, 0x053, 0x053, 0x053,
+    0x052, 0x052, 0x052, 0x052, 0x051, 0x051, 0x051, 0x051,
+    0x051, 0x050, 0x050, 0x050, 0x050, 0x04f, 0x04f, 0x04f,
+    0x04f, 0x04f, 0x04e, 0x04e, 0x04e, 0x04e, 0x04e, 0x04d,
+    0x04d, 0x04d, 0x04d, 0x04c, 0x04c, 0x04c, 0x04c, 0x04c,
+    0x04b, 0x04b, 0x04b, 0x04b, 0x04b, 0x04a, 0x04a, 0x04a,
+    0x04a, 0x04a, 0x049, 0x049, 0x049, 0x049, 0x049, 0x048,
+    0x048, 0x048, 0x048, 0x048, 0x047, 0x047, 0x047, 0x047,
+    0x047, 0x046, 0x046, 0x046, 0x046, 0x046, 0x046, 0x045,
+    0x045, 0x045, 0x045, 0x045, 0x044, 0x044, 0x044, 0x044,
+    0x044, 0x043, 0x043, 0x043, 0x043, 0x043, 0x043, 0x042,
+    0x042, 0x042, 0x042, 0x042, 0x041, 0x041, 0x041, 0x041,
+    0x041, 0x041, 0x040, 0x040, 0x040, 0x040, 0x040, 0x040,
+    0x03f, 0x03f, 0x03f, 0x03f, 0x03f, 0x03e, 0x03e, 0x03e,
+    0x03e, 0x03e, 0x03e, 0x03d, 0x03d, 0x03d, 0x03d, 0x03d,
+    0x03d, 0x03c, 0x03c, 0x03c, 0x03c, 0x03c, 0x03c, 0x03b,
+    0x03b, 0x03b, 0x03b, 0x03b, 0x03b, 0x03b, 0x03a, 0x03a,
+    0x03a, 0x03a, 0x03a, 0x03a, 0x039, 0x039, 0x039, 0x039,
+    0x039, 0x039, 0x038, 0x038, 0x038, 0x038, 0x038, 0x038,
+    0x038, 0x037, 0x037, 0x037, 0x037, 0x037, 0x037, 0x037,
+    0x036, 0x036, 0x036, 0x036, 0x036, 0x036, 0x035, 0x035,
+    0x035, 0x035, 0x035, 0x035, 0x035, 0x034, 0x034, 0x034,
+    0x034, 0x034, 0x034, 0x034, 0x033, 0x033, 0x033, 0x033,
+    0x033, 0x033, 0x033, 0x032, 0x032, 0x032, 0x032, 0x032,
+    0x032, 0x032, 0x032, 0x031, 0x031, 0x031, 0x031, 0x031,
+    0x031, 0x031, 0x030, 0x030, 0x030, 0x030, 0x030, 0x030,
+    0x030, 0x030, 0x02f, 0x02f, 0x02f, 0x02f, 0x02f, 0x02f,
+    0x02f, 0x02f, 0x02e, 0x02e, 0x02e, 0x02e, 0x02e, 0x02e,
+    0x02e, 0x02e, 0x02d, 0x02d, 0x02d, 0x02d, 0x02d, 0x02d,
+    0x02d, 0x02d, 0x02c, 0x02c, 0x02c, 0x02c, 0x02c, 0x02c,
+    0x02c, 0x02c, 0x02b, 0x02b, 0x02b, 0x02b, 0x02b, 0x02b,
+    0x02b, 0x02b, 0x02b, 0x02a, 0x02a, 0x02a, 0x02a, 0x02a,
+    0x02a, 0x02a, 0x02a, 0x029, 0x029, 0x029, 0x029, 0x029,
+    0x029, 0x029, 0x029, 0x029, 0x028, 0x028, 0x028, 0x028,
+    0x028, 0x028, 0x028, 0x028, 0x028, 0x027, 0x027, 0x027,
+    0x027, 0x027, 0x027, 0x027, 0x027, 0x027, 0x027, 0x026,
+    0x026, 0x026, 0x026, 0x026, 0x026, 0x026, 0x026, 0x026,
+    0x025, 0x025, 0x025, 0x025, 0x025, 0x025, 0x025, 0x025,
+    0x025, 0x025, 0x024, 0x024, 0x024, 0x024, 0x024, 0x024,
+    0x024, 0x024, 0x024, 0x024, 0x023, 0x023, 0x023, 0x023,
+    0x023, 0x023, 0x023, 0x023, 0x023, 0x023, 0x023, 0x022,
+    0x022, 0x022, 0x022, 0x022, 0x022, 0x022, 0x022, 0x022,
+    0x022, 0x021, 0x021, 0x021, 0x021, 0x021, 0x021, 0x021,
+    0x021, 0x021, 0x021, 0x021, 0x020, 0x020, 0x020, 0x020,
+    0x020, 0x020, 0x020, 0x020, 0x020, 0x020, 0x020, 0x020,
+    0x01f, 0x01f, 0x01f, 0x01f, 0x01f, 0x01f, 0x01f, 0x01f,
+    0x01f, 0x01f, 0x01f, 0x01e, 0x01e, 0x01e, 0x01e, 0x01e,
+    0x01e, 0x01e, 0x01e, 0x01e, 0x01e, 0x01e, 0x01e, 0x01d,
+    0x01d, 0x01d, 0x01d, 0x01d, 0x01d, 0x01d, 0x01d, 0x01d,
+    0x01d, 0x01d, 0x01d, 0x01d, 0x01c, 0x01c, 0x01c, 0x01c,
+    0x01c, 0x01c, 0x01c, 0x01c, 0x01c, 0x01c, 0x01c, 0x01c,
+    0x01c, 0x01b, 0x01b, 0x01b, 0x01b, 0x01b, 0x01b, 0x01b,
+    0x01b, 0x01b, 0x01b, 0x01b, 0x01b, 0x01b, 0x01a, 0x01a,
+    0x01a, 0x01a, 0x01a, 0x01a, 0x01a, 0x01a, 0x01a, 0x01a,
+    0x01a, 0x01a, 0x01a, 0x01a, 0x019, 0x019, 0x019, 0x019,
+    0x019, 0x019, 0x019, 0x019, 0x019, 0x019, 0x019, 0x019,
+    0x019, 0x019, 0x019, 0x018, 0x018, 0x018, 0x018, 0x018,
+    0x018, 0x018, 0x018, 0x018, 0x018, 0x018, 0x018, 0x018,
+    0x018, 0x018, 0x017, 0x017, 0x017, 0x017, 0x017, 0x017,
+    0x017, 0x017, 0x017, 0x017, 0x017, 0x017, 0x017, 0x017,
+    0x017, 0x017, 0x016, 0x016, 0x016, 0x016, 0x016, 0x016,
+    0x016, 0x016, 0x016, 0x016, 0x016, 0x016, 0x016, 0x016,
+    0x016, 0x016, 0x015, 0x015, 0x015, 0x015, 0x015, 0x015,
+    0x015, 0x015, 0x015, 0x015, 0x015, 0x015, 0x015, 0x015,
+    0x015, 0x015, 0x015, 0x014, 0x014, 0x014, 0x014, 0x014,
+    0x014, 0x014, 0x014, 0x014, 0x014, 0x014, 0x014, 0x014,
+    0x014, 0x014, 0x014, 0x014, 0x014, 0x013, 0x013, 0x013,
+    0x013, 0x013, 0x013, 0x013, 0x013, 0x013, 0x013, 0x013,
+    0x013, 0x013, 0x013, 0x013, 0x013, 0x013, 0x013, 0x013,
+    0x012, 0x012, 0x012, 0x012, 0x012, 0x012, 0x012, 0x012,
+    0x012, 0x012, 0x012, 0x012, 0x012, 0x012, 0x012, 0x012,
+    0x012, 0x012, 0x012, 0x012, 0x011, 0x011, 0x011, 0x011,
+    0x011, 0x011, 0x011, 0x011, 0x011, 0x011, 0x011, 0x011,
+    0x011, 0x011, 0x011, 0x011, 0x011, 0x011, 0x011, 0x011,
+    0x011, 0x010, 0x010, 0x010, 0x010, 0x010, 0x010, 0x010,
+    0x010, 0x010, 0x010, 0x010, 0x010, 0x010, 0x010, 0x010,
+    0x010, 0x010, 0x010, 0x010, 0x010, 0x010, 0x010, 0x010,
+    0x00f, 0x00f, 0x00f, 0x00f, 0x00f, 0x00f, 0x00f, 0x00f,
+    0x00f, 0x00f, 0x00f, 0x00f, 0x00f, 0x00f, 0x00f, 0x00f,
+    0x00f, 0x00f, 0x00f, 0x00f, 0x00f, 0x00f, 0x00f, 0x00e,
+    0x00e, 0x00e, 0x00e, 0x00e, 0x00e, 0x00e, 0x00e, 0x00e,
+    0x00e, 0x00e, 0x00e, 0x00e, 0x00e, 0x00e, 0x00e, 0x00e,
+    0x00e, 0x00e, 0x00e, 0x00e, 0x00e, 0x00e, 0x00e, 0x00e,
+    0x00e, 0x00d, 0x00d, 0x00d, 0x00d, 0x00d, 0x00d, 0x00d,
+    0x00d, 0x00d, 0x00d, 0x00d, 0x00d, 0x00d, 0x00d, 0x00d,
+    0x00d, 0x00d, 0x00d, 0x00d, 0x00d, 0x00d, 0x00d, 0x00d,
+    0x00d, 0x00d, 0x00d, 0x00d, 0x00c, 0x00c, 0x00c, 0x00c,
+    0x00c, 0x00c, 0x00c, 0x00c, 0x00c, 0x00c, 0x00c, 0x00c,
+    0x00c, 0x00c, 0x00c, 0x00c, 0x00c, 0x00c, 0x00c, 0x00c,
+    0x00c, 0x00c, 0x00c, 0x00c, 0x00c, 0x00c, 0x00c, 0x00c,
+    0x00c, 0x00c, 0x00b, 0x00b, 0x00b, 0x00b, 0x00b, 0x00b,
+    0x00b, 0x00b, 0x00b, 0x00b, 0x00b, 0x00b, 0x00b, 0x00b,
+    0x00b, 0x00b, 0x00b, 0x00b, 0x00b, 0x00b, 0x00b, 0x00b,
+    0x00b, 0x00b, 0x00b, 0x00b, 0x00b, 0x00b, 0x00b, 0x00b,
+    0x00b, 0x00b, 0x00a, 0x00a, 0x00a, 0x00a, 0x00a, 0x00a,
+    0x00a, 0x00a, 0x00a, 0x00a, 0x00a, 0x00a, 0x00a, 0x00a,
+    0x00a, 0x00a, 0x00a, 0x00a, 0x00a, 0x00a, 0x00a, 0x00a,
+    0x00a, 0x00a, 0x00a, 0x00a, 0x00a, 0x00a, 0x00a, 0x00a,
+    0x00a, 0x00a, 0x00a, 0x00a, 0x00a, 0x009, 0x009, 0x009,
+    0x009, 0x009, 0x009, 0x009, 0x009, 0x009, 0x009, 0x009,
+    0x009, 0x009, 0x009, 0x009, 0x009, 0x009, 0x009, 0x009,
+    0x009, 0x009, 0x009, 0x009, 0x009, 0x009, 0x009, 0x009,
+    0x009, 0x009, 0x009, 0x009, 0x009, 0x009, 0x009, 0x009,
+    0x009, 0x009, 0x009, 0x009, 0x008, 0x008, 0x008, 0x008,
+    0x008, 0x008, 0x008, 0x008, 0x008, 0x008, 0x008, 0x008,
+    0x008, 0x008, 0x008, 0x008, 0x008, 0x008, 0x008, 0x008,
+    0x008, 0x008, 0x008, 0x008, 0x008, 0x008, 0x008, 0x008,
+    0x008, 0x008, 0x008, 0x008, 0x008, 0x008, 0x008, 0x008,
+    0x008, 0x008, 0x008, 0x008, 0x008, 0x008, 0x008, 0x008,
+    0x007, 0x007, 0x007, 0x007, 0x007, 0x007, 0x007, 0x007,
+    0x007, 0x007, 0x007, 0x007, 0x007, 0x007, 0x007, 0x007,
+    0x007, 0x007, 0x007, 0x007, 0x007, 0x007, 0x007, 0x007,
+    0x007, 0x007, 0x007, 0x007, 0x007, 0x007, 0x007, 0x007,
+    0x007, 0x007, 0x007, 0x007, 0x007, 0x007, 0x007, 0x007,
+    0x007, 0x007, 0x007, 0x007, 0x007, 0x007, 0x007, 0x007,
+    0x007, 0x006, 0x006, 0x006, 0x006, 0x006, 0x006, 0x006,
+    0x006, 0x006, 0x006, 0x006, 0x006, 0x006, 0x006, 0x006,
+    0x006, 0x006, 0x006, 0x006, 0x006, 0x006, 0x006, 0x006,
+    0x006, 0x006, 0x006, 0x006, 0x006, 0x006, 0x006, 0x006,
+    0x006, 0x006, 0x006, 0x006, 0x006, 0x006, 0x006, 0x006,
+    0x006, 0x006, 0x006, 0x006, 0x006, 0x006, 0x006, 0x006,
+    0x006, 0x006, 0x006, 0x006, 0x006, 0x006, 0x006, 0x006,
+    0x006, 0x006, 0x005, 0x005, 0x005, 0x005, 0x005, 0x005,
+    0x005, 0x005, 0x005, 0x005, 0x005, 0x005, 0x005, 0x005,
+    0x005, 0x005, 0x005, 0x005, 0x005, 0x005, 0x005, 0x005,
+    0x005, 0x005, 0x005, 0x005, 0x005, 0x005, 0x005, 0x005,
+    0x005, 0x005, 0x005, 0x005, 0x005, 0x005, 0x005, 0x005,
+    0x005, 0x005, 0x005, 0x005, 0x005, 0x005, 0x005, 0x005,
+    0x005, 0x005, 0x005, 0x005, 0x005, 0x005, 0x005, 0x005,
+    0x005, 0x005, 0x005, 0x005, 0x005, 0x005, 0x005, 0x005,
+    0x005, 0x005, 0x005, 0x005, 0x005, 0x004, 0x004, 0x004,
+    0x004, 0x004, 0x004, 0x004, 0x004, 0x004, 0x004, 0x004,
+    0x004, 0x004, 0x004, 0x004, 0x004, 0x004, 0x004, 0x004,
+    0x004, 0x004, 0x004, 0x004, 0x004, 0x004, 0x004, 0x004,
+    0x004, 0x004, 0x004, 0x004, 0x004, 0x004, 0x004, 0x004,
+    0x004, 0x004, 0x004, 0x004, 0x004, 0x004, 0x004, 0x004,
+    0x004, 0x004, 0x004, 0x004, 0x004, 0x004, 0x004, 0x004,
+    0x004, 0x004, 0x004, 0x004, 0x004, 0x004, 0x004, 0x004,
+    0x004, 0x004, 0x004, 0x004, 0x004, 0x004, 0x004, 0x004,
+    0x004, 0x004, 0x004, 0x004, 0x004, 0x004, 0x004, 0x004,
+    0x004, 0x004, 0x004, 0x004, 0x004, 0x004, 0x004, 0x004,
+    0x003, 0x003, 0x003, 0x003, 0x003, 0x003, 0x003, 0x003,
+    0x003, 0x003, 0x003, 0x003, 0x003, 0x003, 0x003, 0x003,
+    0x003, 0x003, 0x003, 0x003, 0x003, 0x003, 0x003, 0x003,
+    0x003, 0x003, 0x003, 0x003, 0x003, 0x003, 0x003, 0x003,
+    0x003, 0x003, 0x003, 0x003, 0x003, 0x003, 0x003, 0x003,
+    0x003, 0x003, 0x003, 0x003, 0x003, 0x003, 0x003, 0x003,
+    0x003, 0x003, 0x003, 0x003, 0x003, 0x003, 0x003, 0x003,
+    0x003, 0x003, 0x003, 0x003, 0x003, 0x003, 0x003, 0x003,
+    0x003, 0x003, 0x003, 0x003, 0x003, 0x003, 0x003, 0x003,
+    0x003, 0x003, 0x003, 0x003, 0x003, 0x003, 0x003, 0x003,
+    0x003, 0x003, 0x003, 0x003, 0x003, 0x003, 0x003, 0x003,
+    0x003, 0x003, 0x003, 0x003, 0x003, 0x003, 0x003, 0x003,
+    0x003, 0x003, 0x003, 0x003, 0x003, 0x003, 0x003, 0x003,
+    0x003, 0x003, 0x002, 0x002, 0x002, 0x002, 0x002, 0x002,
+    0x002, 0x002, 0x002, 0x002, 0x002, 0x002, 0x002, 0x002,
+    0x002, 0x002, 0x002, 0x002, 0x002, 0x002, 0x002, 0x002,
+    0x002, 0x002, 0x002, 0x002, 0x002, 0x002, 0x002, 0x002,
+    0x002, 0x002, 0x002, 0x002, 0x002, 0x002, 0x002, 0x002,
+    0x002, 0x002, 0x002, 0x002, 0x002, 0x002, 0x002, 0x002,
+    0x002, 0x002, 0x002, 0x002, 0x002, 0x002, 0x002, 0x002,
+    0x002, 0x002, 0x002, 0x002, 0x002, 0x002, 0x002, 0x002,
+    0x002, 0x002, 0x002, 0x002, 0x002, 0x002, 0x002, 0x002,
+    0x002, 0x002, 0x002, 0x002, 0x002, 0x002, 0x002, 0x002,
+    0x002, 0x002, 0x002, 0x002, 0x002, 0x002, 0x002, 0x002,
+    0x002, 0x002, 0x002, 0x002, 0x002, 0x002, 0x002, 0x002,
+    0x002, 0x002, 0x002, 0x002, 0x002, 0x002, 0x002, 0x002,
+    0x002, 0x002, 0x002, 0x002, 0x002, 0x002, 0x002, 0x002,
+    0x002, 0x002, 0x002, 0x002, 0x002, 0x002, 0x002, 0x002,
+    0x002, 0x002, 0x002, 0x002, 0x002, 0x002, 0x002, 0x002,
+    0x002, 0x002, 0x002, 0x002, 0x002, 0x002, 0x002, 0x002,
+    0x002, 0x002, 0x002, 0x002, 0x002, 0x002, 0x002, 0x002,
+    0x002, 0x002, 0x002, 0x002, 0x002, 0x002, 0x002, 0x002,
+    0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001,
+    0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001,
+    0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001,
+    0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001,
+    0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001,
+    0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001,
+    0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001,
+    0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001,
+    0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001,
+    0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001,
+    0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001,
+    0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001,
+    0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001,
+    0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001,
+    0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001,
+    0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001,
+    0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001,
+    0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001,
+    0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001,
+    0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001,
+    0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001,
+    0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001,
+    0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001,
+    0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001,
+    0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001,
+    0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001,
+    0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001,
+    0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001,
+    0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001,
+    0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001,
+    0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001,
+    0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000
+};
+
+/* Envelope generator */
+static const uint32_t eg_stephi[4][4] = {
+    { 0, 0, 0, 0 },
+    { 1, 0, 0, 0 },
+    { 1, 0, 1, 0 },
+    { 1, 1, 1, 0 }
+};
+
+/* Phase generator */
+static const uint32_t pg_detune[8] = { 16, 17, 19, 20, 22, 24, 27, 29 };
+
+typedef struct {
+    int32_t basefreq;
+    int32_t approxtype;
+    int32_t slope;
+} freqtable_t;
+
+static const freqtable_t pg_freqtable[64] = {
+    { 1299, 1, 19 },
+    { 1318, 1, 19 },
+    { 1337, 1, 19 },
+    { 1356, 1, 20 },
+    { 1376, 1, 20 },
+    { 1396, 1, 20 },
+    { 1416, 1, 21 },
+    { 1437, 1, 20 },
+    { 1458, 1, 21 },
+    { 1479, 1, 21 },
+    { 1501, 1, 22 },
+    { 1523, 1, 22 },
+    { 0,    0, 16 },
+    { 0,    0, 16 },
+    { 0,    0, 16 },
+    { 0,    0, 16 },
+    { 1545, 1, 22 },
+    { 1567, 1, 22 },
+    { 1590, 1, 23 },
+    { 1613, 1, 23 },
+    { 1637, 1, 23 },
+    { 1660, 1, 24 },
+    { 1685, 1, 24 },
+    { 1709, 1, 24 },
+    { 1734, 1, 25 },
+    { 1759, 1, 25 },
+    { 1785, 1, 26 },
+    { 1811, 1, 26 },
+    { 0,    0, 16 },
+    { 0,    0, 16 },
+    { 0,    0, 16 },
+    { 0,    0, 16 },
+    { 1837, 1, 26 },
+    { 1864, 1, 27 },
+    { 1891, 1, 27 },
+    { 1918, 1, 28 },
+    { 1946, 1, 28 },
+    { 1975, 1, 28 },
+    { 2003, 1, 29 },
+    { 2032, 1, 30 },
+    { 2062, 1, 30 },
+    { 2092, 1, 30 },
+    { 2122, 1, 31 },
+    { 2153, 1, 31 },
+    { 0,    0, 16 },
+    { 0,    0, 16 },
+    { 0,    0, 16 },
+    { 0,    0, 16 },
+    { 2185, 1, 31 },
+    { 2216, 0, 31 },
+    { 2249, 0, 31 },
+    { 2281, 0, 31 },
+    { 2315, 0, 31 },
+    { 2348, 0, 31 },
+    { 2382, 0, 30 },
+    { 2417, 0, 30 },
+    { 2452, 0, 30 },
+    { 2488, 0, 30 },
+    { 2524, 0, 30 },
+    { 2561, 0, 30 },
+    { 0,    0, 16 },
+    { 0,    0, 16 },
+    { 0,    0, 16 },
+    { 0,    0, 16 }
+};
+
+
+/* FM algorithm */
+static const uint32_t fm_algorithm[4][6][8] = {
+    {
+        { 1, 1, 1, 1, 1, 1, 1, 1 }, /* M1_0          */
+        { 1, 1, 1, 1, 1, 1, 1, 1 }, /* M1_1          */
+        { 0, 0, 0, 0, 0, 0, 0, 0 }, /* C1            */
+        { 0, 0, 0, 0, 0, 0, 0, 0 }, /* Last operator */
+        { 0, 0, 0, 0, 0, 0, 0, 0 }, /* Last operator */
+        { 0, 0, 0, 0, 0, 0, 0, 1 }  /* Out           */
+    },
+    {
+        { 0, 1, 0, 0, 0, 1, 0, 0 }, /* M1_0          */
+        { 0, 0, 0, 0, 0, 0, 0, 0 }, /* M1_1          */
+        { 1, 1, 1, 0, 0, 0, 0, 0 }, /* C1            */
+        { 0, 0, 0, 0, 0, 0, 0, 0 }, /* Last operator */
+        { 0, 0, 0, 0, 0, 0, 0, 0 }, /* Last operator */
+        { 0, 0, 0, 0, 0, 1, 1, 1 }  /* Out           */
+    },
+    {
+        { 0, 0, 0, 0, 0, 0, 0, 0 }, /* M1_0          */
+        { 0, 0, 0, 0, 0, 0, 0, 0 }, /* M1_1          */
+        { 0, 0, 0, 0, 0, 0, 0, 0 }, /* C1            */
+        { 1, 0, 0, 1, 1, 1, 1, 0 }, /* Last operator */
+        { 0, 0, 0, 0, 0, 0, 0, 0 }, /* Last operator */
+        { 0, 0, 0, 0, 1, 1, 1, 1 }  /* Out           */
+    },
+    {
+        { 0, 0, 1, 0, 0, 1, 0, 0 }, /* M1_0          */
+        { 0, 0, 0, 0, 0, 0, 0, 0 }, /* M1_1          */
+        { 0, 0, 0, 1, 0, 0, 0, 0 }, /* C1            */
+        { 1, 1, 0, 1, 1, 0, 0, 0 }, /* Last operator */
+        { 0, 0, 1, 0, 0, 0, 0, 0 }, /* Last operator */
+        { 1, 1, 1, 1, 1, 1, 1, 1 }  /* Out           */
+    }
+};
+
+static const uint16_t lfo_counter2_table[16] = {
+    0x0000, 0x4000, 0x6000, 0x7000,
+    0x7800, 0x7c00, 0x7e00, 0x7f00,
+    0x7f80, 0x7fc0, 0x7fe0, 0x7ff0,
+    0x7ff8, 0x7ffc, 0x7ffe, 0x7fff
+};
+
+#endif
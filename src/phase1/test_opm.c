@@ -8,6 +8,9 @@
 #include <stdint.h>
 #include <math.h>
 #include "../../opm.h"
+#include "../../opm_multi.h"
+#include "../../opm_convert.h"
+#include "../../opm_resample.h"
 
 // Sample rate and clock settings
 #define OPM_CLOCK 3579545
@@ -18,24 +21,34 @@
 #define DURATION_SECONDS 3
 #define TOTAL_SAMPLES (SAMPLE_RATE * DURATION_SECONDS)
 #define REGISTER_WRITE_DELAY_CYCLES 128
+#define MULTI_TEST_SAMPLES (SAMPLE_RATE / 4)
+#define WORD_MIXER_TEST_SAMPLES (SAMPLE_RATE / 4)
+#define IDLE_TEST_PHRASES 16
+#define STATE_TEST_SAMPLES (SAMPLE_RATE / 4)
+#define QUEUE_TEST_BURSTS 8
+#define CONVERT_TEST_VALUES 4099 // Odd, so every vector tail is exercised
+#define RESET_TEST_RESETS 4
+#define POKE_TEST_ROUNDS 8
+#define EG_TIMER_TEST_SEGMENTS 16
+#define EG_TIMER_TEST_ROUNDS 4096
+#define LFO_TEST_SEGMENTS 8
+#define LFO_TEST_ROUNDS 4096
+#define REGISTER_CACHE_TEST_ROUNDS 65536
+#define RESAMPLE_TEST_FRAMES 8192
+#define RESAMPLE_TEST_AMPLITUDE 20000 // Chip level; 10000 at the 16-bit output
 
-// Helper function to write register with delay
-void write_register_with_delay(opm_t *chip, uint8_t addr, uint8_t data, int32_t *dummy_output)
-{
-    // Write address
-    OPM_Write(chip, 0, addr);
-
-    for (uint32_t i = 0; i < REGISTER_WRITE_DELAY_CYCLES; i++)
-    {
-        OPM_Clock(chip, dummy_output, NULL, NULL, NULL);
-    }
-
-    // Write data
-    OPM_Write(chip, 1, data);
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
 
-    for (uint32_t i = 0; i < REGISTER_WRITE_DELAY_CYCLES; i++)
+// Write a register: the chip's write queue issues address and data as soon as
+// the busy flag allows, so clock the chip until it has
+void write_register(opm_t *chip, uint8_t addr, uint8_t data)
+{
+    OPM_QueueWrite(chip, addr, data);
+    while (OPM_QueuedWrites(chip))
     {
-        OPM_Clock(chip, dummy_output, NULL, NULL, NULL);
+        OPM_Clock(chip, NULL, NULL, NULL, NULL);
     }
 
     // Debug output for key register writes
@@ -48,8 +61,6 @@ void write_register_with_delay(opm_t *chip, uint8_t addr, uint8_t data, int32_t
 // Configure OPM for 440Hz tone on channel 0
 void configure_440hz_tone(opm_t *chip)
 {
-    int32_t dummy_output[2] = {0, 0};
-
     printf("  Writing registers...\n");
 
     int channel = 0;
@@ -57,21 +68,21 @@ void configure_440hz_tone(opm_t *chip)
     // Reset all channels (key off)
     for (int ch = 0; ch < 8; ch++)
     {
-        write_register_with_delay(chip, 0x08, ch, dummy_output);
+        write_register(chip, 0x08, ch);
     }
 
     // RL_FB_CONNECT: RL=11 (both L/R), FB=0, CON=7 (all carriers direct to output)
-    write_register_with_delay(chip, 0x20 + channel, 0xC7, dummy_output);
+    write_register(chip, 0x20 + channel, 0xC7);
 
     // Set frequency (440 Hz = A4)
     // KC (Key Code) for A4 (440Hz): 0x4A ※OPM_CLOCK 3579545 の場合のみ。違うときはKC/KFともに変更しないと違うピッチになる
-    write_register_with_delay(chip, 0x28 + channel, 0x4A, dummy_output);
+    write_register(chip, 0x28 + channel, 0x4A);
 
     // KF (Key Fraction)
-    write_register_with_delay(chip, 0x30 + channel, 0x00, dummy_output);
+    write_register(chip, 0x30 + channel, 0x00);
 
     // PMS/AMS (Phase/Amplitude Modulation Sensitivity)
-    write_register_with_delay(chip, 0x38 + channel, 0x00, dummy_output);
+    write_register(chip, 0x38 + channel, 0x00);
 
     // Configure all 4 operators for channel 0
     for (int op = 0; op < 4; op++)
@@ -79,38 +90,1329 @@ void configure_440hz_tone(opm_t *chip)
         int slot = channel + (op * 8);
 
         // DT1/MUL: DT1=0, MUL=1 (fundamental frequency)
-        write_register_with_delay(chip, 0x40 + slot, 0x01, dummy_output);
+        write_register(chip, 0x40 + slot, 0x01);
 
         // TL (Total Level) - 0x00 for op0 (max volume), 0x7F for others
         if (op == 0)
         {
-            write_register_with_delay(chip, 0x60 + slot, 0x00, dummy_output); // Max volume for carrier
+            write_register(chip, 0x60 + slot, 0x00); // Max volume for carrier
         }
         else
         {
-            write_register_with_delay(chip, 0x60 + slot, 0x7F, dummy_output); // Silent for others
+            write_register(chip, 0x60 + slot, 0x7F); // Silent for others
         }
 
         // KS/AR: KS=0, AR=31 (maximum attack rate)
-        write_register_with_delay(chip, 0x80 + slot, 0x1F, dummy_output);
+        write_register(chip, 0x80 + slot, 0x1F);
 
         // AMS/D1R: AMS=0, D1R=5
-        write_register_with_delay(chip, 0xA0 + slot, 0x05, dummy_output);
+        write_register(chip, 0xA0 + slot, 0x05);
 
         // DT2/D2R: DT2=0, D2R=5
-        write_register_with_delay(chip, 0xC0 + slot, 0x05, dummy_output);
+        write_register(chip, 0xC0 + slot, 0x05);
 
         // D1L/RR: D1L=15, RR=7
-        write_register_with_delay(chip, 0xE0 + slot, 0xF7, dummy_output);
+        write_register(chip, 0xE0 + slot, 0xF7);
     }
 
     printf("  Key ON channel 0, all operators...\n");
     // Key ON: trigger channel 0, all 4 operators (bits 6,5,4,3 = 0x78)
-    write_register_with_delay(chip, 0x08, 0x78 | channel, dummy_output);
+    write_register(chip, 0x08, 0x78 | channel);
 
     printf("  Configuration complete.\n");
 }
 
+// Render the same samples with OPM_Clock and compare them with the OPM_RenderSamples output
+int check_render_matches_clock(opm_t *chip, const int32_t *rendered, int num_samples)
+{
+    for (int i = 0; i < num_samples; i++)
+    {
+        int32_t output[2] = {0, 0};
+
+        // Clock the chip multiple times per sample
+        for (int j = 0; j < CYCLES_PER_SAMPLE; j++)
+        {
+            OPM_Clock(chip, output, NULL, NULL, NULL);
+        }
+
+        if (output[0] != rendered[i * 2] || output[1] != rendered[i * 2 + 1])
+        {
+            printf("❌ FAILED: Sample %d differs: OPM_Clock L=%d R=%d, OPM_RenderSamples L=%d R=%d\n",
+                   i, output[0], output[1], rendered[i * 2], rendered[i * 2 + 1]);
+            return 0;
+        }
+    }
+
+    printf("  All %d samples match.\n", num_samples);
+    return 1;
+}
+
+// Clock the multi-chip engine and its per-lane reference chips together
+void clock_multi_and_scalar(opm_multi_t *multi, opm_t *chips, int cycles)
+{
+    for (int i = 0; i < cycles; i++)
+    {
+        OPM_MultiClock(multi, NULL);
+        for (int lane = 0; lane < OPM_MULTI_LANES; lane++)
+        {
+            OPM_Clock(&chips[lane], NULL, NULL, NULL, NULL);
+        }
+    }
+}
+
+void write_multi_and_scalar(opm_multi_t *multi, opm_t *chips, int lane, uint8_t addr, uint8_t data)
+{
+    OPM_MultiWrite(multi, lane, 0, addr);
+    OPM_Write(&chips[lane], 0, addr);
+    clock_multi_and_scalar(multi, chips, REGISTER_WRITE_DELAY_CYCLES);
+    OPM_MultiWrite(multi, lane, 1, data);
+    OPM_Write(&chips[lane], 1, data);
+    clock_multi_and_scalar(multi, chips, REGISTER_WRITE_DELAY_CYCLES);
+}
+
+// Play a different patch on every lane of an opm_multi_t and compare each lane
+// with its own opm_t fed the same register writes
+int check_multi_matches_scalar(int num_samples)
+{
+    opm_multi_t *multi = (opm_multi_t *)malloc(sizeof(opm_multi_t));
+    opm_t *chips = (opm_t *)malloc(OPM_MULTI_LANES * sizeof(opm_t));
+    int32_t *buffer = (int32_t *)malloc((size_t)OPM_MULTI_LANES * num_samples * 2 * sizeof(int32_t));
+    int32_t *buffers[OPM_MULTI_LANES];
+    int ok = 1;
+    if (!multi || !chips || !buffer)
+    {
+        fprintf(stderr, "Failed to allocate multi-chip test buffers\n");
+        free(multi);
+        free(chips);
+        free(buffer);
+        return 0;
+    }
+
+    OPM_MultiReset(multi);
+    for (int lane = 0; lane < OPM_MULTI_LANES; lane++)
+    {
+        OPM_Reset(&chips[lane]);
+        buffers[lane] = buffer + (size_t)lane * num_samples * 2;
+    }
+
+    for (int lane = 0; lane < OPM_MULTI_LANES; lane++)
+    {
+        int channel = lane % 8;
+        // LFO rate/depth, noise and per-channel algorithm, feedback and pitch all differ per lane
+        write_multi_and_scalar(multi, chips, lane, 0x18, 0xC0 + lane * 5);
+        write_multi_and_scalar(multi, chips, lane, 0x19, 0x80 | (lane * 9));
+        write_multi_and_scalar(multi, chips, lane, 0x19, lane * 13);
+        write_multi_and_scalar(multi, chips, lane, 0x1B, lane & 3);
+        write_multi_and_scalar(multi, chips, lane, 0x0F, lane == 3 ? 0x8F : 0x00);
+        write_multi_and_scalar(multi, chips, lane, 0x20 + channel, 0xC0 | ((lane * 3) & 0x38) | (lane & 7));
+        write_multi_and_scalar(multi, chips, lane, 0x28 + channel, 0x3A + lane * 5);
+        write_multi_and_scalar(multi, chips, lane, 0x30 + channel, lane * 20);
+        write_multi_and_scalar(multi, chips, lane, 0x38 + channel, 0x11 * (lane & 3) + 0x40);
+        for (int op = 0; op < 4; op++)
+        {
+            int slot = channel + (op * 8);
+            write_multi_and_scalar(multi, chips, lane, 0x40 + slot, ((op + lane) & 7) << 4 | (1 + op + lane) % 16);
+            write_multi_and_scalar(multi, chips, lane, 0x60 + slot, op == 0 ? 0x00 : 0x10 + op * 6);
+            write_multi_and_scalar(multi, chips, lane, 0x80 + slot, (op << 6) | (0x1F - lane));
+            write_multi_and_scalar(multi, chips, lane, 0xA0 + slot, 0x80 | (0x05 + op));
+            write_multi_and_scalar(multi, chips, lane, 0xC0 + slot, (lane & 3) << 6 | 0x03);
+            write_multi_and_scalar(multi, chips, lane, 0xE0 + slot, 0x27 + op);
+        }
+        write_multi_and_scalar(multi, chips, lane, 0x08, 0x78 | channel);
+    }
+
+    OPM_MultiRenderSamples(multi, buffers, num_samples);
+    for (int lane = 0; lane < OPM_MULTI_LANES && ok; lane++)
+    {
+        int32_t *expected = (int32_t *)malloc(num_samples * 2 * sizeof(int32_t));
+        if (!expected)
+        {
+            fprintf(stderr, "Failed to allocate multi-chip test buffers\n");
+            ok = 0;
+            break;
+        }
+        OPM_RenderSamples(&chips[lane], expected, num_samples);
+        for (int i = 0; i < num_samples * 2; i++)
+        {
+            if (expected[i] != buffers[lane][i])
+            {
+                printf("❌ FAILED: Lane %d sample %d differs: opm_t %d, opm_multi_t %d\n",
+                       lane, i / 2, expected[i], buffers[lane][i]);
+                ok = 0;
+                break;
+            }
+        }
+        free(expected);
+    }
+
+    if (ok)
+    {
+        printf("  All %d lanes match over %d samples.\n", OPM_MULTI_LANES, num_samples);
+    }
+    free(multi);
+    free(chips);
+    free(buffer);
+    return ok;
+}
+
+// Clock the serial and word-level mixer chips one cycle and compare every output pin
+int clock_and_compare_mixers(opm_t *serial, opm_t *word, int sample)
+{
+    int32_t out_serial[2], out_word[2];
+    uint8_t sh1_serial, sh2_serial, so_serial, sh1_word, sh2_word, so_word;
+    OPM_Clock(serial, out_serial, &sh1_serial, &sh2_serial, &so_serial);
+    OPM_Clock(word, out_word, &sh1_word, &sh2_word, &so_word);
+    if (out_serial[0] != out_word[0] || out_serial[1] != out_word[1] ||
+        sh1_serial != sh1_word || sh2_serial != sh2_word || so_serial != so_word)
+    {
+        printf("❌ FAILED: Sample %d cycle %u differs: serial L=%d R=%d so=%d, word L=%d R=%d so=%d\n",
+               sample, serial->cycles, out_serial[0], out_serial[1], so_serial,
+               out_word[0], out_word[1], so_word);
+        return 0;
+    }
+    return 1;
+}
+
+// Write a register on both chips over one sample period, comparing every cycle
+int write_and_compare_mixers(opm_t *serial, opm_t *word, int sample, uint8_t addr, uint8_t data)
+{
+    int ok = 1;
+    OPM_Write(serial, 0, addr);
+    OPM_Write(word, 0, addr);
+    for (int j = 0; j < CYCLES_PER_SAMPLE / 2 && ok; j++)
+    {
+        ok = clock_and_compare_mixers(serial, word, sample);
+    }
+    OPM_Write(serial, 1, data);
+    OPM_Write(word, 1, data);
+    for (int j = 0; j < CYCLES_PER_SAMPLE / 2 && ok; j++)
+    {
+        ok = clock_and_compare_mixers(serial, word, sample);
+    }
+    return ok;
+}
+
+// Drive a serial-mixer chip and a word-mixer chip with the same register writes,
+// IC pulses and mixer switches, and compare their outputs every cycle. All eight
+// channels start as full-volume carriers so the mix clamps, then random writes,
+// noise and LFO settings vary it.
+int check_word_mixer_matches_serial(int num_samples)
+{
+    static const uint8_t random_regs[] = {0x08, 0x0F, 0x18, 0x19, 0x1B, 0x20, 0x28, 0x38, 0x40, 0x60, 0x80, 0xE0};
+    opm_t *serial = (opm_t *)malloc(sizeof(opm_t));
+    opm_t *word = (opm_t *)malloc(sizeof(opm_t));
+    uint32_t seed = 12345;
+    int clamped = 0;
+    int ok = 1;
+    if (!serial || !word)
+    {
+        fprintf(stderr, "Failed to allocate word mixer test chips\n");
+        free(serial);
+        free(word);
+        return 0;
+    }
+
+    OPM_Reset(serial);
+    OPM_Reset(word);
+    OPM_SetWordMixer(word, 1);
+
+    for (int i = 0; i < num_samples && ok; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        uint32_t r = seed >> 8;
+        if (i < 8 * 5)
+        {
+            // Channel i / 5: both outputs, algorithm 7, fast attack, key on
+            int channel = i / 5;
+            int step = i % 5;
+            if (step == 0)
+            {
+                ok = write_and_compare_mixers(serial, word, i, 0x20 + channel, 0xC7);
+            }
+            else if (step < 4)
+            {
+                for (int op = 0; op < 4 && ok; op++)
+                {
+                    uint8_t base = step == 1 ? 0x60 : step == 2 ? 0x80 : 0xE0;
+                    uint8_t data = step == 1 ? 0x00 : step == 2 ? 0x1F : 0x0F;
+                    ok = write_and_compare_mixers(serial, word, i, base + channel + op * 8, data);
+                }
+            }
+            else
+            {
+                ok = write_and_compare_mixers(serial, word, i, 0x08, 0x78 | channel);
+            }
+            continue;
+        }
+        if (r % 4 == 0)
+        {
+            uint8_t addr = random_regs[(r >> 2) % 12];
+            uint8_t data = (uint8_t)(r >> 12);
+            if (addr >= 0x40)
+            {
+                addr += (r >> 20) % 32;
+            }
+            else if (addr >= 0x20)
+            {
+                addr += (r >> 20) % 8;
+            }
+            if (addr >= 0x60 && addr < 0x80)
+            {
+                data &= 0x0F;
+            }
+            ok = write_and_compare_mixers(serial, word, i, addr, data);
+            continue;
+        }
+        if (r % 512 == 1)
+        {
+            // IC pulse of a few cycles to a few rounds, released at any cycle
+            OPM_SetIC(serial, 1);
+            OPM_SetIC(word, 1);
+            for (int j = 0; j < (int)(r >> 16) % 100 && ok; j++)
+            {
+                ok = clock_and_compare_mixers(serial, word, i);
+            }
+            OPM_SetIC(serial, 0);
+            OPM_SetIC(word, 0);
+        }
+        if (r % 256 == 2)
+        {
+            OPM_SetWordMixer(word, (r >> 9) & 1);
+        }
+        for (int j = 0; j < CYCLES_PER_SAMPLE && ok; j++)
+        {
+            ok = clock_and_compare_mixers(serial, word, i);
+        }
+        if (serial->mix_frame[0] == 0 || serial->mix_frame[0] == 0xFFFF)
+        {
+            clamped++;
+        }
+    }
+
+    if (ok)
+    {
+        printf("  All %d samples match (%d with a clamped left channel).\n", num_samples, clamped);
+    }
+    free(serial);
+    free(word);
+    return ok;
+}
+
+// Clock an opm_t and lane 0 of an opm_multi_t (which never goes idle) and
+// compare outputs and status every cycle. Returns the idle cycle count, or -1
+int clock_and_compare_idle(opm_t *chip, opm_multi_t *multi, int cycles, int phrase)
+{
+    int idle_cycles = 0;
+    for (int j = 0; j < cycles; j++)
+    {
+        int32_t out[2], out_multi[2 * OPM_MULTI_LANES];
+        OPM_Clock(chip, out, NULL, NULL, NULL);
+        OPM_MultiClock(multi, out_multi);
+        if (out[0] != out_multi[0] || out[1] != out_multi[1] ||
+            OPM_Read(chip, 0) != OPM_MultiRead(multi, 0, 0))
+        {
+            printf("❌ FAILED: Phrase %d cycle %d differs (idle %d): opm_t L=%d R=%d status=%02X, opm_multi_t L=%d R=%d status=%02X\n",
+                   phrase, j, chip->idle, out[0], out[1], OPM_Read(chip, 0),
+                   out_multi[0], out_multi[1], OPM_MultiRead(multi, 0, 0));
+            return -1;
+        }
+        if (chip->idle == OPM_IDLE)
+        {
+            idle_cycles++;
+        }
+    }
+    return idle_cycles;
+}
+
+// Write a register on both chips, the data an odd number of cycles after the address
+int write_and_compare_idle(opm_t *chip, opm_multi_t *multi, int phrase, uint8_t addr, uint8_t data)
+{
+    int idle_a, idle_d;
+    OPM_Write(chip, 0, addr);
+    OPM_MultiWrite(multi, 0, 0, addr);
+    idle_a = clock_and_compare_idle(chip, multi, 37, phrase);
+    OPM_Write(chip, 1, data);
+    OPM_MultiWrite(multi, 0, 1, data);
+    idle_d = clock_and_compare_idle(chip, multi, 37, phrase);
+    return idle_a < 0 || idle_d < 0 ? -1 : idle_a + idle_d;
+}
+
+// Play phrases separated by rests on an opm_t, which fast-forwards through the
+// silent stretches, and on an opm_multi_t lane, which clocks every stage. Rests
+// are broken by writes at arbitrary cycles, and timer A and PM LFO keep running
+// through them on some phrases.
+int check_idle_matches_full(int num_phrases)
+{
+    opm_t *chip = (opm_t *)malloc(sizeof(opm_t));
+    opm_multi_t *multi = (opm_multi_t *)malloc(sizeof(opm_multi_t));
+    uint32_t seed = 4242;
+    int idle_cycles = 0;
+    int ok = 1;
+    if (!chip || !multi)
+    {
+        fprintf(stderr, "Failed to allocate idle test chips\n");
+        free(chip);
+        free(multi);
+        return 0;
+    }
+
+    OPM_Reset(chip);
+    OPM_MultiReset(multi);
+
+    for (int phrase = 0; phrase < num_phrases && ok; phrase++)
+    {
+        int channel = phrase % 8;
+        int n = 0;
+        int result;
+        uint8_t regs[] = {
+            0x20 + channel, 0xC7,
+            0x28 + channel, 0x30 + phrase * 3,
+            0x38 + channel, phrase & 1 ? 0x70 : 0x00,
+            0x18, 0xC0 + phrase,
+            0x19, phrase & 1 ? 0xC0 : 0x80,
+            0x10, 0xF0 + phrase,
+            0x14, phrase & 2 ? 0x35 : 0x30,
+            0x60 + channel, 0x00,
+            0x80 + channel, 0x1F,
+            0xE0 + channel, 0x0F,
+            0x08, 0x08 | channel,
+        };
+        seed = seed * 1103515245 + 12345;
+        for (int i = 0; i < (int)sizeof(regs) && ok; i += 2)
+        {
+            result = write_and_compare_idle(chip, multi, phrase, regs[i], regs[i + 1]);
+            ok = result >= 0;
+            n += ok ? result : 0;
+        }
+        // Hold, key off, then rest with a write somewhere in the middle
+        result = ok ? clock_and_compare_idle(chip, multi, 2000 + (seed >> 8) % 3000, phrase) : -1;
+        ok = ok && result >= 0 && write_and_compare_idle(chip, multi, phrase, 0x08, channel) >= 0;
+        n += ok ? result : 0;
+        result = ok ? clock_and_compare_idle(chip, multi, 30000 + (seed >> 12) % 5000, phrase) : -1;
+        ok = ok && result >= 0 && write_and_compare_idle(chip, multi, phrase, 0x30 + channel, (uint8_t)seed) >= 0;
+        n += ok ? result : 0;
+        result = ok ? clock_and_compare_idle(chip, multi, 5000 + (seed >> 16) % 2000, phrase) : -1;
+        ok = ok && result >= 0;
+        idle_cycles += n + (ok ? result : 0);
+    }
+
+    if (ok && idle_cycles == 0)
+    {
+        printf("❌ FAILED: The chip never went idle during the rests\n");
+        ok = 0;
+    }
+    if (ok)
+    {
+        printf("  All %d phrases match (%d idle cycles).\n", num_phrases, idle_cycles);
+    }
+    free(chip);
+    free(multi);
+    return ok;
+}
+
+// Save a playing chip mid-round, keep rendering, then load the state into a
+// scrambled chip and check it renders the same. Damaged states must be rejected
+// without touching the chip.
+int check_state_restores(const opm_t *configured, int num_samples)
+{
+    opm_t *chip = (opm_t *)malloc(sizeof(opm_t));
+    opm_t *restored = (opm_t *)malloc(sizeof(opm_t));
+    uint8_t *state = (uint8_t *)malloc(OPM_STATE_MAX_SIZE);
+    int32_t *expected = (int32_t *)malloc(num_samples * 2 * sizeof(int32_t));
+    int32_t *actual = (int32_t *)malloc(num_samples * 2 * sizeof(int32_t));
+    int ok = 1;
+    if (!chip || !restored || !state || !expected || !actual)
+    {
+        fprintf(stderr, "Failed to allocate state test buffers\n");
+        free(chip);
+        free(restored);
+        free(state);
+        free(expected);
+        free(actual);
+        return 0;
+    }
+
+    *chip = *configured;
+    OPM_RenderSamples(chip, expected, 1000);
+    for (int j = 0; j < 21; j++)
+    {
+        OPM_Clock(chip, NULL, NULL, NULL, NULL);
+    }
+    size_t size = OPM_SaveState(chip, state, OPM_STATE_MAX_SIZE);
+    OPM_RenderSamples(chip, expected, num_samples);
+
+    memset(restored, 0xAA, sizeof(opm_t));
+    if (size == 0 || size > OPM_STATE_MAX_SIZE)
+    {
+        printf("❌ FAILED: OPM_SaveState returned %zu bytes\n", size);
+        ok = 0;
+    }
+    else if (!OPM_LoadState(restored, state, size))
+    {
+        printf("❌ FAILED: Saved state (%zu bytes) did not load\n", size);
+        ok = 0;
+    }
+    if (ok)
+    {
+        OPM_RenderSamples(restored, actual, num_samples);
+        for (int i = 0; i < num_samples * 2; i++)
+        {
+            if (expected[i] != actual[i])
+            {
+                printf("❌ FAILED: Restored sample %d differs: expected %d, got %d\n", i / 2, expected[i], actual[i]);
+                ok = 0;
+                break;
+            }
+        }
+    }
+
+    if (ok)
+    {
+        *restored = *chip;
+        int truncated = OPM_LoadState(restored, state, size - 1);
+        state[size / 2] ^= 0x10;
+        int corrupted = OPM_LoadState(restored, state, size);
+        state[size / 2] ^= 0x10;
+        state[4] ^= 0x01;
+        int wrong_version = OPM_LoadState(restored, state, size);
+        state[4] ^= 0x01;
+        if (truncated || corrupted || wrong_version || memcmp(restored, chip, sizeof(opm_t)) != 0)
+        {
+            printf("❌ FAILED: Damaged state accepted or chip modified (truncated %d, corrupted %d, version %d)\n",
+                   truncated, corrupted, wrong_version);
+            ok = 0;
+        }
+    }
+
+    if (ok)
+    {
+        printf("  Restored state (%zu of %zu bytes) renders the same %d samples.\n",
+               size, sizeof(opm_t), num_samples);
+    }
+    free(chip);
+    free(restored);
+    free(state);
+    free(expected);
+    free(actual);
+    return ok;
+}
+
+// Register state set by writes, including which operators are keyed on
+int registers_match(const opm_t *a, const opm_t *b)
+{
+    return memcmp(a->ch_rl, b->ch_rl, sizeof(a->ch_rl)) == 0 && memcmp(a->ch_fb, b->ch_fb, sizeof(a->ch_fb)) == 0 &&
+           memcmp(a->ch_connect, b->ch_connect, sizeof(a->ch_connect)) == 0 &&
+           memcmp(a->ch_kc, b->ch_kc, sizeof(a->ch_kc)) == 0 && memcmp(a->ch_kf, b->ch_kf, sizeof(a->ch_kf)) == 0 &&
+           memcmp(a->ch_pms, b->ch_pms, sizeof(a->ch_pms)) == 0 && memcmp(a->ch_ams, b->ch_ams, sizeof(a->ch_ams)) == 0 &&
+           memcmp(a->sl_dt1, b->sl_dt1, sizeof(a->sl_dt1)) == 0 && memcmp(a->sl_mul, b->sl_mul, sizeof(a->sl_mul)) == 0 &&
+           memcmp(a->sl_tl, b->sl_tl, sizeof(a->sl_tl)) == 0 && memcmp(a->sl_ks, b->sl_ks, sizeof(a->sl_ks)) == 0 &&
+           memcmp(a->sl_ar, b->sl_ar, sizeof(a->sl_ar)) == 0 && memcmp(a->sl_am_e, b->sl_am_e, sizeof(a->sl_am_e)) == 0 &&
+           memcmp(a->sl_d1r, b->sl_d1r, sizeof(a->sl_d1r)) == 0 && memcmp(a->sl_dt2, b->sl_dt2, sizeof(a->sl_dt2)) == 0 &&
+           memcmp(a->sl_d2r, b->sl_d2r, sizeof(a->sl_d2r)) == 0 && memcmp(a->sl_d1l, b->sl_d1l, sizeof(a->sl_d1l)) == 0 &&
+           memcmp(a->sl_rr, b->sl_rr, sizeof(a->sl_rr)) == 0 && memcmp(a->mode_kon, b->mode_kon, sizeof(a->mode_kon)) == 0 &&
+           a->noise_en == b->noise_en && a->noise_freq == b->noise_freq && a->lfo_pmd == b->lfo_pmd &&
+           a->lfo_amd == b->lfo_amd && a->lfo_wave == b->lfo_wave && a->lfo_freq_hi == b->lfo_freq_hi &&
+           a->lfo_freq_lo == b->lfo_freq_lo && a->timer_a_reg == b->timer_a_reg && a->timer_b_reg == b->timer_b_reg;
+}
+
+// Load random patches on all channels and key them on, once with fixed
+// REGISTER_WRITE_DELAY_CYCLES delays and once through the write queue, and
+// check the queue sets the same registers in a fraction of the cycles
+int check_write_queue_matches_delayed(int num_bursts)
+{
+    static const uint8_t slot_regs[] = {0x40, 0x60, 0x80, 0xA0, 0xC0, 0xE0};
+    static const uint8_t mode_regs[] = {0x0F, 0x10, 0x11, 0x12, 0x18, 0x19, 0x1B};
+    uint8_t addrs[8 * 4 + 32 * 6 + 7 + 8], values[sizeof(addrs)];
+    opm_t *delayed = (opm_t *)malloc(sizeof(opm_t));
+    opm_t *queued = (opm_t *)malloc(sizeof(opm_t));
+    uint32_t seed = 777;
+    long delayed_cycles = 0, queued_cycles = 0;
+    int ok = 1;
+    if (!delayed || !queued)
+    {
+        fprintf(stderr, "Failed to allocate write queue test chips\n");
+        free(delayed);
+        free(queued);
+        return 0;
+    }
+
+    OPM_Reset(delayed);
+    OPM_Reset(queued);
+    for (int burst = 0; burst < num_bursts && ok; burst++)
+    {
+        int n = 0;
+        for (int i = 0; i < 7; i++)
+        {
+            addrs[n++] = mode_regs[i];
+        }
+        for (int ch = 0; ch < 8; ch++)
+        {
+            for (int reg = 0; reg < 4; reg++)
+            {
+                addrs[n++] = 0x20 + reg * 8 + ch;
+            }
+        }
+        for (int slot = 0; slot < 32; slot++)
+        {
+            for (int reg = 0; reg < 6; reg++)
+            {
+                addrs[n++] = slot_regs[reg] + slot;
+            }
+        }
+        for (int i = 0; i < n; i++)
+        {
+            seed = seed * 1103515245 + 12345;
+            values[i] = (uint8_t)(seed >> 16);
+        }
+        // Key on every channel with a different operator mask, back to back
+        for (int ch = 0; ch < 8; ch++)
+        {
+            seed = seed * 1103515245 + 12345;
+            addrs[n] = 0x08;
+            values[n++] = (uint8_t)(((seed >> 16) & 0x78) | ch);
+        }
+
+        for (int i = 0; i < n; i++)
+        {
+            OPM_Write(delayed, 0, addrs[i]);
+            for (int j = 0; j < REGISTER_WRITE_DELAY_CYCLES; j++)
+            {
+                OPM_Clock(delayed, NULL, NULL, NULL, NULL);
+            }
+            OPM_Write(delayed, 1, values[i]);
+            for (int j = 0; j < REGISTER_WRITE_DELAY_CYCLES; j++)
+            {
+                OPM_Clock(delayed, NULL, NULL, NULL, NULL);
+            }
+            delayed_cycles += 2 * REGISTER_WRITE_DELAY_CYCLES;
+        }
+
+        // Start each burst at a different cycle of the round
+        for (int j = 0; j < burst * 5; j++)
+        {
+            OPM_Clock(queued, NULL, NULL, NULL, NULL);
+        }
+        int next = 0;
+        while (next < n || OPM_QueuedWrites(queued))
+        {
+            while (next < n && OPM_QueueWrite(queued, addrs[next], values[next]))
+            {
+                next++;
+            }
+            OPM_Clock(queued, NULL, NULL, NULL, NULL);
+            queued_cycles++;
+        }
+        // Let the last data write land
+        for (int j = 0; j < 64; j++)
+        {
+            OPM_Clock(queued, NULL, NULL, NULL, NULL);
+        }
+
+        if (!registers_match(delayed, queued))
+        {
+            printf("❌ FAILED: Burst %d of %d writes left different registers through the write queue\n", burst, n);
+            ok = 0;
+        }
+    }
+
+    if (ok)
+    {
+        printf("  All %d bursts match: %ld cycles with fixed delays, %ld queued (%.1fx faster).\n",
+               num_bursts, delayed_cycles, queued_cycles, (double)delayed_cycles / queued_cycles);
+    }
+    free(delayed);
+    free(queued);
+    return ok;
+}
+
+// Reference bit-serial envelope timer, stepped with the inputs the chip's
+// own timer sees each cycle (the EG clock bit, IC and the delayed IC)
+typedef struct
+{
+    uint32_t timer;
+    uint32_t timer2;
+    uint8_t carry;
+    uint8_t bstop;
+    uint8_t shift_lock;
+    uint8_t timer_lock;
+} eg_timer_model_t;
+
+void eg_timer_model_step(eg_timer_model_t *m, uint32_t cycles, uint8_t clock, uint8_t ic, uint8_t ic2)
+{
+    uint32_t cycle = (cycles + 31) % 16;
+    uint32_t cycle2 = (cycles + 30) % 16;
+    uint8_t inc = ((cycles + 31) % 32) < 16 && clock && (cycle == 0 || m->carry);
+    uint8_t sum = ((m->timer >> cycle) & 1) + inc;
+    m->carry = sum >> 1;
+    m->timer = (m->timer & ~(1u << cycle)) | ((uint32_t)((sum & 1) && !ic) << cycle);
+
+    m->timer2 = (m->timer2 << 1) | ((m->timer >> cycle2) & 1 & !m->bstop);
+    m->bstop |= (m->timer >> cycle2) & 1;
+    if (cycle == 0 || ic2)
+    {
+        m->bstop = 0;
+    }
+
+    if (cycles == 1 && clock)
+    {
+        static const uint32_t masks[4] = {8 + 32 + 128 + 512 + 2048 + 8192 + 32768, 4 + 32 + 64 + 512 + 1024 + 8192 + 16384,
+                                          4 + 8 + 16 + 512 + 1024 + 2048 + 4096, 4 + 8 + 16 + 32 + 64 + 128 + 256};
+        m->shift_lock = 0;
+        for (int i = 0; i < 4; i++)
+        {
+            m->shift_lock |= (m->timer2 & masks[i]) ? 1 << i : 0;
+        }
+        m->timer_lock = (uint8_t)m->timer;
+    }
+}
+
+// Run chips from envelope timer values just below multiples of 0x4000, with random EG test mode
+// toggles (register 0x01 bit 0 forces the EG clock), short IC pulses and
+// note traffic, and compare the chip's timer locks with the reference
+// bit-serial timer every cycle (and the timer itself outside its add window)
+int check_eg_timer_matches_serial(int num_segments, int rounds_per_segment)
+{
+    opm_t *chip = (opm_t *)malloc(sizeof(opm_t));
+    uint32_t seed = 2151;
+    int ok = 1;
+    if (!chip)
+    {
+        fprintf(stderr, "Failed to allocate envelope timer test chip\n");
+        return 0;
+    }
+
+    for (int segment = 0; segment < num_segments && ok; segment++)
+    {
+        eg_timer_model_t model;
+        uint32_t ic_cycles = 0;
+
+        OPM_Reset(chip);
+        // Start a little before a multiple of 0x4000, so the adds carry into
+        // the top bits and the lowest set bit reaches 13-15
+        seed = seed * 1103515245 + 12345;
+        chip->eg_timer = (segment * 0x4000 - (seed >> 8) % 1024) & 0xffff; // The reset leaves the timer serial
+        model.timer = chip->eg_timer;
+        model.timer2 = chip->eg_timer2;
+        model.carry = chip->eg_timercarry;
+        model.bstop = chip->eg_timerbstop;
+        model.shift_lock = chip->eg_timershift_lock;
+        model.timer_lock = chip->eg_timer_lock;
+
+        for (long n = 0; n < (long)rounds_per_segment * 32 && ok; n++)
+        {
+            seed = seed * 1103515245 + 12345;
+            uint32_t r = seed >> 8;
+            if (ic_cycles)
+            {
+                if (--ic_cycles == 0)
+                {
+                    OPM_SetIC(chip, 0);
+                }
+            }
+            else if (r % 6000 == 0)
+            {
+                ic_cycles = 1 + (r >> 13) % 40;
+                OPM_SetIC(chip, 1);
+            }
+            else if (r % 6000 == 3)
+            {
+                OPM_SetIC(chip, 1); // Pulse between two cycles: only the jump to cycle 0
+                OPM_SetIC(chip, 0);
+            }
+            else if (r % 500 == 1 && !OPM_QueuedWrites(chip))
+            {
+                OPM_QueueWrite(chip, 0x01, (r >> 12) % 4 == 0); // EG test mode on a quarter of the time
+            }
+            else if (r % 500 == 2 && !OPM_QueuedWrites(chip))
+            {
+                OPM_QueueWrite(chip, 0x08, (uint8_t)((r >> 12) & 0x7f));
+            }
+
+            uint32_t cycles = chip->cycles;
+            eg_timer_model_step(&model, cycles, chip->eg_clock & 1, chip->ic, chip->ic2);
+            OPM_Clock(chip, NULL, NULL, NULL, NULL);
+
+            int window = cycles >= 1 && cycles <= 15; // Add still rippling through the serial timer
+            if (chip->eg_timershift_lock != model.shift_lock || chip->eg_timer_lock != model.timer_lock ||
+                (!window && chip->eg_timer != model.timer))
+            {
+                printf("❌ FAILED: Segment %d cycle %ld (round cycle %u): timer %04X locks %u/%02X, serial %04X locks %u/%02X\n",
+                       segment, n, cycles, chip->eg_timer, chip->eg_timershift_lock, chip->eg_timer_lock, model.timer,
+                       model.shift_lock, model.timer_lock);
+                ok = 0;
+            }
+        }
+    }
+
+    if (ok)
+    {
+        printf("  All %d segments of %d rounds match the bit-serial envelope timer.\n", num_segments, rounds_per_segment);
+    }
+    free(chip);
+    return ok;
+}
+
+// Reference bit-serial LFO multiplier: the waveform bits the chip decodes
+// from its (serial) LFO counters each cycle, multiplied by the AM or PM depth
+// one bit per cycle, and the locks taken from the result
+typedef struct
+{
+    uint32_t out1;
+    uint32_t out2;
+    uint32_t out2_b;
+    uint8_t carry;
+    uint8_t am_lock;
+    uint8_t pm_lock;
+} lfo_mult_model_t;
+
+void lfo_mult_model_step(lfo_mult_model_t *m, const opm_t *chip, uint32_t cycles)
+{
+    uint8_t ampm_sel = (chip->lfo_bit_counter & 8) != 0;
+    uint8_t dp = ampm_sel ? chip->lfo_pmd : chip->lfo_amd;
+    uint32_t k = chip->lfo_bit_counter & 7;
+    uint8_t bit = k < 7 && ((dp >> (6 - k)) & 1) && !((m->out1 >> (6 - k)) & 1);
+    uint8_t b1 = k != 0 && (m->out2 & 1);
+    uint8_t b2 = cycles % 16 != 15 && m->carry;
+    uint8_t sum = bit + b1 + b2;
+    m->out2_b = m->out2;
+    m->out2 = (m->out2 >> 1) | ((uint32_t)(sum & 1) << 15);
+    m->carry = sum >> 1;
+
+    uint8_t trig_sign = chip->lfo_trig_sign, saw_sign = chip->lfo_saw_sign;
+    if ((cycles & 15) == 15)
+    {
+        trig_sign = (chip->lfo_val & 0x80) != 0;
+        saw_sign = (chip->lfo_val & 0x100) != 0;
+    }
+    uint8_t w4 = chip->lfo_clock_lock && chip->lfo_wave == 3;
+    uint8_t w3 = !chip->ic && !chip->mode_test[1] && !w4 && (chip->lfo_val & 0x8000) != 0;
+    uint8_t w5 = ampm_sel ? saw_sign : (chip->lfo_wave != 2 || !trig_sign);
+    uint8_t w9 = ampm_sel ? ((cycles % 16) == 6) : !saw_sign;
+    uint8_t w8 = (chip->lfo_wave == 1 ? w9 : (w5 ^ w3)) && ((cycles + 1) % 16) < 8;
+    m->out1 = (m->out1 << 1) | !w8;
+
+    if (cycles % 16 == 15 && k == 7)
+    {
+        if (ampm_sel)
+        {
+            m->pm_lock = ((m->out2_b >> 8) & 255) ^ ((chip->lfo_wave == 2 ? trig_sign : saw_sign) << 7);
+        }
+        else
+        {
+            m->am_lock = (m->out2_b >> 8) & 255;
+        }
+    }
+}
+
+// Run a chip with random LFO rates, depths and waveforms, written through the
+// queue (landing at any cycle) or poked between cycles, with LFO test bits,
+// IC pulses and jumps, and compare its AM and PM locks with the reference
+// bit-serial multiplier every cycle
+int check_lfo_matches_serial(int num_segments, int rounds_per_segment)
+{
+    opm_t *chip = (opm_t *)malloc(sizeof(opm_t));
+    uint32_t seed = 1982;
+    long locks = 0;
+    int ok = 1;
+    if (!chip)
+    {
+        fprintf(stderr, "Failed to allocate LFO test chip\n");
+        return 0;
+    }
+
+    for (int segment = 0; segment < num_segments && ok; segment++)
+    {
+        lfo_mult_model_t model;
+        uint32_t ic_cycles = 0;
+
+        OPM_Reset(chip); // Leaves the multiplier at the start of a word
+        model.out1 = chip->lfo_out1;
+        model.out2 = chip->lfo_out2;
+        model.out2_b = chip->lfo_out2_b;
+        model.carry = chip->lfo_mult_carry;
+        model.am_lock = chip->lfo_am_lock;
+        model.pm_lock = chip->lfo_pm_lock;
+        OPM_PokeRegister(chip, 0x18, 0xc0 + segment * 3);
+        OPM_PokeRegister(chip, 0x1b, segment & 3);
+
+        for (long n = 0; n < (long)rounds_per_segment * 32 && ok; n++)
+        {
+            seed = seed * 1103515245 + 12345;
+            uint32_t r = seed >> 8;
+            uint8_t value = (uint8_t)(r >> 12);
+            if (ic_cycles)
+            {
+                if (--ic_cycles == 0)
+                {
+                    OPM_SetIC(chip, 0);
+                }
+            }
+            else if (r % 4000 == 0)
+            {
+                ic_cycles = 1 + (r >> 15) % 40;
+                OPM_SetIC(chip, 1);
+            }
+            else if (r % 1000 == 3)
+            {
+                OPM_SetIC(chip, 1); // Pulse between two cycles: only the jump to cycle 0
+                OPM_SetIC(chip, 0);
+            }
+            else if (r % 300 == 1)
+            {
+                OPM_PokeRegister(chip, 0x19, value & 0x80 ? value : value % 3 == 0 ? 0 : value); // Depth 0 a third of the time
+            }
+            else if (r % 300 == 2 && !OPM_QueuedWrites(chip))
+            {
+                OPM_QueueWrite(chip, 0x19, value);
+            }
+            else if (r % 3000 == 4 && !OPM_QueuedWrites(chip))
+            {
+                OPM_QueueWrite(chip, 0x18, value);
+            }
+            else if (r % 3000 == 5 && !OPM_QueuedWrites(chip))
+            {
+                OPM_QueueWrite(chip, 0x1b, value & 3);
+            }
+            else if (r % 5000 == 6 && !OPM_QueuedWrites(chip))
+            {
+                OPM_QueueWrite(chip, 0x01, (r >> 14) % 4 == 0 ? value & 0x0e : 0); // LFO test bits a quarter of the time
+            }
+
+            uint32_t cycles = chip->cycles;
+            lfo_mult_model_step(&model, chip, cycles);
+            OPM_Clock(chip, NULL, NULL, NULL, NULL);
+            locks += cycles % 16 == 15 && (chip->lfo_bit_counter & 7) == 7;
+
+            if (chip->lfo_am_lock != model.am_lock || chip->lfo_pm_lock != model.pm_lock)
+            {
+                printf("❌ FAILED: Segment %d cycle %ld (round cycle %u): locks AM %02X PM %02X, serial AM %02X PM %02X\n",
+                       segment, n, cycles, chip->lfo_am_lock, chip->lfo_pm_lock, model.am_lock, model.pm_lock);
+                ok = 0;
+            }
+        }
+    }
+
+    if (ok)
+    {
+        printf("  All %d segments of %d rounds (%ld locks) match the bit-serial LFO multiplier.\n", num_segments,
+               rounds_per_segment, locks);
+    }
+    free(chip);
+    return ok;
+}
+
+// Play random notes with random pitch, detune, multiply, key scaling, rate,
+// AM sensitivity and LFO depth writes (queued, so they land at any cycle, or
+// poked between cycles) and IC pulses on two chips, one of which has every
+// cached phase increment and envelope rate marked stale before each cycle;
+// increments, key codes, envelopes and output must match
+int check_register_caches_match_recompute(int num_rounds)
+{
+    opm_t *cached = (opm_t *)malloc(sizeof(opm_t));
+    opm_t *fresh = (opm_t *)malloc(sizeof(opm_t));
+    uint32_t seed = 3579;
+    int ok = 1;
+    if (!cached || !fresh)
+    {
+        fprintf(stderr, "Failed to allocate register cache test chips\n");
+        free(cached);
+        free(fresh);
+        return 0;
+    }
+
+    OPM_Reset(cached);
+    OPM_Reset(fresh);
+    for (int slot = 0; slot < 32; slot++)
+    {
+        OPM_PokeRegister(cached, 0x60 + slot, 0x10);
+        OPM_PokeRegister(fresh, 0x60 + slot, 0x10);
+        OPM_PokeRegister(cached, 0x80 + slot, 0x1f);
+        OPM_PokeRegister(fresh, 0x80 + slot, 0x1f);
+    }
+    OPM_PokeRegister(cached, 0x18, 0xd0);
+    OPM_PokeRegister(fresh, 0x18, 0xd0);
+
+    for (long n = 0; n < (long)num_rounds * 32 && ok; n++)
+    {
+        seed = seed * 1103515245 + 12345;
+        uint32_t r = seed >> 8;
+        uint8_t value = (uint8_t)(r >> 12);
+        uint8_t address = 0;
+        switch (r % 64)
+        {
+        case 0:
+            address = 0x28 + (r >> 20) % 8; // KC
+            break;
+        case 1:
+            address = 0x30 + (r >> 20) % 8; // KF
+            break;
+        case 2:
+            address = 0x38 + (r >> 20) % 8; // PMS, AMS
+            break;
+        case 3:
+            address = 0x40 + (r >> 20) % 32; // DT1, MUL
+            break;
+        case 4:
+            address = 0xc0 + (r >> 20) % 32; // DT2, D2R
+            break;
+        case 5:
+            address = 0x19; // PM or AM depth
+            break;
+        case 6:
+            address = 0x08; // Key on/off, restarting phases
+            value &= 0x7f;
+            break;
+        case 7:
+            address = 0x80 + (r >> 20) % 32; // KS, AR
+            break;
+        case 8:
+            address = 0xa0 + (r >> 20) % 32; // AMS-EN, D1R
+            break;
+        case 9:
+            address = 0xe0 + (r >> 20) % 32; // D1L, RR
+            break;
+        }
+        if (address && (r >> 10) % 4 == 0)
+        {
+            OPM_PokeRegister(cached, address, value);
+            OPM_PokeRegister(fresh, address, value);
+        }
+        else if (address && !OPM_QueuedWrites(cached))
+        {
+            OPM_QueueWrite(cached, address, value);
+            OPM_QueueWrite(fresh, address, value);
+        }
+        else if (r % 50000 == 7)
+        {
+            OPM_SetIC(cached, 1);
+            OPM_SetIC(fresh, 1);
+            for (int i = 0; i < 64; i++)
+            {
+                fresh->pg_fnum_dirty = fresh->pg_inc_dirty = fresh->eg_rate_dirty = 0xffffffff;
+                OPM_Clock(cached, NULL, NULL, NULL, NULL);
+                OPM_Clock(fresh, NULL, NULL, NULL, NULL);
+            }
+            OPM_SetIC(cached, 0);
+            OPM_SetIC(fresh, 0);
+        }
+
+        int32_t out_cached[2], out_fresh[2];
+        fresh->pg_fnum_dirty = fresh->pg_inc_dirty = fresh->eg_rate_dirty = 0xffffffff;
+        OPM_Clock(cached, out_cached, NULL, NULL, NULL);
+        OPM_Clock(fresh, out_fresh, NULL, NULL, NULL);
+        if (memcmp(cached->pg_inc, fresh->pg_inc, sizeof(cached->pg_inc)) != 0 ||
+            memcmp(cached->pg_fnum, fresh->pg_fnum, sizeof(cached->pg_fnum)) != 0 ||
+            memcmp(cached->pg_kcode, fresh->pg_kcode, sizeof(cached->pg_kcode)) != 0 ||
+            memcmp(cached->eg_level, fresh->eg_level, sizeof(cached->eg_level)) != 0 || cached->eg_am != fresh->eg_am ||
+            out_cached[0] != out_fresh[0] || out_cached[1] != out_fresh[1])
+        {
+            int slot = 0;
+            while (slot < 31 && cached->pg_inc[slot] == fresh->pg_inc[slot] && cached->pg_fnum[slot] == fresh->pg_fnum[slot] &&
+                   cached->pg_kcode[slot] == fresh->pg_kcode[slot] && cached->eg_level[slot] == fresh->eg_level[slot])
+            {
+                slot++;
+            }
+            printf("❌ FAILED: Cycle %ld: output %d/%d, slot %d increment %05X fnum %03X kcode %02X level %03X; "
+                   "recomputed %d/%d, %05X %03X %02X %03X\n",
+                   n, out_cached[0], out_cached[1], slot, cached->pg_inc[slot], cached->pg_fnum[slot], cached->pg_kcode[slot],
+                   cached->eg_level[slot], out_fresh[0], out_fresh[1], fresh->pg_inc[slot], fresh->pg_fnum[slot],
+                   fresh->pg_kcode[slot], fresh->eg_level[slot]);
+            ok = 0;
+        }
+    }
+
+    if (ok)
+    {
+        printf("  All %d rounds match recomputing every increment and rate each cycle.\n", num_rounds);
+    }
+    free(cached);
+    free(fresh);
+    return ok;
+}
+
+// Set the same registers (mode, channel, operator, then key on for every
+// channel) with OPM_PokeRegister on one chip and through the write queue on
+// another; once the writes are through, every register must match
+int check_poke_matches_write(int num_rounds)
+{
+    static const uint8_t slot_regs[] = {0x40, 0x60, 0x80, 0xA0, 0xC0, 0xE0};
+    static const uint8_t mode_regs[] = {0x0F, 0x10, 0x11, 0x12, 0x18, 0x19, 0x1B};
+    opm_t *poked = (opm_t *)malloc(sizeof(opm_t));
+    opm_t *written = (opm_t *)malloc(sizeof(opm_t));
+    uint32_t seed = 4242;
+    int ok = 1;
+    if (!poked || !written)
+    {
+        fprintf(stderr, "Failed to allocate poke test chips\n");
+        free(poked);
+        free(written);
+        return 0;
+    }
+
+    OPM_Reset(poked);
+    OPM_Reset(written);
+    for (int round = 0; round < num_rounds && ok; round++)
+    {
+        int n = 0;
+        for (int i = 0; i < 7 + 8 * 4 + 32 * 6 + 8; i++, n++)
+        {
+            uint8_t addr = i < 7                   ? mode_regs[i]
+                           : i < 7 + 32            ? (uint8_t)(0x20 + (i - 7))
+                           : i < 7 + 32 + 32 * 6   ? (uint8_t)(slot_regs[(i - 39) % 6] + (i - 39) / 6)
+                                                   : 0x08;
+            seed = seed * 1103515245 + 12345;
+            uint8_t value = addr == 0x08 ? (uint8_t)(((seed >> 16) & 0x78) | (i - 231)) : (uint8_t)(seed >> 16);
+
+            OPM_PokeRegister(poked, addr, value);
+            OPM_QueueWrite(written, addr, value);
+            while (OPM_QueuedWrites(written))
+            {
+                OPM_Clock(written, NULL, NULL, NULL, NULL);
+            }
+        }
+        // Let the last write and key on reach every slot
+        for (int i = 0; i < 64; i++)
+        {
+            OPM_Clock(poked, NULL, NULL, NULL, NULL);
+            OPM_Clock(written, NULL, NULL, NULL, NULL);
+        }
+        if (!registers_match(poked, written))
+        {
+            printf("❌ FAILED: Round %d of %d pokes left different registers than written\n", round, n);
+            ok = 0;
+        }
+    }
+
+    if (ok)
+    {
+        printf("  All %d rounds of pokes match the written registers.\n", num_rounds);
+    }
+    free(poked);
+    free(written);
+    return ok;
+}
+
+// OPM_Reset copies a cached image after its first call; each reset, on chips
+// holding arbitrary bytes, must match running the reset sequence by hand
+int check_reset_matches_sequence(int num_resets)
+{
+    opm_t *sequence = (opm_t *)malloc(sizeof(opm_t));
+    opm_t *chip = (opm_t *)malloc(sizeof(opm_t));
+    int ok = 1;
+    if (!sequence || !chip)
+    {
+        fprintf(stderr, "Failed to allocate reset test chips\n");
+        free(sequence);
+        free(chip);
+        return 0;
+    }
+
+    // The reference recomputes every cache on every cycle, so a cache the
+    // reset leaves stale shows up as a difference
+    memset(sequence, 0, sizeof(opm_t));
+    OPM_SetIC(sequence, 1);
+    for (int i = 0; i < 32 * 64; i++)
+    {
+        sequence->pg_fnum_dirty = sequence->pg_inc_dirty = sequence->eg_rate_dirty = 0xffffffff;
+        OPM_Clock(sequence, NULL, NULL, NULL, NULL);
+    }
+    OPM_SetIC(sequence, 0);
+
+    for (int n = 0; n < num_resets && ok; n++)
+    {
+        memset(chip, 0x5A + n, sizeof(opm_t));
+        OPM_Reset(chip);
+        if (memcmp(chip, sequence, sizeof(opm_t)) != 0)
+        {
+            printf("❌ FAILED: Reset %d differs from the reset sequence\n", n);
+            ok = 0;
+        }
+    }
+
+    if (ok)
+    {
+        printf("  All %d resets match the reset sequence (%zu bytes).\n", num_resets, sizeof(opm_t));
+    }
+    free(sequence);
+    free(chip);
+    return ok;
+}
+
+// Run the block conversions over rendered audio and over edge values (odd
+// negatives, the saturation limits, extremes) and compare each output with
+// the plain scalar formula
+int check_conversion_matches_scalar(const int32_t *rendered, int num_values)
+{
+    static const int32_t edges[] = {0, 1, -1, 2, -2, 3, -3, 32767, -32767, 65534, 65535, 65536, 65537,
+                                    -65535, -65536, -65537, -65538, 100000, -100000, INT32_MAX, INT32_MIN};
+    int count = num_values + (int)(sizeof(edges) / sizeof(edges[0]));
+    int32_t *src = (int32_t *)malloc(count * sizeof(int32_t));
+    int16_t *s16 = (int16_t *)malloc(count * sizeof(int16_t));
+    uint8_t *s24 = (uint8_t *)malloc(count * 3);
+    float *f32 = (float *)malloc(count * sizeof(float));
+    int16_t *interleaved = (int16_t *)malloc(count * sizeof(int16_t));
+    int ok = 1;
+    if (!src || !s16 || !s24 || !f32 || !interleaved)
+    {
+        fprintf(stderr, "Failed to allocate conversion test buffers\n");
+        ok = 0;
+    }
+
+    if (ok)
+    {
+        memcpy(src, edges, sizeof(edges));
+        memcpy(src + sizeof(edges) / sizeof(edges[0]), rendered, num_values * sizeof(int32_t));
+        OPM_ConvertS16(s16, src, count);
+        OPM_ConvertS24(s24, src, count);
+        OPM_ConvertF32(f32, src, count);
+        // Planes: even values left, odd values right
+        OPM_InterleaveS16(interleaved, src, src + count / 2, count / 2);
+    }
+
+    for (int i = 0; i < count && ok; i++)
+    {
+        int32_t half = src[i] / 2;
+        int16_t want16 = (int16_t)(half > 32767 ? 32767 : half < -32768 ? -32768 : half);
+        int32_t want24 = src[i] > 65535 ? 65535 * 128 : src[i] < -65536 ? -65536 * 128 : src[i] * 128;
+        int32_t got24 = (int32_t)((uint32_t)s24[i * 3] << 8 | (uint32_t)s24[i * 3 + 1] << 16 |
+                                  (uint32_t)s24[i * 3 + 2] << 24) >> 8;
+        if (s16[i] != want16 || got24 != want24 || f32[i] != (float)src[i] / 65536.0f)
+        {
+            printf("❌ FAILED: Value %d (%d) converts to s16 %d (want %d), s24 %d (want %d), f32 %g\n",
+                   i, src[i], s16[i], want16, got24, want24, f32[i]);
+            ok = 0;
+        }
+    }
+    for (int i = 0; i < count / 2 && ok; i++)
+    {
+        if (interleaved[i * 2] != s16[i] || interleaved[i * 2 + 1] != s16[count / 2 + i])
+        {
+            printf("❌ FAILED: Interleaved frame %d differs\n", i);
+            ok = 0;
+        }
+    }
+
+    if (ok)
+    {
+        printf("  All %d values convert as the scalar formula.\n", count);
+    }
+    free(src);
+    free(s16);
+    free(s24);
+    free(f32);
+    free(interleaved);
+    return ok;
+}
+
+// Measure the resampler's gain for tones at common device rates: tones in the
+// passband must come through within 0.1 dB and tones above the output Nyquist
+// rate, which would alias, at least 60 dB down
+static double resampled_tone_level(uint32_t out_rate, double freq, int *ok)
+{
+    opm_resampler_t resampler;
+    int16_t *out = (int16_t *)malloc(RESAMPLE_TEST_FRAMES * 2 * sizeof(int16_t));
+    int32_t *in = NULL;
+    double c = 0.0, s = 0.0, peak = 0.0;
+    uint32_t need, produced, skip = OPM_RESAMPLE_TAPS;
+
+    if (!out || !OPM_ResamplerInit(&resampler, SAMPLE_RATE, out_rate))
+    {
+        fprintf(stderr, "Failed to set up the resampler for %u Hz\n", out_rate);
+        free(out);
+        *ok = 0;
+        return 0.0;
+    }
+    need = OPM_ResamplerRequiredInput(&resampler, RESAMPLE_TEST_FRAMES);
+    in = (int32_t *)malloc((size_t)need * 2 * sizeof(int32_t));
+    if (!in)
+    {
+        fprintf(stderr, "Failed to allocate resampler test input\n");
+        OPM_ResamplerFree(&resampler);
+        free(out);
+        *ok = 0;
+        return 0.0;
+    }
+    for (uint32_t i = 0; i < need; i++)
+    {
+        in[i * 2] = in[i * 2 + 1] = (int32_t)lrint(RESAMPLE_TEST_AMPLITUDE * sin(2.0 * M_PI * freq * i / SAMPLE_RATE));
+    }
+    produced = OPM_ResamplerProcess(&resampler, in, need, out, RESAMPLE_TEST_FRAMES);
+    if (produced != RESAMPLE_TEST_FRAMES)
+    {
+        printf("❌ FAILED: %u Hz resampler produced %u of %d frames\n", out_rate, produced, RESAMPLE_TEST_FRAMES);
+        *ok = 0;
+    }
+
+    // Fit the tone at the output rate once the filter has filled; an aliased
+    // tone lands elsewhere, so the peak bounds it instead
+    for (uint32_t i = skip; i < produced; i++)
+    {
+        double x = out[i * 2];
+        c += x * cos(2.0 * M_PI * freq * i / out_rate);
+        s += x * sin(2.0 * M_PI * freq * i / out_rate);
+        peak = fabs(x) > peak ? fabs(x) : peak;
+        if (out[i * 2 + 1] != out[i * 2])
+        {
+            printf("❌ FAILED: %u Hz resampler channels differ at frame %u\n", out_rate, i);
+            *ok = 0;
+            break;
+        }
+    }
+    OPM_ResamplerFree(&resampler);
+    free(in);
+    free(out);
+    if (freq * 2 > out_rate)
+    {
+        return peak;
+    }
+    return 2.0 * sqrt(c * c + s * s) / (produced - skip);
+}
+
+int check_resampler_response(void)
+{
+    static const uint32_t rates[] = {16000, 22050, 32000, 44100, 48000};
+    const double level = RESAMPLE_TEST_AMPLITUDE / 2;
+    int ok = 1;
+
+    for (size_t r = 0; r < sizeof(rates) / sizeof(rates[0]) && ok; r++)
+    {
+        uint32_t out_rate = rates[r];
+        // 1 kHz, the top of the passband (the transition band is about 5.4 kHz
+        // wide below the output Nyquist rate), just above the output Nyquist
+        // rate and halfway to the input Nyquist rate
+        double pass[2] = {1000.0, out_rate / 2.0 - 6000.0};
+        double stop[2] = {out_rate / 2.0 + 500.0, (out_rate + SAMPLE_RATE) / 4.0};
+        double worst_pass = 0.0, worst_stop = -200.0;
+
+        for (int t = 0; t < 2 && ok; t++)
+        {
+            double db = 20.0 * log10(resampled_tone_level(out_rate, pass[t], &ok) / level);
+            if (fabs(db) > 0.1)
+            {
+                printf("❌ FAILED: %u Hz output passes %.0f Hz at %.2f dB\n", out_rate, pass[t], db);
+                ok = 0;
+            }
+            worst_pass = fabs(db) > fabs(worst_pass) ? db : worst_pass;
+        }
+        for (int t = 0; t < 2 && ok; t++)
+        {
+            double peak = resampled_tone_level(out_rate, stop[t], &ok);
+            double db = 20.0 * log10((peak > 0.5 ? peak : 0.5) / level);
+            if (db > -60.0)
+            {
+                printf("❌ FAILED: %u Hz output lets %.0f Hz through at %.1f dB\n", out_rate, stop[t], db);
+                ok = 0;
+            }
+            worst_stop = db > worst_stop ? db : worst_stop;
+        }
+        if (ok)
+        {
+            printf("  %5u Hz: passband within %.3f dB, aliases at most %.1f dB\n", out_rate, fabs(worst_pass), worst_stop);
+        }
+    }
+    return ok;
+}
+
 int main()
 {
     printf("Nuked-OPM 440Hz Test Program\n");
@@ -135,27 +1437,22 @@ int main()
         return 1;
     }
 
+    // Keep a copy of the configured chip for the OPM_Clock reference render
+    opm_t reference_chip = chip;
+
     // Render audio
     printf("Rendering %d seconds of audio...\n", DURATION_SECONDS);
+    OPM_RenderSamples(&chip, buffer, TOTAL_SAMPLES);
+
+    // Debug: report first non-zero sample
     int first_nonzero = -1;
     for (int i = 0; i < TOTAL_SAMPLES; i++)
     {
-        int32_t output[2] = {0, 0};
-
-        // Clock the chip multiple times per sample
-        for (int j = 0; j < CYCLES_PER_SAMPLE; j++)
-        {
-            OPM_Clock(&chip, output, NULL, NULL, NULL);
-        }
-
-        buffer[i * 2] = output[0];
-        buffer[i * 2 + 1] = output[1];
-
-        // Debug: report first non-zero sample
-        if (first_nonzero < 0 && (output[0] != 0 || output[1] != 0))
+        if (buffer[i * 2] != 0 || buffer[i * 2 + 1] != 0)
         {
             first_nonzero = i;
-            printf("  First non-zero sample at index %d: L=%d R=%d\n", i, output[0], output[1]);
+            printf("  First non-zero sample at index %d: L=%d R=%d\n", i, buffer[i * 2], buffer[i * 2 + 1]);
+            break;
         }
     }
 
@@ -164,6 +1461,112 @@ int main()
         printf("  WARNING: No non-zero samples detected during rendering!\n");
     }
 
+    // OPM_RenderSamples must match clocking the chip one cycle at a time
+    printf("\nComparing OPM_RenderSamples with OPM_Clock...\n");
+    if (!check_render_matches_clock(&reference_chip, buffer, TOTAL_SAMPLES))
+    {
+        free(buffer);
+        return 1;
+    }
+
+    // Every lane of the multi-chip engine must match a separate opm_t
+    printf("\nComparing %d-lane opm_multi_t with separate opm_t chips...\n", OPM_MULTI_LANES);
+    if (!check_multi_matches_scalar(MULTI_TEST_SAMPLES))
+    {
+        free(buffer);
+        return 1;
+    }
+
+    // The word-level mixer must match the bit-serial one pin for pin
+    printf("\nComparing word-level mixer with bit-serial mixer...\n");
+    if (!check_word_mixer_matches_serial(WORD_MIXER_TEST_SAMPLES))
+    {
+        free(buffer);
+        return 1;
+    }
+
+    // Fast-forwarding through silence must not change the output
+    printf("\nComparing idle fast-forward with full clocking...\n");
+    if (!check_idle_matches_full(IDLE_TEST_PHRASES))
+    {
+        free(buffer);
+        return 1;
+    }
+
+    // A saved state must continue exactly where the chip left off
+    printf("\nSaving and restoring chip state...\n");
+    if (!check_state_restores(&reference_chip, STATE_TEST_SAMPLES))
+    {
+        free(buffer);
+        return 1;
+    }
+
+    // Queued writes must set the same registers as fixed delays, much sooner
+    printf("\nComparing queued register writes with fixed delays...\n");
+    if (!check_write_queue_matches_delayed(QUEUE_TEST_BURSTS))
+    {
+        free(buffer);
+        return 1;
+    }
+
+    // The envelope timer (word-parallel unless built with OPM_SERIAL_EG_TIMER)
+    // must match the bit-serial timer cycle for cycle
+    printf("\nComparing envelope timer with the bit-serial timer...\n");
+    if (!check_eg_timer_matches_serial(EG_TIMER_TEST_SEGMENTS, EG_TIMER_TEST_ROUNDS))
+    {
+        free(buffer);
+        return 1;
+    }
+
+    // The LFO multiplier (word-level unless built with OPM_SERIAL_LFO) must
+    // take the same AM and PM locks as the bit-serial one
+    printf("\nComparing LFO multiplier with the bit-serial multiplier...\n");
+    if (!check_lfo_matches_serial(LFO_TEST_SEGMENTS, LFO_TEST_ROUNDS))
+    {
+        free(buffer);
+        return 1;
+    }
+
+    // Cached phase increments and envelope rates must match recomputing them every cycle
+    printf("\nComparing cached phase increments and envelope rates with recomputed ones...\n");
+    if (!check_register_caches_match_recompute(REGISTER_CACHE_TEST_ROUNDS))
+    {
+        free(buffer);
+        return 1;
+    }
+
+    // Poked registers must end up as written ones
+    printf("\nComparing poked registers with written ones...\n");
+    if (!check_poke_matches_write(POKE_TEST_ROUNDS))
+    {
+        free(buffer);
+        return 1;
+    }
+
+    // Resets from the cached image must match the reset sequence byte for byte
+    printf("\nComparing OPM_Reset with the reset sequence...\n");
+    if (!check_reset_matches_sequence(RESET_TEST_RESETS))
+    {
+        free(buffer);
+        return 1;
+    }
+
+    // Block sample conversion (SIMD where available) must match the scalar formula
+    printf("\nComparing block sample conversion with scalar conversion...\n");
+    if (!check_conversion_matches_scalar(buffer, CONVERT_TEST_VALUES))
+    {
+        free(buffer);
+        return 1;
+    }
+
+    // Resampling to device rates must keep the passband flat and not alias
+    printf("\nMeasuring resampler response at device rates...\n");
+    if (!check_resampler_response())
+    {
+        free(buffer);
+        return 1;
+    }
+
     // Check if buffer contains non-silent audio
     printf("\nAnalyzing rendered audio buffer...\n");
 
@@ -8,6 +8,7 @@
 #include <stdint.h>
 #include <math.h>
 #include "../../opm.h"
+#include "../../opm_convert.h"
 
 // Sample rate and clock settings
 #define OPM_CLOCK 3579545
@@ -18,7 +19,6 @@
 #define DURATION_SECONDS 3
 #define TOTAL_SAMPLES (SAMPLE_RATE * DURATION_SECONDS)
 #define NUM_CHANNELS 2 // Stereo
-#define REGISTER_WRITE_DELAY_CYCLES 128
 
 // WAV file header structures
 typedef struct
@@ -46,31 +46,20 @@ typedef struct
     uint32_t data_size; // Size of data
 } DATAChunk;
 
-// Helper function to write register with delay
-void write_register_with_delay(opm_t *chip, uint8_t addr, uint8_t data, int32_t *dummy_output)
+// Write a register: the chip's write queue issues address and data as soon as
+// the busy flag allows, so clock the chip until it has
+void write_register(opm_t *chip, uint8_t addr, uint8_t data)
 {
-    // Write address
-    OPM_Write(chip, 0, addr);
-
-    for (uint32_t i = 0; i < REGISTER_WRITE_DELAY_CYCLES; i++)
+    OPM_QueueWrite(chip, addr, data);
+    while (OPM_QueuedWrites(chip))
     {
-        OPM_Clock(chip, dummy_output, NULL, NULL, NULL);
-    }
-
-    // Write data
-    OPM_Write(chip, 1, data);
-
-    for (uint32_t i = 0; i < REGISTER_WRITE_DELAY_CYCLES; i++)
-    {
-        OPM_Clock(chip, dummy_output, NULL, NULL, NULL);
+        OPM_Clock(chip, NULL, NULL, NULL, NULL);
     }
 }
 
 // Configure OPM for 440Hz tone on channel 0
 void configure_440hz_tone(opm_t *chip)
 {
-    int32_t dummy_output[2] = {0, 0};
-
     printf("  Writing registers...\n");
 
     int channel = 0;
@@ -78,21 +67,21 @@ void configure_440hz_tone(opm_t *chip)
     // Reset all channels (key off)
     for (int ch = 0; ch < 8; ch++)
     {
-        write_register_with_delay(chip, 0x08, ch, dummy_output);
+        write_register(chip, 0x08, ch);
     }
 
     // RL_FB_CONNECT: RL=11 (both L/R), FB=0, CON=7 (all carriers direct to output)
-    write_register_with_delay(chip, 0x20 + channel, 0xC7, dummy_output);
+    write_register(chip, 0x20 + channel, 0xC7);
 
     // Set frequency (440 Hz = A4)
     // KC (Key Code) for A4 (440Hz): 0x4A ※OPM_CLOCK 3579545 の場合のみ。違うときはKC/KFともに変更しないと違うピッチになる
-    write_register_with_delay(chip, 0x28 + channel, 0x4A, dummy_output);
+    write_register(chip, 0x28 + channel, 0x4A);
 
     // KF (Key Fraction)
-    write_register_with_delay(chip, 0x30 + channel, 0x00, dummy_output);
+    write_register(chip, 0x30 + channel, 0x00);
 
     // PMS/AMS (Phase/Amplitude Modulation Sensitivity)
-    write_register_with_delay(chip, 0x38 + channel, 0x00, dummy_output);
+    write_register(chip, 0x38 + channel, 0x00);
 
     // Configure all 4 operators for channel 0
     for (int op = 0; op < 4; op++)
@@ -100,34 +89,34 @@ void configure_440hz_tone(opm_t *chip)
         int slot = channel + (op * 8);
 
         // DT1/MUL: DT1=0, MUL=1 (fundamental frequency)
-        write_register_with_delay(chip, 0x40 + slot, 0x01, dummy_output);
+        write_register(chip, 0x40 + slot, 0x01);
 
         // TL (Total Level) - 0x00 for op0 (max volume), 0x7F for others
         if (op == 0)
         {
-            write_register_with_delay(chip, 0x60 + slot, 0x00, dummy_output); // Max volume for carrier
+            write_register(chip, 0x60 + slot, 0x00); // Max volume for carrier
         }
         else
         {
-            write_register_with_delay(chip, 0x60 + slot, 0x7F, dummy_output); // Silent for others
+            write_register(chip, 0x60 + slot, 0x7F); // Silent for others
         }
 
         // KS/AR: KS=0, AR=31 (maximum attack rate)
-        write_register_with_delay(chip, 0x80 + slot, 0x1F, dummy_output);
+        write_register(chip, 0x80 + slot, 0x1F);
 
         // AMS/D1R: AMS=0, D1R=5
-        write_register_with_delay(chip, 0xA0 + slot, 0x05, dummy_output);
+        write_register(chip, 0xA0 + slot, 0x05);
 
         // DT2/D2R: DT2=0, D2R=5
-        write_register_with_delay(chip, 0xC0 + slot, 0x05, dummy_output);
+        write_register(chip, 0xC0 + slot, 0x05);
 
         // D1L/RR: D1L=15, RR=7
-        write_register_with_delay(chip, 0xE0 + slot, 0xF7, dummy_output);
+        write_register(chip, 0xE0 + slot, 0xF7);
     }
 
     printf("  Key ON channel 0, all operators...\n");
     // Key ON: trigger channel 0, all 4 operators (bits 6,5,4,3 = 0x78)
-    write_register_with_delay(chip, 0x08, 0x78 | channel, dummy_output);
+    write_register(chip, 0x08, 0x78 | channel);
 
     printf("  Configuration complete.\n");
 }
@@ -172,14 +161,18 @@ int write_wav_file(const char *filename, int32_t *buffer, uint32_t num_samples)
     data_chunk.data_size = data_size;
     fwrite(&data_chunk, sizeof(DATAChunk), 1, file);
 
-    // Convert 32-bit samples to 16-bit and write
+    // Convert 32-bit samples to 16-bit (divide by 2, saturated) and write
     printf("  Converting and writing audio data...\n");
-    for (uint32_t i = 0; i < num_samples * NUM_CHANNELS; i++)
+    int16_t *samples_16 = (int16_t *)malloc(data_size);
+    if (!samples_16)
     {
-        // Convert 32-bit to 16-bit by dividing by 2 (simple conversion)
-        int16_t sample_16 = (int16_t)(buffer[i] / 2);
-        fwrite(&sample_16, sizeof(int16_t), 1, file);
+        fprintf(stderr, "Error: Cannot allocate conversion buffer\n");
+        fclose(file);
+        return 0;
     }
+    OPM_ConvertS16(samples_16, buffer, num_samples * NUM_CHANNELS);
+    fwrite(samples_16, sizeof(int16_t), num_samples * NUM_CHANNELS, file);
+    free(samples_16);
 
     fclose(file);
 
@@ -226,25 +219,17 @@ int main(int argc, char *argv[])
 
     // Render audio
     printf("\nRendering %d seconds of audio...\n", DURATION_SECONDS);
+    OPM_RenderSamples(&chip, buffer, TOTAL_SAMPLES);
+
+    // Debug: report first non-zero sample
     int first_nonzero = -1;
     for (int i = 0; i < TOTAL_SAMPLES; i++)
     {
-        int32_t output[2] = {0, 0};
-
-        // Clock the chip multiple times per sample
-        for (int j = 0; j < CYCLES_PER_SAMPLE; j++)
-        {
-            OPM_Clock(&chip, output, NULL, NULL, NULL);
-        }
-
-        buffer[i * 2] = output[0];
-        buffer[i * 2 + 1] = output[1];
-
-        // Debug: report first non-zero sample
-        if (first_nonzero < 0 && (output[0] != 0 || output[1] != 0))
+        if (buffer[i * 2] != 0 || buffer[i * 2 + 1] != 0)
         {
             first_nonzero = i;
-            printf("  First non-zero sample at index %d: L=%d R=%d\n", i, output[0], output[1]);
+            printf("  First non-zero sample at index %d: L=%d R=%d\n", i, buffer[i * 2], buffer[i * 2 + 1]);
+            break;
         }
     }
 
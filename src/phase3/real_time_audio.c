@@ -1,6 +1,6 @@
 /* Real-time audio playback program using Nuked-OPM and MiniAudio
  * Plays 440Hz tone for 3 seconds in real-time
- * With downsampling from ~55kHz (internal OPM rate) to 48kHz (output)
+ * With polyphase downsampling from ~55kHz (internal OPM rate) to 48kHz (output)
  */
 
 #define MINIAUDIO_IMPLEMENTATION
@@ -12,6 +12,7 @@
 #include <stdint.h>
 #include <time.h>
 #include "../../opm.h"
+#include "../../opm_resample.h"
 
 // Sample rate and clock settings
 #define OPM_CLOCK 3579545
@@ -21,13 +22,19 @@
 #define OUTPUT_SAMPLE_RATE 48000                             // Output device sample rate
 
 #define DURATION_SECONDS 3
-#define REGISTER_WRITE_DELAY_CYCLES 128
 
 // Internal buffer size for resampler
 // At 55930Hz internal rate and 48000Hz output rate, we need ~1.165x input frames
-// This buffer size supports output callbacks up to ~3500 frames
+// Internal samples rendered per chunk (larger callbacks are split into chunks)
 #define INTERNAL_BUFFER_SIZE 4096
 
+// Render thread: minimum output frames buffered ahead of the device (~43 ms at
+// 48 kHz; grown to fit longer device periods), frames rendered per step, and
+// the device period that can now be short
+#define RING_BUFFER_FRAMES 2048
+#define RENDER_PERIOD_FRAMES 256
+#define DEVICE_PERIOD_MS 5
+
 // User data structure for MiniAudio callback
 typedef struct
 {
@@ -35,35 +42,29 @@ typedef struct
     uint32_t samples_played;
     uint32_t total_samples;
     int is_playing;
-    ma_resampler resampler;
-    int16_t internal_buffer[INTERNAL_BUFFER_SIZE * 2]; // Stereo buffer
+    opm_resampler_t resampler;
+    int32_t internal_buffer[INTERNAL_BUFFER_SIZE * 2]; // Stereo buffer (chip output)
+    ma_pcm_rb ring;                                    // Resampled frames, render thread -> audio callback
+    ma_thread render_thread;
+    ma_atomic_bool32 render_done; // Set by the render thread after the last frames are in the ring
+    ma_atomic_bool32 stop_render; // Set by the main thread to stop the render thread early
+    uint32_t underruns;           // Callbacks that found the ring short before the end
 } AudioContext;
 
-// Helper function to write register with delay
-void write_register_with_delay(opm_t *chip, uint8_t addr, uint8_t data, int32_t *dummy_output)
+// Write a register: the chip's write queue issues address and data as soon as
+// the busy flag allows, so clock the chip until it has
+void write_register(opm_t *chip, uint8_t addr, uint8_t data)
 {
-    // Write address
-    OPM_Write(chip, 0, addr);
-
-    for (uint32_t i = 0; i < REGISTER_WRITE_DELAY_CYCLES; i++)
-    {
-        OPM_Clock(chip, dummy_output, NULL, NULL, NULL);
-    }
-
-    // Write data
-    OPM_Write(chip, 1, data);
-
-    for (uint32_t i = 0; i < REGISTER_WRITE_DELAY_CYCLES; i++)
+    OPM_QueueWrite(chip, addr, data);
+    while (OPM_QueuedWrites(chip))
     {
-        OPM_Clock(chip, dummy_output, NULL, NULL, NULL);
+        OPM_Clock(chip, NULL, NULL, NULL, NULL);
     }
 }
 
 // Configure OPM for 440Hz tone on channel 0
 void configure_440hz_tone(opm_t *chip)
 {
-    int32_t dummy_output[2] = {0, 0};
-
     printf("  Writing registers...\n");
 
     int channel = 0;
@@ -71,21 +72,21 @@ void configure_440hz_tone(opm_t *chip)
     // Reset all channels (key off)
     for (int ch = 0; ch < 8; ch++)
     {
-        write_register_with_delay(chip, 0x08, ch, dummy_output);
+        write_register(chip, 0x08, ch);
     }
 
     // RL_FB_CONNECT: RL=11 (both L/R), FB=0, CON=7 (all carriers direct to output)
-    write_register_with_delay(chip, 0x20 + channel, 0xC7, dummy_output);
+    write_register(chip, 0x20 + channel, 0xC7);
 
     // Set frequency (440 Hz = A4)
     // KC (Key Code) for A4 (440Hz): 0x4A ※OPM_CLOCK 3579545 の場合のみ。違うときはKC/KFともに変更しないと違うピッチになる
-    write_register_with_delay(chip, 0x28 + channel, 0x4A, dummy_output);
+    write_register(chip, 0x28 + channel, 0x4A);
 
     // KF (Key Fraction)
-    write_register_with_delay(chip, 0x30 + channel, 0x00, dummy_output);
+    write_register(chip, 0x30 + channel, 0x00);
 
     // PMS/AMS (Phase/Amplitude Modulation Sensitivity)
-    write_register_with_delay(chip, 0x38 + channel, 0x00, dummy_output);
+    write_register(chip, 0x38 + channel, 0x00);
 
     // Configure all 4 operators for channel 0
     for (int op = 0; op < 4; op++)
@@ -93,133 +94,100 @@ void configure_440hz_tone(opm_t *chip)
         int slot = channel + (op * 8);
 
         // DT1/MUL: DT1=0, MUL=1 (fundamental frequency)
-        write_register_with_delay(chip, 0x40 + slot, 0x01, dummy_output);
+        write_register(chip, 0x40 + slot, 0x01);
 
         // TL (Total Level) - 0x00 for op0 (max volume), 0x7F for others
         if (op == 0)
         {
-            write_register_with_delay(chip, 0x60 + slot, 0x00, dummy_output); // Max volume for carrier
+            write_register(chip, 0x60 + slot, 0x00); // Max volume for carrier
         }
         else
         {
-            write_register_with_delay(chip, 0x60 + slot, 0x7F, dummy_output); // Silent for others
+            write_register(chip, 0x60 + slot, 0x7F); // Silent for others
         }
 
         // KS/AR: KS=0, AR=31 (maximum attack rate)
-        write_register_with_delay(chip, 0x80 + slot, 0x1F, dummy_output);
+        write_register(chip, 0x80 + slot, 0x1F);
 
         // AMS/D1R: AMS=0, D1R=5
-        write_register_with_delay(chip, 0xA0 + slot, 0x05, dummy_output);
+        write_register(chip, 0xA0 + slot, 0x05);
 
         // DT2/D2R: DT2=0, D2R=5
-        write_register_with_delay(chip, 0xC0 + slot, 0x05, dummy_output);
+        write_register(chip, 0xC0 + slot, 0x05);
 
         // D1L/RR: D1L=15, RR=7
-        write_register_with_delay(chip, 0xE0 + slot, 0xF7, dummy_output);
+        write_register(chip, 0xE0 + slot, 0xF7);
     }
 
     printf("  Key ON channel 0, all operators...\n");
     // Key ON: trigger channel 0, all 4 operators (bits 6,5,4,3 = 0x78)
-    write_register_with_delay(chip, 0x08, 0x78 | channel, dummy_output);
+    write_register(chip, 0x08, 0x78 | channel);
 
     printf("  Configuration complete.\n");
 }
 
-// MiniAudio data callback - called by audio thread to fill the buffer
-void data_callback(ma_device *pDevice, void *pOutput, const void *pInput, ma_uint32 frameCount)
+// Render frameCount output frames: emulate at ~55930 Hz and resample.
+// Runs on the render thread. Returns 1 once the tone has ended; the frames of
+// that call are padded with silence.
+int render_output_frames(AudioContext *pContext, int16_t *pOutputS16, ma_uint32 frameCount)
 {
-    AudioContext *pContext = (AudioContext *)pDevice->pUserData;
-    int16_t *pOutputS16 = (int16_t *)pOutput;
-
-    (void)pInput; // Unused parameter
+    int finished = 0;
+    ma_uint32 done = 0;
 
-    if (!pContext->is_playing)
+    // Callbacks of any size are rendered INTERNAL_BUFFER_SIZE input frames at a
+    // time; input the resampler has not used yet stays buffered in it
+    while (done < frameCount)
     {
-        // Fill with silence if not playing
-        memset(pOutput, 0, frameCount * 2 * sizeof(int16_t));
-        return;
-    }
+        // Calculate how many internal samples we need to generate
+        uint32_t requiredInputFrames = OPM_ResamplerRequiredInput(&pContext->resampler, frameCount - done);
 
-    // Calculate how many internal samples we need to generate
-    ma_uint64 requiredInputFrames = 0;
-    ma_result result = ma_resampler_get_required_input_frame_count(&pContext->resampler, frameCount, &requiredInputFrames);
-    if (result != MA_SUCCESS)
-    {
-        memset(pOutput, 0, frameCount * 2 * sizeof(int16_t));
-        return;
-    }
+        // Clamp to buffer size
+        if (requiredInputFrames > INTERNAL_BUFFER_SIZE)
+        {
+            requiredInputFrames = INTERNAL_BUFFER_SIZE;
+        }
 
-    // Clamp to buffer size
-    if (requiredInputFrames > INTERNAL_BUFFER_SIZE)
-    {
-        requiredInputFrames = INTERNAL_BUFFER_SIZE;
-    }
+        // Generate internal samples at ~55930 Hz, up to the end of the tone
+        uint32_t renderFrames = requiredInputFrames;
+        if (renderFrames > pContext->total_samples - pContext->samples_played)
+        {
+            renderFrames = pContext->total_samples - pContext->samples_played;
+        }
+
+        OPM_RenderSamples(&pContext->chip, pContext->internal_buffer, renderFrames);
+        pContext->samples_played += renderFrames;
 
-    // Generate internal samples at ~55930 Hz
-    ma_uint64 actualInputFrames = 0;
-    for (ma_uint64 i = 0; i < requiredInputFrames; i++)
-    {
         // Check if we've played enough samples
         if (pContext->samples_played >= pContext->total_samples)
         {
             // Fill remaining internal buffer with silence for smooth fadeout
-            for (ma_uint64 j = i; j < requiredInputFrames; j++)
-            {
-                pContext->internal_buffer[j * 2] = 0;
-                pContext->internal_buffer[j * 2 + 1] = 0;
-            }
-            // We filled the entire buffer (audio + silence) so use all frames
-            actualInputFrames = requiredInputFrames;
-            pContext->is_playing = 0;
-            break;
+            memset(pContext->internal_buffer + renderFrames * 2, 0,
+                   (size_t)(requiredInputFrames - renderFrames) * 2 * sizeof(int32_t));
+            finished = 1;
         }
 
-        // Generate one stereo sample from OPM chip
-        int32_t output[2] = {0, 0};
-
-        // Clock the chip multiple times per sample
-        for (int j = 0; j < CYCLES_PER_SAMPLE; j++)
+        // Resample from internal rate to output rate (and convert to 16-bit)
+        uint32_t outputFramesProcessed = OPM_ResamplerProcess(&pContext->resampler, pContext->internal_buffer,
+                                                              requiredInputFrames, pOutputS16 + done * 2,
+                                                              frameCount - done);
+        if (outputFramesProcessed == 0)
         {
-            OPM_Clock(&pContext->chip, output, NULL, NULL, NULL);
+            break; // Out of memory in the resampler
         }
-
-        // Convert 32-bit samples to 16-bit by dividing by 2
-        pContext->internal_buffer[i * 2] = (int16_t)(output[0] / 2);
-        pContext->internal_buffer[i * 2 + 1] = (int16_t)(output[1] / 2);
-
-        pContext->samples_played++;
-    }
-
-    // If we didn't break early, we generated all required frames
-    if (actualInputFrames == 0)
-    {
-        actualInputFrames = requiredInputFrames;
-    }
-
-    // Resample from internal rate to output rate
-    ma_uint64 inputFramesProcessed = actualInputFrames;
-    ma_uint64 outputFramesProcessed = frameCount;
-    result = ma_resampler_process_pcm_frames(&pContext->resampler,
-                                             pContext->internal_buffer, &inputFramesProcessed,
-                                             pOutputS16, &outputFramesProcessed);
-
-    if (result != MA_SUCCESS)
-    {
-        memset(pOutput, 0, frameCount * 2 * sizeof(int16_t));
-        return;
+        done += outputFramesProcessed;
     }
 
     // Fill any remaining output frames with silence
-    if (outputFramesProcessed < frameCount)
+    if (done < frameCount)
     {
-        for (ma_uint64 i = outputFramesProcessed; i < frameCount; i++)
-        {
-            pOutputS16[i * 2] = 0;
-            pOutputS16[i * 2 + 1] = 0;
-        }
+        memset(pOutputS16 + done * 2, 0, (frameCount - done) * 2 * sizeof(int16_t));
     }
+    return finished;
 }
 
+// Render thread, ring and audio callback shared with phase4
+#include "../phase4/render_thread.h"
+
 int main()
 {
     printf("Nuked-OPM Real-Time Audio Program (MiniAudio with Resampling)\n");
@@ -245,15 +213,8 @@ int main()
     printf("   Internal rate: %d Hz\n", INTERNAL_SAMPLE_RATE);
     printf("   Output rate: %d Hz\n", OUTPUT_SAMPLE_RATE);
 
-    // Initialize resampler
-    ma_resampler_config resamplerConfig = ma_resampler_config_init(
-        ma_format_s16,
-        2, // channels
-        INTERNAL_SAMPLE_RATE,
-        OUTPUT_SAMPLE_RATE,
-        ma_resample_algorithm_linear);
-
-    if (ma_resampler_init(&resamplerConfig, NULL, &context.resampler) != MA_SUCCESS)
+    // Initialize polyphase resampler
+    if (!OPM_ResamplerInit(&context.resampler, INTERNAL_SAMPLE_RATE, OUTPUT_SAMPLE_RATE))
     {
         fprintf(stderr, "❌ Failed to initialize resampler\n");
         return 1;
@@ -271,13 +232,14 @@ int main()
     deviceConfig.playback.format = ma_format_s16;
     deviceConfig.playback.channels = 2;
     deviceConfig.sampleRate = OUTPUT_SAMPLE_RATE;
+    deviceConfig.periodSizeInMilliseconds = DEVICE_PERIOD_MS;
     deviceConfig.dataCallback = data_callback;
     deviceConfig.pUserData = &context;
 
     if (ma_device_init(NULL, &deviceConfig, &device) != MA_SUCCESS)
     {
         fprintf(stderr, "❌ Failed to initialize MiniAudio device\n");
-        ma_resampler_uninit(&context.resampler, NULL);
+        OPM_ResamplerFree(&context.resampler);
         return 1;
     }
 
@@ -286,14 +248,23 @@ int main()
     printf("   Channels: %d (stereo)\n", device.playback.channels);
     printf("   Format: 16-bit signed integer\n");
 
+    // Run the emulator on its own thread, one ring (at least two device periods) ahead of the device
+    if (!start_render_thread(&context, device.playback.internalPeriodSizeInFrames))
+    {
+        ma_device_uninit(&device);
+        OPM_ResamplerFree(&context.resampler);
+        return 1;
+    }
+
     printf("\nStarting playback...\n");
     printf("Playing 440Hz tone for %d seconds...\n", DURATION_SECONDS);
 
     if (ma_device_start(&device) != MA_SUCCESS)
     {
         fprintf(stderr, "❌ Failed to start MiniAudio device\n");
+        stop_render_thread(&context);
         ma_device_uninit(&device);
-        ma_resampler_uninit(&context.resampler, NULL);
+        OPM_ResamplerFree(&context.resampler);
         return 1;
     }
 
@@ -307,11 +278,14 @@ int main()
     ma_sleep(200);
 
     printf("\n✅ Playback completed!\n");
-    printf("   Total internal samples generated: %u\n", context.samples_played);
 
     // Cleanup
     ma_device_uninit(&device);
-    ma_resampler_uninit(&context.resampler, NULL);
+    stop_render_thread(&context);
+    OPM_ResamplerFree(&context.resampler);
+
+    printf("   Total internal samples generated: %u\n", context.samples_played);
+    printf("   Underruns: %u\n", context.underruns);
 
     printf("\n✅ SUCCESS!\n");
     printf("Real-time audio playback with resampling completed successfully.\n");
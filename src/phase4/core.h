@@ -1,132 +1,279 @@
 #include "types.h"
 
-// Process register events up to current sample time
-void process_events_until(AudioContext *ctx, uint32_t current_sample)
+// Reset the chip and rewind to the start of the song. The writes at cycle 0
+// (the song's setup and its first note) are poked straight into the chip
+// instead of queued, so the song starts at sample 0 rather than after ~70
+// busy-spaced writes.
+void start_playback(AudioContext *ctx)
 {
-    // Pass2 events already include timing for addr and data register writes
-    // Each event specifies exactly when to write, no additional delays needed
+    OPM_Reset(&ctx->chip);
+    ctx->samples_played = 0;
+    ctx->next_event_index = 0;
+
+    while (ctx->next_event_index < ctx->events->count && ctx->events->events[ctx->next_event_index].cycle_time == 0)
+    {
+        RegisterEvent *event = &ctx->events->events[ctx->next_event_index];
+        if (!event->is_data_write)
+        {
+            OPM_PokeRegister(&ctx->chip, event->address, event->data);
+        }
+        ctx->next_event_index++;
+    }
+}
+
+// Process register events up to current cycle time
+void process_events_until(AudioContext *ctx, uint64_t current_cycle)
+{
+    // Each address event queues the whole register write; the chip issues its
+    // address and data as soon as the busy flag allows, while it is rendered
 
     while (ctx->next_event_index < ctx->events->count)
     {
         RegisterEvent *event = &ctx->events->events[ctx->next_event_index];
 
-        if (event->sample_time > current_sample)
+        if (event->cycle_time > current_cycle)
         {
             break; // Haven't reached this event yet
         }
 
-        // Write to the appropriate register (address or data)
-        // The timing is already calculated in pass2, so no cycle consumption here
-        if (event->is_data_write)
+        if (!event->is_data_write && !OPM_QueueWrite(&ctx->chip, event->address, event->data))
         {
-            // Data register write
-            OPM_Write(&ctx->chip, OPM_DATA_REGISTER, event->data);
-        }
-        else
-        {
-            // Address register write
-            OPM_Write(&ctx->chip, OPM_ADDRESS_REGISTER, event->address);
+            break; // Queue full: try again next sample
         }
 
         ctx->next_event_index++;
     }
 }
 
-// MiniAudio data callback
-void data_callback(ma_device *pDevice, void *pOutput, const void *pInput, ma_uint32 frameCount)
+// Render the next sample. The chip is stopped at the exact cycle of every event
+// inside the sample; without one the sample is rendered in one call.
+void render_sample(AudioContext *ctx, int32_t *output)
 {
-    AudioContext *pContext = (AudioContext *)pDevice->pUserData;
-    int16_t *pOutputS16 = (int16_t *)pOutput;
-
-    (void)pInput;
+    uint64_t start = (uint64_t)ctx->samples_played * CYCLES_PER_SAMPLE;
+    uint64_t end = start + CYCLES_PER_SAMPLE;
+    uint64_t now = start;
 
-    if (!pContext->is_playing)
+    process_events_until(ctx, start);
+    while (ctx->next_event_index < ctx->events->count)
     {
-        memset(pOutput, 0, frameCount * 2 * sizeof(int16_t));
-        return;
+        uint64_t event_time = ctx->events->events[ctx->next_event_index].cycle_time;
+        size_t index = ctx->next_event_index;
+        if (event_time >= end)
+        {
+            break;
+        }
+        if (event_time > now)
+        {
+            OPM_ClockCycles(&ctx->chip, (uint32_t)(event_time - now));
+            now = event_time;
+        }
+        process_events_until(ctx, now);
+        if (ctx->next_event_index == index)
+        {
+            break; // Queue full: the event waits for the next sample
+        }
     }
 
-    // Calculate required input frames
-    ma_uint64 requiredInputFrames = 0;
-    ma_result result = ma_resampler_get_required_input_frame_count(&pContext->resampler, frameCount, &requiredInputFrames);
-    if (result != MA_SUCCESS)
+    if (now == start)
     {
-        memset(pOutput, 0, frameCount * 2 * sizeof(int16_t));
-        return;
+        OPM_RenderSamples(&ctx->chip, output, 1);
     }
-
-    if (requiredInputFrames > INTERNAL_BUFFER_SIZE)
+    else
     {
-        requiredInputFrames = INTERNAL_BUFFER_SIZE;
+        OPM_ClockCycles(&ctx->chip, (uint32_t)(end - now));
+        output[0] = ctx->chip.dac_output[0];
+        output[1] = ctx->chip.dac_output[1];
     }
+    ctx->samples_played++;
+}
+
+// Render count samples into output (interleaved stereo). The next event and
+// keyframe are looked up once per run, and the samples up to them are rendered
+// in one block. Returns 0 if a keyframe could not be stored; rendering still
+// completes.
+int render_block(AudioContext *ctx, int32_t *output, uint32_t count)
+{
+    uint32_t end = ctx->samples_played + count;
+    int ok = 1;
 
-    // Generate internal samples
-    ma_uint64 actualInputFrames = 0;
-    for (ma_uint64 i = 0; i < requiredInputFrames; i++)
+    while (ctx->samples_played < end)
     {
-        if (pContext->samples_played >= pContext->total_samples)
+        if (ctx->keyframes && !record_keyframe(ctx->keyframes, ctx))
         {
-            // Fill rest with silence
-            for (ma_uint64 j = i; j < requiredInputFrames; j++)
+            ok = 0;
+        }
+
+        uint32_t boundary = end;
+        if (ctx->next_event_index < ctx->events->count)
+        {
+            uint64_t event_sample = ctx->events->events[ctx->next_event_index].cycle_time / CYCLES_PER_SAMPLE;
+            if (event_sample <= ctx->samples_played)
             {
-                pContext->internal_buffer[j * 2] = 0;
-                pContext->internal_buffer[j * 2 + 1] = 0;
+                // Apply every event due in this sample
+                render_sample(ctx, output);
+                output += 2;
+                continue;
+            }
+            if (event_sample < boundary)
+            {
+                boundary = (uint32_t)event_sample;
             }
-            actualInputFrames = requiredInputFrames;
-            pContext->is_playing = 0;
-            break;
         }
+        if (ctx->keyframes)
+        {
+            uint32_t interval = ctx->keyframes->interval_samples;
+            uint32_t next_keyframe = (ctx->samples_played / interval + 1) * interval;
+            if (next_keyframe < boundary)
+            {
+                boundary = next_keyframe;
+            }
+        }
+
+        uint32_t run = boundary - ctx->samples_played;
+        OPM_RenderSamples(&ctx->chip, output, run);
+        output += run * 2;
+        ctx->samples_played += run;
+    }
+    return ok;
+}
 
-        // Process any register events that should happen now
-        process_events_until(pContext, pContext->samples_played);
+// Move playback to target_sample: restore the nearest keyframe at or before it
+// and render forward without output. Keyframes passed on the way are recorded,
+// so the first seek past the indexed range extends the index.
+int seek_to_sample(AudioContext *ctx, uint32_t target_sample)
+{
+    int32_t scratch[256 * 2];
 
-        // Generate one stereo sample
-        int32_t output[2] = {0, 0};
-        for (int j = 0; j < CYCLES_PER_SAMPLE; j++)
+    if (target_sample > ctx->total_samples)
+    {
+        target_sample = ctx->total_samples;
+    }
+    const PlayerSnapshot *keyframe = ctx->keyframes ? find_keyframe(ctx->keyframes, target_sample) : NULL;
+    if (keyframe)
+    {
+        if (!restore_player_snapshot(ctx, keyframe))
         {
-            OPM_Clock(&pContext->chip, output, NULL, NULL, NULL);
+            return 0;
         }
+    }
+    else if (ctx->samples_played > target_sample)
+    {
+        // No keyframes: replay from the start
+        start_playback(ctx);
+    }
 
-        // Store to internal buffer (convert to 16-bit)
-        pContext->internal_buffer[i * 2] = (int16_t)(output[0] / 2);
-        pContext->internal_buffer[i * 2 + 1] = (int16_t)(output[1] / 2);
+    while (ctx->samples_played < target_sample)
+    {
+        uint32_t count = target_sample - ctx->samples_played;
+        if (count > 256)
+        {
+            count = 256;
+        }
+        if (!render_block(ctx, scratch, count))
+        {
+            return 0;
+        }
+    }
+
+    ctx->is_playing = ctx->samples_played < ctx->total_samples;
+    return 1;
+}
 
-        // Also store to WAV buffer (keep as 32-bit)
-        if (pContext->wav_buffer)
+// Render the whole song into the WAV writer with no device, as fast as the
+// CPU allows. Returns the wall-clock time taken in seconds.
+double render_offline(AudioContext *ctx)
+{
+    ma_timer timer;
+    ma_timer_init(&timer);
+
+    while (ctx->samples_played < ctx->total_samples)
+    {
+        uint32_t count = ctx->total_samples - ctx->samples_played;
+        if (count > INTERNAL_BUFFER_SIZE)
+        {
+            count = INTERNAL_BUFFER_SIZE;
+        }
+        render_block(ctx, ctx->render_buffer, count);
+        if (ctx->wav)
         {
-            pContext->wav_buffer[pContext->wav_buffer_pos * 2] = output[0];
-            pContext->wav_buffer[pContext->wav_buffer_pos * 2 + 1] = output[1];
-            pContext->wav_buffer_pos++;
+            wav_writer_write(ctx->wav, ctx->render_buffer, count);
         }
+    }
+    ctx->is_playing = 0;
+
+    return ma_timer_get_time_in_seconds(&timer);
+}
+
+// Render up to frames internal samples into render_buffer (and the WAV file),
+// padding with silence past the end of the song. Returns 1 once the song has ended.
+static int render_internal_frames(AudioContext *pContext, uint32_t frames)
+{
+    uint32_t available = pContext->total_samples - pContext->samples_played;
+    uint32_t renderFrames = frames < available ? frames : available;
+    render_block(pContext, pContext->render_buffer, renderFrames);
 
-        pContext->samples_played++;
+    // Also stream to the WAV file (at the internal rate)
+    if (pContext->wav)
+    {
+        wav_writer_write(pContext->wav, pContext->render_buffer, renderFrames);
     }
 
-    if (actualInputFrames == 0)
+    if (renderFrames < frames)
     {
-        actualInputFrames = requiredInputFrames;
+        // Fill rest with silence
+        memset(pContext->render_buffer + renderFrames * 2, 0, (size_t)(frames - renderFrames) * 2 * sizeof(int32_t));
+        return 1;
     }
+    return 0;
+}
 
-    // Resample
-    ma_uint64 inputFramesProcessed = actualInputFrames;
-    ma_uint64 outputFramesProcessed = frameCount;
-    result = ma_resampler_process_pcm_frames(&pContext->resampler,
-                                             pContext->internal_buffer, &inputFramesProcessed,
-                                             pOutputS16, &outputFramesProcessed);
+// Render frameCount output frames: emulate at the internal rate and, unless
+// the device runs at INTERNAL_SAMPLE_RATE, resample. Runs on the render thread
+// (render_thread.h). Returns 1 once the song has ended; the frames of that
+// call are padded with silence.
+int render_output_frames(AudioContext *pContext, int16_t *pOutputS16, ma_uint32 frameCount)
+{
+    int finished = 0;
 
-    if (result != MA_SUCCESS)
+    // Native rate: convert straight to 16-bit, a buffer at a time
+    if (!pContext->resample)
     {
-        memset(pOutput, 0, frameCount * 2 * sizeof(int16_t));
-        return;
+        for (ma_uint32 done = 0; done < frameCount;)
+        {
+            uint32_t chunk = frameCount - done < INTERNAL_BUFFER_SIZE ? frameCount - done : INTERNAL_BUFFER_SIZE;
+            finished |= render_internal_frames(pContext, chunk);
+            OPM_ConvertS16(pOutputS16 + done * 2, pContext->render_buffer, chunk * 2);
+            done += chunk;
+        }
+        return finished;
     }
 
-    // Fill remaining with silence
-    if (outputFramesProcessed < frameCount)
+    // Any callback size: render at most INTERNAL_BUFFER_SIZE input frames at a
+    // time; input the resampler has not used yet stays buffered in it
+    ma_uint32 done = 0;
+    while (done < frameCount)
     {
-        for (ma_uint64 i = outputFramesProcessed; i < frameCount; i++)
+        uint32_t requiredInputFrames = OPM_ResamplerRequiredInput(&pContext->resampler, frameCount - done);
+        if (requiredInputFrames > INTERNAL_BUFFER_SIZE)
+        {
+            requiredInputFrames = INTERNAL_BUFFER_SIZE;
+        }
+        finished |= render_internal_frames(pContext, requiredInputFrames);
+
+        // Resample (and convert to 16-bit)
+        uint32_t outputFramesProcessed = OPM_ResamplerProcess(&pContext->resampler, pContext->render_buffer,
+                                                              requiredInputFrames, pOutputS16 + done * 2, frameCount - done);
+        if (outputFramesProcessed == 0)
         {
-            pOutputS16[i * 2] = 0;
-            pOutputS16[i * 2 + 1] = 0;
+            break; // Out of memory in the resampler
         }
+        done += outputFramesProcessed;
+    }
+
+    // Fill remaining with silence
+    if (done < frameCount)
+    {
+        memset(pOutputS16 + done * 2, 0, (frameCount - done) * 2 * sizeof(int16_t));
     }
+    return finished;
 }
@@ -22,7 +22,7 @@ RegisterEventList *create_event_list()
 }
 
 // Add event to list with is_data_write flag
-void add_event_with_flag(RegisterEventList *list, uint32_t sample_time, uint8_t address, uint8_t data, uint8_t is_data_write)
+void add_event_with_flag(RegisterEventList *list, uint64_t cycle_time, uint8_t address, uint8_t data, uint8_t is_data_write)
 {
     if (list->count >= list->capacity)
     {
@@ -35,7 +35,7 @@ void add_event_with_flag(RegisterEventList *list, uint32_t sample_time, uint8_t
         }
         list->events = new_events;
     }
-    list->events[list->count].sample_time = sample_time;
+    list->events[list->count].cycle_time = cycle_time;
     list->events[list->count].address = address;
     list->events[list->count].data = data;
     list->events[list->count].is_data_write = is_data_write;
@@ -43,9 +43,9 @@ void add_event_with_flag(RegisterEventList *list, uint32_t sample_time, uint8_t
 }
 
 // Add event to list (sets is_data_write=0, used by pass1 generation)
-void add_event(RegisterEventList *list, uint32_t sample_time, uint8_t address, uint8_t data)
+void add_event(RegisterEventList *list, uint64_t cycle_time, uint8_t address, uint8_t data)
 {
-    add_event_with_flag(list, sample_time, address, data, 0);
+    add_event_with_flag(list, cycle_time, address, data, 0);
 }
 
 // Free event list
@@ -61,6 +61,12 @@ uint32_t duration_to_samples(double duration_seconds)
     return (uint32_t)(duration_seconds * INTERNAL_SAMPLE_RATE);
 }
 
+// Calculate OPM clock cycles for a duration (event timestamps)
+uint64_t duration_to_cycles(double duration_seconds)
+{
+    return (uint64_t)(duration_seconds * OPM_CLOCK);
+}
+
 // MIDI note to YM2151 KC/KF conversion
 void midi_to_kc_kf(uint8_t midi_note, uint8_t *kc, uint8_t *kf)
 {
@@ -98,11 +104,11 @@ RegisterEventList *generate_pass1_events()
 
     // Calculate timing
     double quarter_note_duration = 60.0 / BPM; // 0.5 seconds for BPM 120
-    uint32_t quarter_note_samples = duration_to_samples(quarter_note_duration);
+    uint64_t quarter_note_cycles = duration_to_cycles(quarter_note_duration);
 
     printf("Pass 1: Generating musical events\n");
-    printf("  Quarter note duration: %.4f seconds (%u samples)\n",
-           quarter_note_duration, quarter_note_samples);
+    printf("  Quarter note duration: %.4f seconds (%llu cycles)\n",
+           quarter_note_duration, (unsigned long long)quarter_note_cycles);
 
     // Initialize: Reset all channels
     for (int ch = 0; ch < 8; ch++)
@@ -156,12 +162,12 @@ RegisterEventList *generate_pass1_events()
 
     for (int i = 0; i < 4; i++)
     {
-        uint32_t note_start_time = i * quarter_note_samples;
+        uint64_t note_start_time = i * quarter_note_cycles;
         uint8_t kc, kf;
         midi_to_kc_kf(notes[i], &kc, &kf);
 
-        printf("  Note %d (%s, MIDI %d): start=%u samples, KC=0x%02X, KF=0x%02X\n",
-               i, note_names[i], notes[i], note_start_time, kc, kf);
+        printf("  Note %d (%s, MIDI %d): start=%llu cycles, KC=0x%02X, KF=0x%02X\n",
+               i, note_names[i], notes[i], (unsigned long long)note_start_time, kc, kf);
 
         // Set KC (Key Code)
         add_event(list, note_start_time, 0x28 + channel, kc);
@@ -173,7 +179,7 @@ RegisterEventList *generate_pass1_events()
         add_event(list, note_start_time, 0x08, 0x78 | channel);
 
         // Key OFF (at end of quarter note)
-        uint32_t note_end_time = (i + 1) * quarter_note_samples;
+        uint64_t note_end_time = (i + 1) * quarter_note_cycles;
         add_event(list, note_end_time, 0x08, channel);
     }
 
@@ -181,41 +187,25 @@ RegisterEventList *generate_pass1_events()
     return list;
 }
 
-// Pass 2: Add register write delays and split addr/data writes
+// Pass 2: Split addr/data writes
+// No delays are added: the chip's write queue (OPM_QueueWrite) spaces the writes
+// made at the same time by its busy flag, about 36 cycles per register
 RegisterEventList *generate_pass2_events(RegisterEventList *pass1)
 {
     RegisterEventList *list = create_event_list();
 
-    printf("Pass 2: Splitting register writes and adding delays\n");
-    printf("  Delay per register write: %d samples\n", DELAY_SAMPLES);
-
-    uint32_t accumulated_delay = 0;
-    uint32_t last_time = 0;
+    printf("Pass 2: Splitting register writes\n");
+    printf("  Writes at the same time are spaced by the chip's busy flag\n");
 
     for (size_t i = 0; i < pass1->count; i++)
     {
         RegisterEvent *event = &pass1->events[i];
 
-        // If this event is at a different musical time, reset accumulated delay
-        if (event->sample_time != last_time)
-        {
-            accumulated_delay = 0;
-            last_time = event->sample_time;
-        }
-
-        // Split each pass1 event into two pass2 events with timing:
+        // Split each pass1 event into two pass2 events at the same time:
         // Note: Both address and data are stored in each event for clarity in JSON output
         // and to track the complete register write operation.
-
-        // 1. Address register write at time T
-        uint32_t addr_time = event->sample_time + accumulated_delay;
-        add_event_with_flag(list, addr_time, event->address, event->data, 0); // is_data_write = 0
-        accumulated_delay += DELAY_SAMPLES;
-
-        // 2. Data register write at time T + DELAY_SAMPLES
-        uint32_t data_time = event->sample_time + accumulated_delay;
-        add_event_with_flag(list, data_time, event->address, event->data, 1); // is_data_write = 1
-        accumulated_delay += DELAY_SAMPLES;
+        add_event_with_flag(list, event->cycle_time, event->address, event->data, 0); // is_data_write = 0
+        add_event_with_flag(list, event->cycle_time, event->address, event->data, 1); // is_data_write = 1
     }
 
     printf("  Pass 2 complete: %zu events (split from %zu pass1 events)\n\n", list->count, pass1->count);
@@ -229,22 +219,22 @@ double calculate_playback_duration(RegisterEventList *pass2)
         return 1.0;
 
     // Find last event time
-    uint32_t last_event_time = 0;
+    uint64_t last_event_time = 0;
     for (size_t i = 0; i < pass2->count; i++)
     {
-        if (pass2->events[i].sample_time > last_event_time)
+        if (pass2->events[i].cycle_time > last_event_time)
         {
-            last_event_time = pass2->events[i].sample_time;
+            last_event_time = pass2->events[i].cycle_time;
         }
     }
 
     // Add 1 second after last event
-    uint32_t total_samples = last_event_time + INTERNAL_SAMPLE_RATE;
+    uint32_t total_samples = (uint32_t)(last_event_time / CYCLES_PER_SAMPLE) + INTERNAL_SAMPLE_RATE;
     double duration = (double)total_samples / INTERNAL_SAMPLE_RATE;
 
     printf("Playback duration calculation:\n");
-    printf("  Last event at: %u samples (%.3f seconds)\n",
-           last_event_time, (double)last_event_time / INTERNAL_SAMPLE_RATE);
+    printf("  Last event at: %llu cycles (%.3f seconds)\n",
+           (unsigned long long)last_event_time, (double)last_event_time / OPM_CLOCK);
     printf("  Total duration: %.3f seconds (%u samples)\n\n", duration, total_samples);
 
     return duration;
@@ -267,8 +257,8 @@ void save_events_json(const char *filename, RegisterEventList *events)
     for (size_t i = 0; i < events->count; i++)
     {
         RegisterEvent *e = &events->events[i];
-        fprintf(fp, "    {\"time\": %u, \"addr\": \"0x%02X\", \"data\": \"0x%02X\", \"is_data\": %u}",
-                e->sample_time, e->address, e->data, e->is_data_write);
+        fprintf(fp, "    {\"cycle\": %llu, \"addr\": \"0x%02X\", \"data\": \"0x%02X\", \"is_data\": %u}",
+                (unsigned long long)e->cycle_time, e->address, e->data, e->is_data_write);
         if (i < events->count - 1)
         {
             fprintf(fp, ",");
@@ -0,0 +1,78 @@
+#include "types.h"
+
+// Seconds between keyframes: seeking renders forward less than this
+#define KEYFRAME_INTERVAL_SECONDS 2
+
+// Initialize an empty keyframe index
+void init_keyframe_index(KeyframeIndex *index, uint32_t interval_samples)
+{
+    index->snapshots = NULL;
+    index->count = 0;
+    index->capacity = 0;
+    index->interval_samples = interval_samples;
+}
+
+// Take the next keyframe if ctx has just reached it. Call at each sample
+// boundary before that sample's events are processed.
+int record_keyframe(KeyframeIndex *index, const AudioContext *ctx)
+{
+    if (ctx->samples_played != index->count * index->interval_samples)
+    {
+        return 1;
+    }
+    if (index->count >= index->capacity)
+    {
+        size_t capacity = index->capacity ? index->capacity * 2 : 64;
+        PlayerSnapshot *snapshots = (PlayerSnapshot *)realloc(index->snapshots, sizeof(PlayerSnapshot) * capacity);
+        if (!snapshots)
+        {
+            fprintf(stderr, "❌ Failed to reallocate keyframes\n");
+            return 0;
+        }
+        index->snapshots = snapshots;
+        index->capacity = capacity;
+    }
+    if (!save_player_snapshot(ctx, &index->snapshots[index->count]))
+    {
+        return 0;
+    }
+    index->count++;
+    return 1;
+}
+
+// Last keyframe at or before target_sample, or NULL if there is none yet
+const PlayerSnapshot *find_keyframe(const KeyframeIndex *index, uint32_t target_sample)
+{
+    size_t i = target_sample / index->interval_samples;
+    if (index->count == 0)
+    {
+        return NULL;
+    }
+    if (i >= index->count)
+    {
+        i = index->count - 1;
+    }
+    return &index->snapshots[i];
+}
+
+// Total bytes held by the keyframes
+size_t keyframe_index_size(const KeyframeIndex *index)
+{
+    size_t size = 0;
+    for (size_t i = 0; i < index->count; i++)
+    {
+        size += index->snapshots[i].size;
+    }
+    return size;
+}
+
+// Free all keyframes
+void free_keyframe_index(KeyframeIndex *index)
+{
+    for (size_t i = 0; i < index->count; i++)
+    {
+        free_player_snapshot(&index->snapshots[i]);
+    }
+    free(index->snapshots);
+    init_keyframe_index(index, index->interval_samples);
+}
@@ -4,18 +4,239 @@
  * - 2-pass processing: musical data -> register writes with delays
  * - JSON output for testing
  * - Real-time playback with WAV file output
+ * - Headless offline rendering (--offline), faster than realtime
+ * - 16-bit, 24-bit or float WAV output (--format), RF64 past 4 GB
+ * - Start partway into the song (--start)
+ * - Play it again from the start point (--repeat), seeking through keyframes
+ *   recorded on the first pass
  */
 
 #include "types.h"
 #include "events.h"
-#include "core.h"
+#include "snapshot.h"
+#include "keyframes.h"
 #include "wav_writer.h"
+#include "core.h"
+#include "render_thread.h"
+
+// Open the playback device at sampleRate with periods of periodMs
+static int open_device(AudioContext *context, ma_device *device, ma_uint32 sampleRate, ma_uint32 periodMs)
+{
+    ma_device_config deviceConfig = ma_device_config_init(ma_device_type_playback);
+    deviceConfig.playback.format = ma_format_s16;
+    deviceConfig.playback.channels = 2;
+    deviceConfig.sampleRate = sampleRate;
+    deviceConfig.periodSizeInMilliseconds = periodMs;
+    deviceConfig.dataCallback = data_callback;
+    deviceConfig.pUserData = context;
+
+    return ma_device_init(NULL, &deviceConfig, device) == MA_SUCCESS;
+}
+
+// Open the device at INTERNAL_SAMPLE_RATE if the backend takes it natively,
+// otherwise at the backend's own rate with the polyphase resampler in front.
+static int open_output(AudioContext *context, ma_device *device, int force_resample, ma_uint32 periodMs)
+{
+    ma_uint32 deviceRate = OUTPUT_SAMPLE_RATE;
+
+    if (!force_resample)
+    {
+        if (!open_device(context, device, INTERNAL_SAMPLE_RATE, periodMs))
+        {
+            fprintf(stderr, "❌ Failed to initialize audio device\n");
+            return 0;
+        }
+
+        // miniaudio converts silently when the backend picked another rate
+        if (device->playback.internalSampleRate == INTERNAL_SAMPLE_RATE)
+        {
+            context->resample = 0;
+            printf("   Output: native %u Hz, no resampling\n", (unsigned)INTERNAL_SAMPLE_RATE);
+            return 1;
+        }
+        deviceRate = device->playback.internalSampleRate;
+        ma_device_uninit(device);
+        printf("   Device does not accept %u Hz (runs at %u Hz)\n", (unsigned)INTERNAL_SAMPLE_RATE, deviceRate);
+    }
+
+    if (!open_device(context, device, deviceRate, periodMs))
+    {
+        fprintf(stderr, "❌ Failed to initialize audio device\n");
+        return 0;
+    }
+    if (!OPM_ResamplerInit(&context->resampler, INTERNAL_SAMPLE_RATE, device->sampleRate))
+    {
+        fprintf(stderr, "❌ Failed to initialize resampler\n");
+        ma_device_uninit(device);
+        return 0;
+    }
+    context->resample = 1;
+    printf("   Output: resampling %u Hz -> %u Hz\n", (unsigned)INTERNAL_SAMPLE_RATE, device->sampleRate);
+
+    // The resampler removes everything above the device's Nyquist rate, so
+    // low device rates audibly lose the top of the chip's range
+    if (device->sampleRate < OUTPUT_SAMPLE_RATE_MIN_FULL_BAND)
+    {
+        printf("   ⚠️  %u Hz device: output above about %u Hz is filtered out\n", device->sampleRate,
+               (unsigned)(device->sampleRate / 2 - RESAMPLER_TRANSITION_HZ));
+    }
+    return 1;
+}
+
+static void close_output(AudioContext *context, ma_device *device)
+{
+    ma_device_uninit(device);
+    if (context->resample)
+    {
+        OPM_ResamplerFree(&context->resampler);
+    }
+}
+
+// Play through the default device in real time. Returns 0 on failure.
+static int play_realtime(AudioContext *context, int force_resample, ma_uint32 periodMs)
+{
+    printf("Initializing audio...\n");
+
+    ma_device device;
+    if (!open_output(context, &device, force_resample, periodMs))
+    {
+        return 0;
+    }
+
+    printf("✅ Audio initialized (%u-frame periods)\n\n", device.playback.internalPeriodSizeInFrames);
+
+    // Emulate on a separate thread; the callback only copies frames out
+    if (!start_render_thread(context, device.playback.internalPeriodSizeInFrames))
+    {
+        close_output(context, &device);
+        return 0;
+    }
+
+    // Start playback
+    if (ma_device_start(&device) != MA_SUCCESS)
+    {
+        fprintf(stderr, "❌ Failed to start audio device\n");
+        stop_render_thread(context);
+        close_output(context, &device);
+        return 0;
+    }
+
+    printf("▶  Playing sequence...\n");
+
+    // Wait for playback to finish
+    while (context->is_playing)
+    {
+        ma_sleep(100);
+    }
+
+    // Stop and cleanup audio
+    ma_device_uninit(&device);
+    stop_render_thread(context);
+    if (context->resample)
+    {
+        OPM_ResamplerFree(&context->resampler);
+    }
+
+    printf("■  Playback complete\n");
+    printf("   %u underruns\n", context->underruns);
+    return 1;
+}
+
+// Print the command line options to out
+static void print_usage(FILE *out, const char *program)
+{
+    fprintf(out,
+            "Usage: %s [--offline] [--resample] [--period-ms N] [--format s16|s24|f32] [--start SECONDS]\n"
+            "       [--repeat N] [output.wav]\n",
+            program);
+}
 
 int main(int argc, char **argv)
 {
     printf("Phase4: BPM120 Music Sequence Player\n");
     printf("=====================================\n\n");
 
+    int offline = 0;
+    int force_resample = 0;
+    int period_ms = DEVICE_PERIOD_MS;
+    int wav_format = WAV_FORMAT_S16;
+    double start_seconds = 0.0;
+    int repeat = 1;
+    const char *wav_filename = "phase4_output.wav";
+    for (int i = 1; i < argc; i++)
+    {
+        // Options that take a value must have one
+        int has_value = strcmp(argv[i], "--period-ms") == 0 || strcmp(argv[i], "--format") == 0 ||
+                        strcmp(argv[i], "--start") == 0 || strcmp(argv[i], "--repeat") == 0;
+        if (has_value && i + 1 >= argc)
+        {
+            fprintf(stderr, "❌ Missing value for %s\n", argv[i]);
+            print_usage(stderr, argv[0]);
+            return 1;
+        }
+
+        if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0)
+        {
+            print_usage(stdout, argv[0]);
+            return 0;
+        }
+        else if (strcmp(argv[i], "--offline") == 0)
+        {
+            offline = 1;
+        }
+        else if (strcmp(argv[i], "--resample") == 0)
+        {
+            force_resample = 1;
+        }
+        else if (strcmp(argv[i], "--period-ms") == 0)
+        {
+            period_ms = atoi(argv[++i]);
+            if (period_ms <= 0)
+            {
+                fprintf(stderr, "❌ Invalid device period: %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--format") == 0)
+        {
+            wav_format = wav_format_from_name(argv[++i]);
+            if (wav_format < 0)
+            {
+                fprintf(stderr, "❌ Unknown WAV format: %s (use s16, s24 or f32)\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--start") == 0)
+        {
+            char *end;
+            start_seconds = strtod(argv[++i], &end);
+            if (*end != '\0' || !(start_seconds >= 0.0))
+            {
+                fprintf(stderr, "❌ Invalid start time: %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--repeat") == 0)
+        {
+            repeat = atoi(argv[++i]);
+            if (repeat <= 0)
+            {
+                fprintf(stderr, "❌ Invalid repeat count: %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (argv[i][0] == '-' && argv[i][1] != '\0')
+        {
+            fprintf(stderr, "❌ Unknown option: %s\n", argv[i]);
+            print_usage(stderr, argv[0]);
+            return 1;
+        }
+        else
+        {
+            wav_filename = argv[i];
+        }
+    }
+
     // Generate pass1 events (musical)
     RegisterEventList *pass1 = generate_pass1_events();
     save_events_json("phase4_pass1.json", pass1);
@@ -32,91 +253,94 @@ int main(int argc, char **argv)
     AudioContext context;
     memset(&context, 0, sizeof(AudioContext));
 
-    // Allocate WAV buffer
-    context.wav_buffer = (int32_t *)malloc(total_samples * 2 * sizeof(int32_t));
-    if (!context.wav_buffer)
+    // Stream the output to the WAV file while rendering (static: the write
+    // buffer is too large for the stack)
+    static WavWriter wav;
+    if (!wav_writer_open(&wav, wav_filename, wav_format))
     {
-        fprintf(stderr, "❌ Failed to allocate WAV buffer\n");
         return 1;
     }
-    context.wav_buffer_pos = 0;
-
-    // Initialize OPM chip
-    OPM_Reset(&context.chip);
+    context.wav = &wav;
 
-    // Set playback parameters
+    // Set playback parameters, then reset the chip and apply the song's setup
     context.events = pass2;
-    context.next_event_index = 0;
-    context.samples_played = 0;
     context.total_samples = total_samples;
     context.is_playing = 1;
+    start_playback(&context);
 
-    printf("Initializing audio...\n");
-
-    // Initialize resampler
-    ma_resampler_config resamplerConfig = ma_resampler_config_init(
-        ma_format_s16, 2, INTERNAL_SAMPLE_RATE, OUTPUT_SAMPLE_RATE,
-        ma_resample_algorithm_linear);
-
-    if (ma_resampler_init(&resamplerConfig, NULL, &context.resampler) != MA_SUCCESS)
+    // Later passes seek back through keyframes recorded while the first one
+    // renders, so they only replay less than KEYFRAME_INTERVAL_SECONDS
+    KeyframeIndex keyframes;
+    init_keyframe_index(&keyframes, KEYFRAME_INTERVAL_SECONDS * INTERNAL_SAMPLE_RATE);
+    if (repeat > 1)
     {
-        fprintf(stderr, "❌ Failed to initialize resampler\n");
-        free(context.wav_buffer);
-        return 1;
+        context.keyframes = &keyframes;
     }
 
-    // Configure MiniAudio device
-    ma_device_config deviceConfig = ma_device_config_init(ma_device_type_playback);
-    deviceConfig.playback.format = ma_format_s16;
-    deviceConfig.playback.channels = 2;
-    deviceConfig.sampleRate = OUTPUT_SAMPLE_RATE;
-    deviceConfig.dataCallback = data_callback;
-    deviceConfig.pUserData = &context;
-
-    ma_device device;
-    if (ma_device_init(NULL, &deviceConfig, &device) != MA_SUCCESS)
+    // Every pass skips ahead to the start point without output, so the WAV
+    // file holds each pass from there
+    uint32_t start_sample = start_seconds < duration ? duration_to_samples(start_seconds) : total_samples;
+    int ok = 1;
+    for (int pass = 0; pass < repeat && ok; pass++)
     {
-        fprintf(stderr, "❌ Failed to initialize audio device\n");
-        ma_resampler_uninit(&context.resampler, NULL);
-        free(context.wav_buffer);
-        return 1;
-    }
+        if (pass > 0)
+        {
+            printf("Pass %d of %d\n", pass + 1, repeat);
+        }
+        if (start_sample > 0 || pass > 0)
+        {
+            ma_timer timer;
+            ma_timer_init(&timer);
+            if (!seek_to_sample(&context, start_sample))
+            {
+                ok = 0;
+                break;
+            }
+            printf("   Starting at %.2f s (sample %u, sought in %.3f s)\n\n",
+                   (double)context.samples_played / INTERNAL_SAMPLE_RATE, context.samples_played,
+                   ma_timer_get_time_in_seconds(&timer));
+        }
 
-    printf("✅ Audio initialized\n\n");
+        if (offline)
+        {
+            // No device: render as fast as the CPU allows
+            printf("Rendering offline...\n");
+            double seconds = (double)(total_samples - context.samples_played) / INTERNAL_SAMPLE_RATE;
+            double elapsed = render_offline(&context);
+            printf("■  Rendered %.2f s of audio in %.3f s (%.1fx realtime)\n", seconds, elapsed,
+                   elapsed > 0 ? seconds / elapsed : 0.0);
+        }
+        else
+        {
+            ok = play_realtime(&context, force_resample, (ma_uint32)period_ms);
+        }
+        printf("\n");
+    }
 
-    // Start playback
-    if (ma_device_start(&device) != MA_SUCCESS)
+    if (repeat > 1)
     {
-        fprintf(stderr, "❌ Failed to start audio device\n");
-        ma_device_uninit(&device);
-        ma_resampler_uninit(&context.resampler, NULL);
-        free(context.wav_buffer);
-        return 1;
+        printf("   %zu keyframes every %d s (%zu bytes)\n\n", keyframes.count, KEYFRAME_INTERVAL_SECONDS,
+               keyframe_index_size(&keyframes));
     }
-
-    printf("▶  Playing sequence...\n");
-
-    // Wait for playback to finish
-    while (context.is_playing)
+    free_keyframe_index(&keyframes);
+    if (!ok)
     {
-        ma_sleep(100);
+        wav_writer_close(&wav, wav_filename);
+        return 1;
     }
 
-    printf("■  Playback complete\n\n");
-
-    // Stop and cleanup audio
-    ma_device_uninit(&device);
-    ma_resampler_uninit(&context.resampler, NULL);
-
-    // Save WAV file
-    const char *wav_filename = (argc > 1) ? argv[1] : "phase4_output.wav";
-    save_wav_file(wav_filename, context.wav_buffer, context.wav_buffer_pos);
+    // Finish the WAV file
+    int saved = wav_writer_close(&wav, wav_filename);
 
     // Cleanup
-    free(context.wav_buffer);
     free_event_list(pass1);
     free_event_list(pass2);
 
+    if (!saved)
+    {
+        return 1;
+    }
+
     printf("\n✅ Phase4 complete!\n");
     return 0;
 }
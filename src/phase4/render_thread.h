@@ -0,0 +1,135 @@
+// Emulation runs on its own thread and fills a single-producer/single-consumer
+// ring of output frames (miniaudio's lock-free ma_pcm_rb). The audio callback
+// only copies frames out, so its run time no longer depends on the emulator.
+//
+// Shared by phase3 and phase4. The including file first defines AudioContext
+// (with is_playing, ring, render_thread, render_done, stop_render and
+// underruns), RING_BUFFER_FRAMES, RENDER_PERIOD_FRAMES and
+// render_output_frames(); phase4 takes them from types.h and core.h.
+
+// Render one period into the ring if there is room. Returns 0 if the ring is full.
+static int render_period(AudioContext *ctx)
+{
+    if (ma_pcm_rb_available_write(&ctx->ring) < RENDER_PERIOD_FRAMES)
+    {
+        return 0;
+    }
+
+    ma_uint32 frames = RENDER_PERIOD_FRAMES;
+    void *buffer;
+    if (ma_pcm_rb_acquire_write(&ctx->ring, &frames, &buffer) != MA_SUCCESS)
+    {
+        return 0;
+    }
+    int finished = render_output_frames(ctx, (int16_t *)buffer, frames);
+    ma_pcm_rb_commit_write(&ctx->ring, frames);
+
+    // Only flag the end once its frames are visible to the callback
+    if (finished)
+    {
+        ma_atomic_bool32_set(&ctx->render_done, MA_TRUE);
+    }
+    return 1;
+}
+
+static ma_thread_result MA_THREADCALL render_thread_main(void *pData)
+{
+    AudioContext *ctx = (AudioContext *)pData;
+
+    while (!ma_atomic_bool32_get(&ctx->stop_render) && !ma_atomic_bool32_get(&ctx->render_done))
+    {
+        if (!render_period(ctx))
+        {
+            ma_sleep(1); // Ring full: the device is a whole ring behind
+        }
+    }
+    return (ma_thread_result)0;
+}
+
+// Fill the ring, then keep it filled from a new thread. The ring holds at
+// least two device periods of period_frames, so one can be rendered while
+// the other plays. Call before starting the device; playback must not be moved
+// (phase4: seek_to_sample()) while the thread runs.
+int start_render_thread(AudioContext *ctx, ma_uint32 period_frames)
+{
+    ma_uint32 ring_frames = RING_BUFFER_FRAMES;
+    if (ring_frames < period_frames * 2 + RENDER_PERIOD_FRAMES)
+    {
+        ring_frames = period_frames * 2 + RENDER_PERIOD_FRAMES;
+    }
+
+    if (ma_pcm_rb_init(ma_format_s16, 2, ring_frames, NULL, NULL, &ctx->ring) != MA_SUCCESS)
+    {
+        fprintf(stderr, "❌ Failed to allocate render ring buffer\n");
+        return 0;
+    }
+    ma_atomic_bool32_set(&ctx->render_done, MA_FALSE);
+    ma_atomic_bool32_set(&ctx->stop_render, MA_FALSE);
+    ctx->underruns = 0;
+
+    while (!ma_atomic_bool32_get(&ctx->render_done) && render_period(ctx))
+    {
+    }
+
+    if (ma_thread_create(&ctx->render_thread, ma_thread_priority_highest, 0, render_thread_main, ctx, NULL) != MA_SUCCESS)
+    {
+        fprintf(stderr, "❌ Failed to start render thread\n");
+        ma_pcm_rb_uninit(&ctx->ring);
+        return 0;
+    }
+    return 1;
+}
+
+// Stop the render thread (if still running) and free the ring
+void stop_render_thread(AudioContext *ctx)
+{
+    ma_atomic_bool32_set(&ctx->stop_render, MA_TRUE);
+    ma_thread_wait(&ctx->render_thread);
+    ma_pcm_rb_uninit(&ctx->ring);
+}
+
+// MiniAudio data callback: copy rendered frames out of the ring
+void data_callback(ma_device *pDevice, void *pOutput, const void *pInput, ma_uint32 frameCount)
+{
+    AudioContext *pContext = (AudioContext *)pDevice->pUserData;
+    int16_t *pOutputS16 = (int16_t *)pOutput;
+    ma_uint32 copied = 0;
+
+    (void)pInput;
+
+    // Read before draining: the flag is set only after the last frames are in
+    ma_bool32 render_done = ma_atomic_bool32_get(&pContext->render_done);
+
+    if (!pContext->is_playing)
+    {
+        memset(pOutput, 0, frameCount * 2 * sizeof(int16_t));
+        return;
+    }
+
+    // Two reads at most: the readable region may wrap around the ring
+    while (copied < frameCount)
+    {
+        ma_uint32 frames = frameCount - copied;
+        void *buffer;
+        if (ma_pcm_rb_acquire_read(&pContext->ring, &frames, &buffer) != MA_SUCCESS || frames == 0)
+        {
+            break;
+        }
+        memcpy(pOutputS16 + copied * 2, buffer, frames * 2 * sizeof(int16_t));
+        ma_pcm_rb_commit_read(&pContext->ring, frames);
+        copied += frames;
+    }
+
+    if (copied < frameCount)
+    {
+        memset(pOutputS16 + copied * 2, 0, (frameCount - copied) * 2 * sizeof(int16_t));
+        if (render_done)
+        {
+            pContext->is_playing = 0;
+        }
+        else
+        {
+            pContext->underruns++;
+        }
+    }
+}
@@ -0,0 +1,254 @@
+/* Resampler benchmark: polyphase FIR (opm_resample.c) against the miniaudio
+ * linear resampler the players used, from the internal chip rate to 48000 and
+ * 44100 Hz. Both are fed the same int32 chip-level audio in callback-sized
+ * blocks; the linear path gets it converted to 16-bit first, as the players did.
+ * Reports:
+ * - cost in ns per output frame
+ * - SNR of in-band tones (fit of the expected sine at the output rate)
+ * - level of the images of tones above the output Nyquist rate, split into
+ *   those folding into the audible band and those above 20 kHz
+ */
+
+#define MINIAUDIO_IMPLEMENTATION
+#include "miniaudio.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include "../../opm_convert.h"
+#include "../../opm_resample.h"
+
+#define OPM_CLOCK 3579545
+#define CYCLES_PER_SAMPLE 64
+#define INTERNAL_SAMPLE_RATE (OPM_CLOCK / CYCLES_PER_SAMPLE) // ~55930 Hz
+
+#define BENCH_SECONDS 20
+#define TONE_SECONDS 2
+#define BLOCK_FRAMES 512     // Output frames per call, like a device period
+#define TONE_AMPLITUDE 20000 // Chip output level (10000 after the 16-bit / 2)
+#define IMAGE_STEP_HZ 250
+#define AUDIBLE_HZ 20000
+#define SILENCE_DB -120.0 // Below 16-bit resolution: the output is all zero
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Resample in_frames frames of chip output with either path. Returns output
+// frames; *seconds is the time spent resampling, without setup.
+static uint32_t resample_polyphase(uint32_t out_rate, const int32_t *in, uint32_t in_frames, int16_t *out,
+                                   double *seconds)
+{
+    opm_resampler_t resampler;
+    ma_timer timer;
+    uint32_t used = 0, produced = 0;
+    if (!OPM_ResamplerInit(&resampler, INTERNAL_SAMPLE_RATE, out_rate))
+    {
+        return 0;
+    }
+    ma_timer_init(&timer);
+    for (;;)
+    {
+        uint32_t need = OPM_ResamplerRequiredInput(&resampler, BLOCK_FRAMES);
+        if (used + need > in_frames)
+        {
+            break;
+        }
+        produced += OPM_ResamplerProcess(&resampler, in + used * 2, need, out + produced * 2, BLOCK_FRAMES);
+        used += need;
+    }
+    *seconds = ma_timer_get_time_in_seconds(&timer);
+    OPM_ResamplerFree(&resampler);
+    return produced;
+}
+
+static uint32_t resample_linear(uint32_t out_rate, const int32_t *in, uint32_t in_frames, int16_t *out,
+                                double *seconds)
+{
+    static int16_t block[4096 * 2];
+    ma_resampler resampler;
+    ma_timer timer;
+    ma_resampler_config config = ma_resampler_config_init(ma_format_s16, 2, INTERNAL_SAMPLE_RATE, out_rate,
+                                                          ma_resample_algorithm_linear);
+    uint32_t used = 0, produced = 0;
+    if (ma_resampler_init(&config, NULL, &resampler) != MA_SUCCESS)
+    {
+        return 0;
+    }
+    ma_timer_init(&timer);
+    for (;;)
+    {
+        ma_uint64 need = 0;
+        ma_resampler_get_required_input_frame_count(&resampler, BLOCK_FRAMES, &need);
+        if (used + need > in_frames)
+        {
+            break;
+        }
+        OPM_ConvertS16(block, in + used * 2, (uint32_t)need * 2);
+        ma_uint64 in_count = need, out_count = BLOCK_FRAMES;
+        ma_resampler_process_pcm_frames(&resampler, block, &in_count, out + produced * 2, &out_count);
+        used += (uint32_t)in_count;
+        produced += (uint32_t)out_count;
+    }
+    *seconds = ma_timer_get_time_in_seconds(&timer);
+    ma_resampler_uninit(&resampler, NULL);
+    return produced;
+}
+
+typedef uint32_t (*resample_fn)(uint32_t, const int32_t *, uint32_t, int16_t *, double *);
+
+static void make_tone(int32_t *in, uint32_t frames, double freq)
+{
+    for (uint32_t i = 0; i < frames; i++)
+    {
+        int32_t v = (int32_t)lrint(TONE_AMPLITUDE * sin(2.0 * M_PI * freq * i / INTERNAL_SAMPLE_RATE));
+        in[i * 2] = v;
+        in[i * 2 + 1] = v;
+    }
+}
+
+// Least-squares fit of a sine at freq (output rate) to the left channel,
+// skipping the start-up; returns the fitted amplitude and the residual RMS
+static void fit_tone(const int16_t *out, uint32_t frames, uint32_t out_rate, double freq,
+                     double *amplitude, double *residual)
+{
+    uint32_t start = frames / 4;
+    double ss = 0, cc = 0, sc = 0, ys = 0, yc = 0;
+    for (uint32_t i = start; i < frames; i++)
+    {
+        double s = sin(2.0 * M_PI * freq * i / out_rate), c = cos(2.0 * M_PI * freq * i / out_rate);
+        double y = out[i * 2];
+        ss += s * s;
+        cc += c * c;
+        sc += s * c;
+        ys += y * s;
+        yc += y * c;
+    }
+    double det = ss * cc - sc * sc;
+    double a = (ys * cc - yc * sc) / det, b = (yc * ss - ys * sc) / det;
+    double err = 0;
+    for (uint32_t i = start; i < frames; i++)
+    {
+        double e = out[i * 2] - a * sin(2.0 * M_PI * freq * i / out_rate) - b * cos(2.0 * M_PI * freq * i / out_rate);
+        err += e * e;
+    }
+    *amplitude = sqrt(a * a + b * b);
+    *residual = sqrt(err / (frames - start));
+}
+
+static double rms(const int16_t *out, uint32_t frames)
+{
+    double sum = 0;
+    for (uint32_t i = frames / 4; i < frames; i++)
+    {
+        sum += (double)out[i * 2] * out[i * 2];
+    }
+    return sqrt(sum / (frames - frames / 4));
+}
+
+static void bench_rate(uint32_t out_rate)
+{
+    static const double in_band[] = {1000, 5000, 10000, 15000, 19000};
+    const char *names[2] = {"polyphase", "linear"};
+    resample_fn fns[2] = {resample_polyphase, resample_linear};
+    uint32_t in_frames = INTERNAL_SAMPLE_RATE * BENCH_SECONDS;
+    int32_t *in = (int32_t *)malloc((size_t)in_frames * 2 * sizeof(int32_t));
+    int16_t *out = (int16_t *)malloc((size_t)in_frames * 2 * sizeof(int16_t));
+    if (!in || !out)
+    {
+        fprintf(stderr, "Failed to allocate benchmark buffers\n");
+        free(in);
+        free(out);
+        return;
+    }
+
+    printf("\n%u Hz -> %u Hz\n", INTERNAL_SAMPLE_RATE, out_rate);
+
+    // Cost: a sweep-like mix so no path gets a trivially predictable signal
+    for (uint32_t i = 0; i < in_frames; i++)
+    {
+        double t = (double)i / INTERNAL_SAMPLE_RATE;
+        in[i * 2] = (int32_t)(TONE_AMPLITUDE * 0.5 * (sin(2.0 * M_PI * 440.0 * t) + sin(2.0 * M_PI * (200.0 + 500.0 * t) * t)));
+        in[i * 2 + 1] = -in[i * 2];
+    }
+    for (int f = 0; f < 2; f++)
+    {
+        double seconds;
+        uint32_t frames = fns[f](out_rate, in, in_frames, out, &seconds);
+        printf("  %-9s %6.1f ns/frame (%.0fx realtime)\n", names[f], seconds * 1e9 / frames,
+               (double)frames / out_rate / seconds);
+    }
+
+    // Quality
+    uint32_t tone_frames = INTERNAL_SAMPLE_RATE * TONE_SECONDS;
+    printf("  %-9s", "SNR dB");
+    for (size_t k = 0; k < sizeof(in_band) / sizeof(in_band[0]); k++)
+    {
+        printf(" %7.0fHz", in_band[k]);
+    }
+    printf("\n");
+    for (int f = 0; f < 2; f++)
+    {
+        double seconds;
+        printf("  %-9s", names[f]);
+        for (size_t k = 0; k < sizeof(in_band) / sizeof(in_band[0]); k++)
+        {
+            double amplitude, residual;
+            make_tone(in, tone_frames, in_band[k]);
+            uint32_t frames = fns[f](out_rate, in, tone_frames, out, &seconds);
+            fit_tone(out, frames, out_rate, in_band[k], &amplitude, &residual);
+            printf(" %9.1f", 20.0 * log10(amplitude / residual));
+        }
+        printf("\n");
+    }
+    // Tones above the output Nyquist rate fold back to out_rate - f. Report the
+    // loudest image that lands in the audible band and the loudest above it.
+    printf("  %-9s %12s %12s\n", "Images dB", "below 20kHz", "20kHz+");
+    for (int f = 0; f < 2; f++)
+    {
+        double worst_audible = -INFINITY, worst_high = -INFINITY, seconds;
+        for (double freq = out_rate / 2.0 + 250; freq < INTERNAL_SAMPLE_RATE / 2.0; freq += IMAGE_STEP_HZ)
+        {
+            make_tone(in, tone_frames, freq);
+            uint32_t frames = fns[f](out_rate, in, tone_frames, out, &seconds);
+            // Relative to the 16-bit tone RMS
+            double level = 20.0 * log10((rms(out, frames) + 1e-9) / (TONE_AMPLITUDE / 2 / sqrt(2.0)));
+            if (out_rate - freq < AUDIBLE_HZ)
+            {
+                worst_audible = level > worst_audible ? level : worst_audible;
+            }
+            else
+            {
+                worst_high = level > worst_high ? level : worst_high;
+            }
+        }
+        printf("  %-9s", names[f]);
+        if (isinf(worst_audible))
+        {
+            printf(" %12s", "none");
+        }
+        else if (worst_audible < SILENCE_DB)
+        {
+            printf(" %12s", "silent");
+        }
+        else
+        {
+            printf(" %12.1f", worst_audible);
+        }
+        printf(" %12.1f\n", worst_high);
+    }
+
+    free(in);
+    free(out);
+}
+
+int main(void)
+{
+    printf("Resampler benchmark: polyphase FIR (%d taps) vs miniaudio linear\n", OPM_RESAMPLE_TAPS);
+    printf("=================================================================\n");
+    bench_rate(48000);
+    bench_rate(44100);
+    return 0;
+}
@@ -0,0 +1,80 @@
+#include "types.h"
+
+// Player snapshot layout (little-endian):
+//   "P4SN", version, samples_played, next_event_index, then OPM_SaveState data
+#define PLAYER_SNAPSHOT_VERSION 1
+#define PLAYER_SNAPSHOT_HEADER_SIZE 16
+
+static void put_u32_le(uint8_t *p, uint32_t v)
+{
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = v >> 24;
+}
+
+static uint32_t get_u32_le(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// Save the chip state and playback position of ctx
+int save_player_snapshot(const AudioContext *ctx, PlayerSnapshot *snapshot)
+{
+    uint8_t buffer[PLAYER_SNAPSHOT_HEADER_SIZE + OPM_STATE_MAX_SIZE];
+
+    memcpy(buffer, "P4SN", 4);
+    put_u32_le(buffer + 4, PLAYER_SNAPSHOT_VERSION);
+    put_u32_le(buffer + 8, ctx->samples_played);
+    put_u32_le(buffer + 12, (uint32_t)ctx->next_event_index);
+    size_t chip_size = OPM_SaveState(&ctx->chip, buffer + PLAYER_SNAPSHOT_HEADER_SIZE, OPM_STATE_MAX_SIZE);
+
+    snapshot->size = PLAYER_SNAPSHOT_HEADER_SIZE + chip_size;
+    snapshot->data = (uint8_t *)malloc(snapshot->size);
+    if (!snapshot->data)
+    {
+        fprintf(stderr, "❌ Failed to allocate player snapshot\n");
+        snapshot->size = 0;
+        return 0;
+    }
+    memcpy(snapshot->data, buffer, snapshot->size);
+    return 1;
+}
+
+// Restore chip state and playback position; ctx is unchanged on failure
+int restore_player_snapshot(AudioContext *ctx, const PlayerSnapshot *snapshot)
+{
+    if (snapshot->size < PLAYER_SNAPSHOT_HEADER_SIZE || memcmp(snapshot->data, "P4SN", 4) != 0 ||
+        get_u32_le(snapshot->data + 4) != PLAYER_SNAPSHOT_VERSION)
+    {
+        fprintf(stderr, "❌ Invalid player snapshot\n");
+        return 0;
+    }
+
+    uint32_t samples_played = get_u32_le(snapshot->data + 8);
+    size_t next_event_index = get_u32_le(snapshot->data + 12);
+    if (next_event_index > ctx->events->count)
+    {
+        fprintf(stderr, "❌ Player snapshot does not match the event list\n");
+        return 0;
+    }
+    if (!OPM_LoadState(&ctx->chip, snapshot->data + PLAYER_SNAPSHOT_HEADER_SIZE,
+                       snapshot->size - PLAYER_SNAPSHOT_HEADER_SIZE))
+    {
+        fprintf(stderr, "❌ Invalid chip state in player snapshot\n");
+        return 0;
+    }
+
+    ctx->samples_played = samples_played;
+    ctx->next_event_index = next_event_index;
+    ctx->is_playing = samples_played < ctx->total_samples;
+    return 1;
+}
+
+// Free snapshot data
+void free_player_snapshot(PlayerSnapshot *snapshot)
+{
+    free(snapshot->data);
+    snapshot->data = NULL;
+    snapshot->size = 0;
+}
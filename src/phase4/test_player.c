@@ -0,0 +1,451 @@
+/* Test program for the phase4 player
+ * Renders the phase4 song through the player's own rendering code and checks
+ * that player snapshots restore playback exactly and that seeking lands on
+ * the same samples as rendering straight through, and parses the headers of
+ * the WAV formats the player writes
+ */
+
+// Small RIFF limit, so the header test can write RF64 files quickly
+#define WAV_RIFF_MAX_SIZE 100000u
+
+#include "types.h"
+#include "events.h"
+#include "snapshot.h"
+#include "keyframes.h"
+#include "wav_writer.h"
+#include "core.h"
+
+#define SNAPSHOT_TEST_POINTS 4
+#define SNAPSHOT_TEST_SAMPLES 8192
+#define SEEK_TEST_SAMPLES 4096
+#define WAV_TEST_FRAMES 1000    // Fits in a RIFF file
+#define WAV_TEST_RF64_FRAMES 40000 // Past WAV_RIFF_MAX_SIZE in every format
+#define WAV_TEST_FILENAME "test_player_header.wav"
+
+// The player context is too large for the stack
+static AudioContext context;
+
+// Render count samples of ctx into output in player-sized blocks
+static void render_samples(AudioContext *ctx, int32_t *output, uint32_t count)
+{
+    while (count)
+    {
+        uint32_t block = count < INTERNAL_BUFFER_SIZE ? count : INTERNAL_BUFFER_SIZE;
+        render_block(ctx, output, block);
+        output += block * 2;
+        count -= block;
+    }
+}
+
+// Report the first sample where two renders differ. Returns 1 if they match.
+static int compare_samples(const char *what, const int32_t *expected, const int32_t *actual, uint32_t count,
+                           uint32_t first_sample)
+{
+    for (uint32_t i = 0; i < count * 2; i++)
+    {
+        if (expected[i] != actual[i])
+        {
+            printf("❌ FAILED: %s differs at sample %u (%s): expected %d, got %d\n", what, first_sample + i / 2,
+                   i % 2 ? "R" : "L", expected[i], actual[i]);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Save a snapshot at several points of the song (before, between and after
+// its events), render on, restore it and render again: the position and every
+// sample must come back. Also restore into a freshly started context, and
+// check that snapshots with a wrong version are rejected.
+int check_snapshot_round_trip(RegisterEventList *events, uint32_t total_samples)
+{
+    int32_t *expected = (int32_t *)malloc(SNAPSHOT_TEST_SAMPLES * 2 * sizeof(int32_t));
+    int32_t *actual = (int32_t *)malloc(SNAPSHOT_TEST_SAMPLES * 2 * sizeof(int32_t));
+    int ok = 1;
+    if (!expected || !actual)
+    {
+        fprintf(stderr, "Failed to allocate snapshot test buffers\n");
+        free(expected);
+        free(actual);
+        return 0;
+    }
+
+    memset(&context, 0, sizeof(AudioContext));
+    context.events = events;
+    context.total_samples = total_samples;
+    context.is_playing = 1;
+
+    for (int n = 0; n < SNAPSHOT_TEST_POINTS && ok; n++)
+    {
+        uint32_t point = (uint32_t)((uint64_t)(total_samples - SNAPSHOT_TEST_SAMPLES) * n / (SNAPSHOT_TEST_POINTS - 1));
+        PlayerSnapshot snapshot;
+
+        start_playback(&context);
+        while (context.samples_played < point)
+        {
+            uint32_t count = point - context.samples_played;
+            render_samples(&context, actual, count < SNAPSHOT_TEST_SAMPLES ? count : SNAPSHOT_TEST_SAMPLES);
+        }
+        if (!save_player_snapshot(&context, &snapshot))
+        {
+            ok = 0;
+            break;
+        }
+        size_t event_index = context.next_event_index;
+        render_samples(&context, expected, SNAPSHOT_TEST_SAMPLES);
+
+        // Restore over the context that rendered on
+        if (!restore_player_snapshot(&context, &snapshot))
+        {
+            printf("❌ FAILED: Snapshot at sample %u did not restore\n", point);
+            ok = 0;
+        }
+        else if (context.samples_played != point || context.next_event_index != event_index)
+        {
+            printf("❌ FAILED: Snapshot at sample %u restored position %u, event %zu (want %zu)\n", point,
+                   context.samples_played, context.next_event_index, event_index);
+            ok = 0;
+        }
+        else
+        {
+            render_samples(&context, actual, SNAPSHOT_TEST_SAMPLES);
+            ok = compare_samples("Render after restore", expected, actual, SNAPSHOT_TEST_SAMPLES, point);
+        }
+
+        // Restore into a context that has just been reset
+        if (ok)
+        {
+            start_playback(&context);
+            if (!restore_player_snapshot(&context, &snapshot))
+            {
+                printf("❌ FAILED: Snapshot at sample %u did not restore into a reset player\n", point);
+                ok = 0;
+            }
+            else
+            {
+                render_samples(&context, actual, SNAPSHOT_TEST_SAMPLES);
+                ok = compare_samples("Render after restore into a reset player", expected, actual,
+                                     SNAPSHOT_TEST_SAMPLES, point);
+            }
+        }
+
+        // A player or chip state version this build does not know is rejected
+        // and leaves the context alone
+        if (n == 0 && ok)
+        {
+            printf("  Two snapshots with wrong versions follow; their errors are expected.\n");
+            fflush(stdout);
+        }
+        for (size_t offset = 4; n == 0 && offset <= PLAYER_SNAPSHOT_HEADER_SIZE + 4 && ok;
+             offset += PLAYER_SNAPSHOT_HEADER_SIZE)
+        {
+            uint32_t played = context.samples_played;
+            snapshot.data[offset]++;
+            if (restore_player_snapshot(&context, &snapshot) || context.samples_played != played)
+            {
+                printf("❌ FAILED: Snapshot with a wrong %s version was accepted\n", offset == 4 ? "player" : "chip");
+                ok = 0;
+            }
+            snapshot.data[offset]--;
+        }
+        free_player_snapshot(&snapshot);
+    }
+
+    if (ok)
+    {
+        printf("  All %d snapshots restore the position and the next %d samples.\n", SNAPSHOT_TEST_POINTS,
+               SNAPSHOT_TEST_SAMPLES);
+    }
+    free(expected);
+    free(actual);
+    return ok;
+}
+
+// Render the whole song straight through, then seek around it (forwards,
+// backwards, onto and between event times, past the end) with and without a
+// keyframe index: every seek must continue with the samples of the straight
+// render
+int check_seek_matches_straight_render(RegisterEventList *events, uint32_t total_samples)
+{
+    int32_t *straight = (int32_t *)malloc((size_t)total_samples * 2 * sizeof(int32_t));
+    int32_t *actual = (int32_t *)malloc(SEEK_TEST_SAMPLES * 2 * sizeof(int32_t));
+    uint32_t event_sample = (uint32_t)(events->events[events->count / 2].cycle_time / CYCLES_PER_SAMPLE);
+    const uint32_t interval = KEYFRAME_INTERVAL_SECONDS * INTERNAL_SAMPLE_RATE;
+    const uint32_t targets[] = {
+        total_samples / 2, interval + 1, 0, event_sample, event_sample + 1, interval,
+        total_samples - SEEK_TEST_SAMPLES, 1000, total_samples, total_samples + 1000,
+    };
+    const int num_targets = (int)(sizeof(targets) / sizeof(targets[0]));
+    KeyframeIndex keyframes;
+    int ok = 1;
+    if (!straight || !actual)
+    {
+        fprintf(stderr, "Failed to allocate seek test buffers\n");
+        free(straight);
+        free(actual);
+        return 0;
+    }
+
+    memset(&context, 0, sizeof(AudioContext));
+    context.events = events;
+    context.total_samples = total_samples;
+    context.is_playing = 1;
+    start_playback(&context);
+    render_samples(&context, straight, total_samples);
+
+    init_keyframe_index(&keyframes, interval);
+    for (int pass = 0; pass < 2 && ok; pass++)
+    {
+        // Pass 0 replays from the start when seeking back; pass 1 restores keyframes
+        context.keyframes = pass ? &keyframes : NULL;
+        start_playback(&context);
+        for (int t = 0; t < num_targets && ok; t++)
+        {
+            uint32_t target = targets[t] < total_samples ? targets[t] : total_samples;
+            uint32_t count = total_samples - target < SEEK_TEST_SAMPLES ? total_samples - target : SEEK_TEST_SAMPLES;
+            if (!seek_to_sample(&context, targets[t]))
+            {
+                printf("❌ FAILED: Seek to sample %u failed\n", targets[t]);
+                ok = 0;
+                break;
+            }
+            if (context.samples_played != target || context.is_playing != (target < total_samples))
+            {
+                printf("❌ FAILED: Seek to sample %u landed at %u (playing %d)\n", targets[t],
+                       context.samples_played, context.is_playing);
+                ok = 0;
+                break;
+            }
+            render_samples(&context, actual, count);
+            ok = compare_samples(pass ? "Render after a keyframe seek" : "Render after a seek",
+                                 straight + (size_t)target * 2, actual, count, target);
+        }
+    }
+    if (ok && keyframes.count != (total_samples - 1) / interval + 1)
+    {
+        printf("❌ FAILED: %zu keyframes recorded, want %u\n", keyframes.count, (total_samples - 1) / interval + 1);
+        ok = 0;
+    }
+
+    if (ok)
+    {
+        printf("  All %d seeks match the straight render, with and without %zu keyframes.\n", num_targets,
+               keyframes.count);
+    }
+    free_keyframe_index(&keyframes);
+    free(straight);
+    free(actual);
+    return ok;
+}
+
+static uint32_t read_u16_le(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+static uint32_t read_u32_le(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t read_u64_le(const uint8_t *lo)
+{
+    return read_u32_le(lo) | (uint64_t)read_u32_le(lo + 4) << 32;
+}
+
+// Write frames in format, read the file back and walk its chunks. Returns 0
+// and reports the first field that does not match.
+static int check_wav_file(int format, uint32_t frames)
+{
+    static const uint32_t bits[] = {16, 24, 32};
+    static const uint8_t pcm_guid[16] = {0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x00,
+                                         0x80, 0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71};
+    static WavWriter writer;
+    static int32_t samples[2048 * 2];
+    const char *name = format == WAV_FORMAT_S16 ? "s16" : format == WAV_FORMAT_S24 ? "s24" : "f32";
+    uint32_t block_align = 2 * bits[format] / 8;
+    uint64_t data_size = (uint64_t)frames * block_align;
+    int rf64 = frames == WAV_TEST_RF64_FRAMES;
+    uint8_t *file = NULL;
+    long size = 0;
+    int ok = 1, seen_fmt = 0, seen_fact = 0, seen_data = 0;
+
+    for (uint32_t i = 0; i < 2048 * 2; i++)
+    {
+        samples[i] = (int32_t)(i * 37) - 70000;
+    }
+    if (!wav_writer_open(&writer, WAV_TEST_FILENAME, format))
+    {
+        return 0;
+    }
+    for (uint32_t done = 0; done < frames;)
+    {
+        uint32_t count = frames - done < 2048 ? frames - done : 2048;
+        wav_writer_write(&writer, samples, count);
+        done += count;
+    }
+    if (!wav_writer_close(&writer, WAV_TEST_FILENAME))
+    {
+        return 0;
+    }
+
+    FILE *fp = fopen(WAV_TEST_FILENAME, "rb");
+    if (fp && fseek(fp, 0, SEEK_END) == 0 && (size = ftell(fp)) > 0 && fseek(fp, 0, SEEK_SET) == 0)
+    {
+        file = (uint8_t *)malloc(size);
+        if (file && fread(file, 1, size, fp) != (size_t)size)
+        {
+            free(file);
+            file = NULL;
+        }
+    }
+    if (fp)
+    {
+        fclose(fp);
+    }
+    remove(WAV_TEST_FILENAME);
+    if (!file)
+    {
+        fprintf(stderr, "Failed to read back %s\n", WAV_TEST_FILENAME);
+        return 0;
+    }
+
+#define WAV_EXPECT(cond, ...)                                 \
+    if (ok && !(cond))                                        \
+    {                                                         \
+        printf("❌ FAILED: %s WAV (%u frames): ", name, frames); \
+        printf(__VA_ARGS__);                                  \
+        printf("\n");                                         \
+        ok = 0;                                               \
+    }
+
+    WAV_EXPECT(size >= 12 && memcmp(file, rf64 ? "RF64" : "RIFF", 4) == 0 && memcmp(file + 8, "WAVE", 4) == 0,
+               "not a %s WAVE file", rf64 ? "RF64" : "RIFF");
+    WAV_EXPECT(read_u32_le(file + 4) == (rf64 ? 0xFFFFFFFFu : (uint32_t)(size - 8)),
+               "RIFF size %u, file is %ld bytes", read_u32_le(file + 4), size);
+    WAV_EXPECT(size >= 12 + 36 && memcmp(file + 12, rf64 ? "ds64" : "JUNK", 4) == 0 && read_u32_le(file + 16) == 28,
+               "no 28-byte %s chunk first", rf64 ? "ds64" : "JUNK");
+    if (ok && rf64)
+    {
+        WAV_EXPECT(read_u64_le(file + 20) == (uint64_t)size - 8, "ds64 RIFF size %llu",
+                   (unsigned long long)read_u64_le(file + 20));
+        WAV_EXPECT(read_u64_le(file + 28) == data_size, "ds64 data size %llu",
+                   (unsigned long long)read_u64_le(file + 28));
+        WAV_EXPECT(read_u64_le(file + 36) == frames, "ds64 sample count %llu",
+                   (unsigned long long)read_u64_le(file + 36));
+    }
+
+    for (long pos = 12; ok && pos < size && !seen_data;)
+    {
+        const uint8_t *chunk = file + pos;
+        uint32_t chunk_size = read_u32_le(chunk + 4);
+        WAV_EXPECT(pos + 8 <= size, "truncated chunk at %ld", pos);
+        if (!ok)
+        {
+            break;
+        }
+        if (memcmp(chunk, "fmt ", 4) == 0)
+        {
+            uint32_t tag = read_u16_le(chunk + 8);
+            seen_fmt = 1;
+            WAV_EXPECT(read_u16_le(chunk + 10) == 2 && read_u32_le(chunk + 12) == INTERNAL_SAMPLE_RATE &&
+                           read_u32_le(chunk + 16) == INTERNAL_SAMPLE_RATE * block_align &&
+                           read_u16_le(chunk + 20) == block_align && read_u16_le(chunk + 22) == bits[format],
+                       "fmt channels, rates, block align or bits wrong");
+            if (format == WAV_FORMAT_S16)
+            {
+                WAV_EXPECT(tag == 1 && chunk_size == 16, "fmt tag %u size %u, want PCM in 16 bytes", tag, chunk_size);
+            }
+            else if (format == WAV_FORMAT_S24)
+            {
+                WAV_EXPECT(tag == 0xFFFE && chunk_size == 40 && read_u16_le(chunk + 24) == 22,
+                           "fmt tag 0x%X size %u, want WAVE_FORMAT_EXTENSIBLE in 40 bytes", tag, chunk_size);
+                WAV_EXPECT(read_u16_le(chunk + 26) == 24 && read_u32_le(chunk + 28) == 3 &&
+                               memcmp(chunk + 32, pcm_guid, 16) == 0,
+                           "extensible valid bits, channel mask or PCM sub-format wrong");
+            }
+            else
+            {
+                WAV_EXPECT(tag == 3 && chunk_size == 18 && read_u16_le(chunk + 24) == 0,
+                           "fmt tag %u size %u, want IEEE float in 18 bytes with cbSize 0", tag, chunk_size);
+            }
+        }
+        else if (memcmp(chunk, "fact", 4) == 0)
+        {
+            seen_fact = 1;
+            WAV_EXPECT(seen_fmt && chunk_size == 4 && read_u32_le(chunk + 8) == (rf64 ? 0xFFFFFFFFu : frames),
+                       "fact chunk size %u sample length %u", chunk_size, read_u32_le(chunk + 8));
+        }
+        else if (memcmp(chunk, "data", 4) == 0)
+        {
+            seen_data = 1;
+            WAV_EXPECT(chunk_size == (rf64 ? 0xFFFFFFFFu : (uint32_t)data_size), "data size %u", chunk_size);
+            WAV_EXPECT((uint64_t)(pos + 8) + data_size == (uint64_t)size, "data does not end the file");
+        }
+        pos += 8 + chunk_size + (chunk_size & 1);
+    }
+    WAV_EXPECT(seen_fmt && seen_data, "missing fmt or data chunk");
+    WAV_EXPECT(seen_fact == (format == WAV_FORMAT_F32), "fact chunk %s", seen_fact ? "in PCM data" : "missing");
+#undef WAV_EXPECT
+
+    free(file);
+    return ok;
+}
+
+// Every output format, as RIFF and as RF64, must have the headers a reader
+// expects: PCM for 16-bit, WAVE_FORMAT_EXTENSIBLE for 24-bit, and IEEE float
+// with an 18-byte fmt and a fact chunk
+int check_wav_headers(void)
+{
+    int ok = 1;
+    for (int format = WAV_FORMAT_S16; format <= WAV_FORMAT_F32 && ok; format++)
+    {
+        ok = check_wav_file(format, WAV_TEST_FRAMES) && check_wav_file(format, WAV_TEST_RF64_FRAMES);
+    }
+    if (ok)
+    {
+        printf("  All 3 formats have valid RIFF and RF64 headers.\n");
+    }
+    return ok;
+}
+
+int main()
+{
+    printf("Phase4 Player Test Program\n");
+    printf("==========================\n\n");
+
+    RegisterEventList *pass1 = generate_pass1_events();
+    RegisterEventList *pass2 = generate_pass2_events(pass1);
+    uint32_t total_samples = duration_to_samples(calculate_playback_duration(pass2));
+    int ok = 1;
+
+    // Restoring a snapshot must continue exactly where playback left off
+    printf("Saving and restoring player snapshots...\n");
+    if (!check_snapshot_round_trip(pass2, total_samples))
+    {
+        ok = 0;
+    }
+
+    // Seeking must continue with the same samples as rendering straight through
+    printf("\nSeeking through the song...\n");
+    if (ok && !check_seek_matches_straight_render(pass2, total_samples))
+    {
+        ok = 0;
+    }
+
+    // WAV files must carry the headers their sample format requires
+    printf("\nChecking WAV headers...\n");
+    if (ok && !check_wav_headers())
+    {
+        ok = 0;
+    }
+
+    free_event_list(pass1);
+    free_event_list(pass2);
+    if (!ok)
+    {
+        return 1;
+    }
+    printf("\n✅ SUCCESS: All player tests passed\n");
+    return 0;
+}
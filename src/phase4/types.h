@@ -11,31 +11,37 @@
 #include <time.h>
 #include <math.h>
 #include "../../opm.h"
+#include "../../opm_convert.h"
+#include "../../opm_resample.h"
 
 // Sample rate and clock settings
 #define OPM_CLOCK 3579545
 #define CYCLES_PER_SAMPLE 64
 #define INTERNAL_SAMPLE_RATE (OPM_CLOCK / CYCLES_PER_SAMPLE) // ~55930 Hz
-#define OUTPUT_SAMPLE_RATE 48000                             // Output device sample rate
+#define OUTPUT_SAMPLE_RATE 48000                             // Fallback device rate when resampling
+#define OUTPUT_SAMPLE_RATE_MIN_FULL_BAND 44100               // Lower device rates lose audible highs
+#define RESAMPLER_TRANSITION_HZ 5400                         // Resampler roll-off below the device Nyquist rate
 
 #define BPM 120
-#define REGISTER_WRITE_DELAY_CYCLES 128
-#define DELAY_SAMPLES ((REGISTER_WRITE_DELAY_CYCLES) / (CYCLES_PER_SAMPLE)) // 2 samples
 
-// OPM register port numbers for OPM_Write()
-#define OPM_ADDRESS_REGISTER 0
-#define OPM_DATA_REGISTER 1
-
-// Internal buffer size for resampler
+// Internal samples rendered per chunk (callbacks of any size are split into chunks)
 #define INTERNAL_BUFFER_SIZE 4096
 
+// Render thread: minimum output frames buffered ahead of the device (~43 ms at
+// 48 kHz; grown to fit longer device periods), frames rendered per step, and
+// the default device period, which can now be short
+#define RING_BUFFER_FRAMES 2048
+#define RENDER_PERIOD_FRAMES 256
+#define DEVICE_PERIOD_MS 5
+
 // Register write event structure
 // Note: Both address and data are stored in each event for simplicity and clarity in JSON output.
 // For address write events (is_data_write=0), the 'data' field shows what data will be written in the subsequent data event.
 // For data write events (is_data_write=1), the 'address' field shows which register the data is being written to.
+// Playback queues the whole write at the address event (see process_events_until).
 typedef struct
 {
-    uint32_t sample_time;  // Time in samples from start (not delta)
+    uint64_t cycle_time;   // Time in OPM clock cycles from start (not delta)
     uint8_t address;       // YM2151 register address
     uint8_t data;          // Data to write to the register
     uint8_t is_data_write; // 0 = address register write, 1 = data register write (for pass2 only)
@@ -49,20 +55,22 @@ typedef struct
     size_t capacity;
 } RegisterEventList;
 
-// User data structure for MiniAudio callback
+// Saved player state: chip state plus playback position (see snapshot.h)
 typedef struct
 {
-    opm_t chip;
-    uint32_t samples_played;
-    uint32_t total_samples;
-    int is_playing;
-    ma_resampler resampler;
-    int16_t internal_buffer[INTERNAL_BUFFER_SIZE * 2]; // Stereo buffer
-    RegisterEventList *events;
-    size_t next_event_index;
-    int32_t *wav_buffer; // Buffer for WAV output
-    size_t wav_buffer_pos;
-} AudioContext;
+    uint8_t *data;
+    size_t size;
+} PlayerSnapshot;
+
+// Player snapshots taken every interval_samples during playback, snapshots[i]
+// at sample i * interval_samples (see keyframes.h)
+typedef struct
+{
+    PlayerSnapshot *snapshots;
+    size_t count;
+    size_t capacity;
+    uint32_t interval_samples;
+} KeyframeIndex;
 
 // WAV file structures
 typedef struct
@@ -72,6 +80,9 @@ typedef struct
     char wave[4];
 } WAVHeader;
 
+// fmt chunk up to the WAVE_FORMAT_EXTENSIBLE fields. Only 8 + chunk_size
+// bytes are written: 16 for PCM, 18 (cb_size 0) for IEEE float, 40 for
+// WAVE_FORMAT_EXTENSIBLE.
 typedef struct
 {
     char fmt[4];
@@ -82,12 +93,89 @@ typedef struct
     uint32_t byte_rate;
     uint16_t block_align;
     uint16_t bits_per_sample;
+    uint16_t cb_size;               // Bytes of extension that follow
+    uint16_t valid_bits_per_sample; // WAVE_FORMAT_EXTENSIBLE only
+    uint32_t channel_mask;
+    uint8_t sub_format[16];
 } FMTChunk;
 
+// Frame count of non-PCM data (IEEE float); 0xFFFFFFFF in RF64, where the
+// ds64 chunk holds it
+typedef struct
+{
+    char fact[4];
+    uint32_t chunk_size; // 4
+    uint32_t sample_length;
+} FACTChunk;
+
 typedef struct
 {
     char data[4];
     uint32_t data_size;
 } DATAChunk;
 
+// RF64 (EBU Tech 3306) size chunk. 64-bit sizes are split into low/high halves
+// so the struct has no padding. Written as a "JUNK" chunk of the same size
+// and turned into "ds64" only if the file outgrows 32-bit sizes.
+typedef struct
+{
+    char ds64[4];
+    uint32_t chunk_size; // 28
+    uint32_t riff_size_low;
+    uint32_t riff_size_high;
+    uint32_t data_size_low;
+    uint32_t data_size_high;
+    uint32_t sample_count_low;
+    uint32_t sample_count_high;
+    uint32_t table_length; // 0: no other chunks over 4 GB
+} DS64Chunk;
+
+// WAV sample formats
+#define WAV_FORMAT_S16 0 // 16-bit PCM (chip output / 2, as before)
+#define WAV_FORMAT_S24 1 // 24-bit PCM, same level with no bits dropped
+#define WAV_FORMAT_F32 2 // 32-bit IEEE float, same level (1.0 = 16-bit full scale)
+
+// Largest RIFF size field before the writer switches to RF64
+#ifndef WAV_RIFF_MAX_SIZE
+#define WAV_RIFF_MAX_SIZE 0xFFFFFFFFu
+#endif
+
+// Streaming WAV output: frames are converted and collected here and written in
+// large blocks; the RIFF and data sizes are patched when the file is closed
+#define WAV_WRITE_BUFFER_FRAMES 65536
+
+typedef struct
+{
+    FILE *fp;
+    int format;              // WAV_FORMAT_*
+    uint32_t bytes_per_frame;
+    uint32_t fact_offset;    // File offset of the fact chunk, 0 without one
+    uint32_t data_offset;    // File offset of the data chunk
+    uint8_t buffer[WAV_WRITE_BUFFER_FRAMES * 2 * sizeof(float)];
+    uint32_t buffered_frames;
+    uint64_t frames_written; // Including the buffered ones
+    int failed;              // Set on the first write error
+} WavWriter;
+
+// User data structure for MiniAudio callback
+typedef struct
+{
+    opm_t chip;
+    uint32_t samples_played;
+    uint32_t total_samples;
+    int is_playing;
+    int resample;              // 0 when the device accepted INTERNAL_SAMPLE_RATE
+    opm_resampler_t resampler; // Only initialized when resample is set
+    int32_t render_buffer[INTERNAL_BUFFER_SIZE * 2]; // Chip output before resampling/conversion
+    RegisterEventList *events;
+    size_t next_event_index;
+    WavWriter *wav; // Optional, receives every rendered sample
+    KeyframeIndex *keyframes; // Optional, filled in as playback first reaches each keyframe
+    ma_pcm_rb ring;                // Resampled frames, render thread -> audio callback
+    ma_thread render_thread;
+    ma_atomic_bool32 render_done;  // Set by the render thread after the last frames are in the ring
+    ma_atomic_bool32 stop_render;  // Set by the main thread to stop the render thread early
+    uint32_t underruns;            // Callbacks that found the ring short before the end
+} AudioContext;
+
 #endif // CONSTANTS_H
@@ -1,51 +1,228 @@
 #include "types.h"
 
-// Save WAV file
-int save_wav_file(const char *filename, int32_t *buffer, uint32_t num_samples)
+// File layout: RIFF header, JUNK/ds64 placeholder, fmt, fact (float only), data
+#define WAV_DS64_OFFSET sizeof(WAVHeader)
+
+// fmt format tags (WAVE_FORMAT_PCM, _IEEE_FLOAT, _EXTENSIBLE)
+#define WAV_TAG_PCM 0x0001
+#define WAV_TAG_IEEE_FLOAT 0x0003
+#define WAV_TAG_EXTENSIBLE 0xFFFE
+
+// KSDATAFORMAT_SUBTYPE_PCM, the WAVE_FORMAT_EXTENSIBLE sub-format for PCM
+static const uint8_t wav_subformat_pcm[16] = {0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x00,
+                                              0x80, 0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71};
+
+// Parse a --format name ("s16", "s24", "f32"). Returns -1 if unknown.
+int wav_format_from_name(const char *name)
+{
+    if (strcmp(name, "s16") == 0)
+    {
+        return WAV_FORMAT_S16;
+    }
+    if (strcmp(name, "s24") == 0)
+    {
+        return WAV_FORMAT_S24;
+    }
+    if (strcmp(name, "f32") == 0)
+    {
+        return WAV_FORMAT_F32;
+    }
+    return -1;
+}
+
+// Open filename and write a WAV header with placeholder sizes
+int wav_writer_open(WavWriter *writer, const char *filename, int format)
 {
-    FILE *fp = fopen(filename, "wb");
-    if (!fp)
+    memset(writer, 0, sizeof(*writer));
+    writer->format = format;
+    uint32_t bytes_per_sample = format == WAV_FORMAT_S16 ? 2 : format == WAV_FORMAT_S24 ? 3 : 4;
+    writer->bytes_per_frame = 2 * bytes_per_sample;
+
+    writer->fp = fopen(filename, "wb");
+    if (!writer->fp)
     {
         fprintf(stderr, "❌ Failed to open %s for writing\n", filename);
         return 0;
     }
 
-    uint32_t data_size = num_samples * 2 * sizeof(int16_t);
+    // fmt chunk: plain PCM for 16-bit, WAVE_FORMAT_EXTENSIBLE for 24-bit PCM
+    // (more than 16 bits per sample), IEEE float with an empty extension
+    FMTChunk fmt;
+    memset(&fmt, 0, sizeof(fmt));
+    memcpy(fmt.fmt, "fmt ", 4);
+    fmt.num_channels = 2; // Stereo
+    fmt.sample_rate = INTERNAL_SAMPLE_RATE;
+    fmt.byte_rate = INTERNAL_SAMPLE_RATE * writer->bytes_per_frame;
+    fmt.block_align = (uint16_t)writer->bytes_per_frame;
+    fmt.bits_per_sample = (uint16_t)(bytes_per_sample * 8);
+    if (format == WAV_FORMAT_S16)
+    {
+        fmt.chunk_size = 16;
+        fmt.audio_format = WAV_TAG_PCM;
+    }
+    else if (format == WAV_FORMAT_S24)
+    {
+        fmt.chunk_size = 40;
+        fmt.audio_format = WAV_TAG_EXTENSIBLE;
+        fmt.cb_size = 22;
+        fmt.valid_bits_per_sample = fmt.bits_per_sample;
+        fmt.channel_mask = 0x3; // Front left, front right
+        memcpy(fmt.sub_format, wav_subformat_pcm, sizeof(wav_subformat_pcm));
+    }
+    else
+    {
+        fmt.chunk_size = 18;
+        fmt.audio_format = WAV_TAG_IEEE_FLOAT;
+    }
+    writer->fact_offset = format == WAV_FORMAT_F32 ? WAV_DS64_OFFSET + sizeof(DS64Chunk) + 8 + fmt.chunk_size : 0;
+    writer->data_offset = WAV_DS64_OFFSET + sizeof(DS64Chunk) + 8 + fmt.chunk_size +
+                          (writer->fact_offset ? sizeof(FACTChunk) : 0);
 
-    // Write WAV header
+    // Write WAV header (sizes are filled in by wav_writer_close)
     WAVHeader header;
     memcpy(header.riff, "RIFF", 4);
-    header.file_size = data_size + 36;
+    header.file_size = writer->data_offset + sizeof(DATAChunk) - 8;
     memcpy(header.wave, "WAVE", 4);
-    fwrite(&header, sizeof(WAVHeader), 1, fp);
+    fwrite(&header, sizeof(WAVHeader), 1, writer->fp);
 
-    // Write FMT chunk
-    FMTChunk fmt;
-    memcpy(fmt.fmt, "fmt ", 4);
-    fmt.chunk_size = 16;
-    fmt.audio_format = 1; // PCM
-    fmt.num_channels = 2; // Stereo
-    fmt.sample_rate = INTERNAL_SAMPLE_RATE;
-    fmt.byte_rate = INTERNAL_SAMPLE_RATE * 2 * sizeof(int16_t);
-    fmt.block_align = 2 * sizeof(int16_t);
-    fmt.bits_per_sample = 16;
-    fwrite(&fmt, sizeof(FMTChunk), 1, fp);
+    // Reserve room for a ds64 chunk; readers skip it while it is JUNK
+    DS64Chunk junk;
+    memset(&junk, 0, sizeof(junk));
+    memcpy(junk.ds64, "JUNK", 4);
+    junk.chunk_size = sizeof(DS64Chunk) - 8;
+    fwrite(&junk, sizeof(DS64Chunk), 1, writer->fp);
+
+    fwrite(&fmt, 8 + fmt.chunk_size, 1, writer->fp);
+
+    // Float data needs a fact chunk with the frame count
+    if (writer->fact_offset)
+    {
+        FACTChunk fact;
+        memcpy(fact.fact, "fact", 4);
+        fact.chunk_size = 4;
+        fact.sample_length = 0;
+        fwrite(&fact, sizeof(FACTChunk), 1, writer->fp);
+    }
 
     // Write DATA chunk header
     DATAChunk data;
     memcpy(data.data, "data", 4);
-    data.data_size = data_size;
-    fwrite(&data, sizeof(DATAChunk), 1, fp);
+    data.data_size = 0;
+    if (fwrite(&data, sizeof(DATAChunk), 1, writer->fp) != 1)
+    {
+        writer->failed = 1;
+    }
+    return 1;
+}
+
+static void wav_writer_flush(WavWriter *writer)
+{
+    if (writer->buffered_frames &&
+        fwrite(writer->buffer, writer->bytes_per_frame, writer->buffered_frames, writer->fp) != writer->buffered_frames)
+    {
+        writer->failed = 1;
+    }
+    writer->buffered_frames = 0;
+}
+
+// Convert count stereo frames of chip output into out in the writer's format
+static void wav_convert(int format, uint8_t *out, const int32_t *samples, uint32_t count)
+{
+    if (format == WAV_FORMAT_S16)
+    {
+        OPM_ConvertS16((int16_t *)out, samples, count * 2);
+    }
+    else if (format == WAV_FORMAT_S24)
+    {
+        OPM_ConvertS24(out, samples, count * 2);
+    }
+    else
+    {
+        OPM_ConvertF32((float *)out, samples, count * 2);
+    }
+}
+
+// Append num_frames stereo frames of chip output
+void wav_writer_write(WavWriter *writer, const int32_t *samples, uint32_t num_frames)
+{
+    while (num_frames > 0)
+    {
+        uint32_t count = WAV_WRITE_BUFFER_FRAMES - writer->buffered_frames;
+        if (count > num_frames)
+        {
+            count = num_frames;
+        }
+
+        wav_convert(writer->format, writer->buffer + writer->buffered_frames * writer->bytes_per_frame, samples, count);
+
+        writer->buffered_frames += count;
+        writer->frames_written += count;
+        samples += count * 2;
+        num_frames -= count;
 
-    // Write audio data (convert 32-bit to 16-bit)
-    for (uint32_t i = 0; i < num_samples * 2; i++)
+        if (writer->buffered_frames == WAV_WRITE_BUFFER_FRAMES)
+        {
+            wav_writer_flush(writer);
+        }
+    }
+}
+
+static int wav_write_u32_at(FILE *fp, long offset, uint32_t value)
+{
+    return fseek(fp, offset, SEEK_SET) == 0 && fwrite(&value, sizeof(value), 1, fp) == 1;
+}
+
+// Flush, patch the sizes and close the file. Past WAV_RIFF_MAX_SIZE the file
+// becomes RF64: the placeholder turns into ds64 and the 32-bit sizes are -1.
+int wav_writer_close(WavWriter *writer, const char *filename)
+{
+    wav_writer_flush(writer);
+
+    uint64_t data_size = writer->frames_written * writer->bytes_per_frame;
+    uint64_t riff_size = data_size + writer->data_offset + sizeof(DATAChunk) - 8;
+    int ok;
+    if (riff_size <= WAV_RIFF_MAX_SIZE)
+    {
+        ok = wav_write_u32_at(writer->fp, 4, (uint32_t)riff_size) &&
+             wav_write_u32_at(writer->fp, writer->data_offset + 4, (uint32_t)data_size) &&
+             (!writer->fact_offset ||
+              wav_write_u32_at(writer->fp, writer->fact_offset + 8, (uint32_t)writer->frames_written));
+    }
+    else
     {
-        // Divide by 2 to convert from 32-bit to 16-bit range
-        int16_t sample = (int16_t)(buffer[i] / 2);
-        fwrite(&sample, sizeof(int16_t), 1, fp);
+        DS64Chunk ds64;
+        memcpy(ds64.ds64, "ds64", 4);
+        ds64.chunk_size = sizeof(DS64Chunk) - 8;
+        ds64.riff_size_low = (uint32_t)riff_size;
+        ds64.riff_size_high = (uint32_t)(riff_size >> 32);
+        ds64.data_size_low = (uint32_t)data_size;
+        ds64.data_size_high = (uint32_t)(data_size >> 32);
+        ds64.sample_count_low = (uint32_t)writer->frames_written;
+        ds64.sample_count_high = (uint32_t)(writer->frames_written >> 32);
+        ds64.table_length = 0;
+
+        ok = fseek(writer->fp, 0, SEEK_SET) == 0 && fwrite("RF64", 4, 1, writer->fp) == 1 &&
+             wav_write_u32_at(writer->fp, 4, 0xFFFFFFFFu) &&
+             fseek(writer->fp, WAV_DS64_OFFSET, SEEK_SET) == 0 &&
+             fwrite(&ds64, sizeof(DS64Chunk), 1, writer->fp) == 1 &&
+             wav_write_u32_at(writer->fp, writer->data_offset + 4, 0xFFFFFFFFu) &&
+             (!writer->fact_offset || wav_write_u32_at(writer->fp, writer->fact_offset + 8, 0xFFFFFFFFu));
     }
+    if (!ok)
+    {
+        writer->failed = 1;
+    }
+    if (fclose(writer->fp) != 0)
+    {
+        writer->failed = 1;
+    }
+    writer->fp = NULL;
 
-    fclose(fp);
-    printf("✅ Saved WAV file: %s\n", filename);
+    if (writer->failed)
+    {
+        fprintf(stderr, "❌ Failed to write WAV file: %s\n", filename);
+        return 0;
+    }
+    printf("✅ Saved WAV file: %s%s\n", filename, riff_size > WAV_RIFF_MAX_SIZE ? " (RF64)" : "");
     return 1;
 }